@@ -60,4 +60,7 @@ void canvas_draw_bmp_sprite(Canvas *canvas, Bitmap *bmp, bmp_sprite_view *sprite
 void canvas_draw_grayscale_bmp_sprite(Canvas *canvas, Bitmap *bmp, bmp_sprite_view *sprite, uint32_t layer,
                             uint32_t offset_x, uint32_t offset_y);
 
+void canvas_draw_grayscale_bmp_bitplane(Canvas *canvas, Bitmap *bmp, bmp_sprite_view *sprite, uint32_t bit,
+                                        uint32_t offset_x, uint32_t offset_y);
+
 #endif // DRAW_CANVAS_H
\ No newline at end of file
@@ -8,6 +8,16 @@
 
 #define EPD_1IN54_V2_WIDTH       200
 #define EPD_1IN54_V2_HEIGHT      200
+#define EPD_1IN54_V2_WIDTH_BYTES ((EPD_1IN54_V2_WIDTH + 7) / 8)
+#define EPD_1IN54_V2_BUF_LEN     (EPD_1IN54_V2_WIDTH_BYTES * EPD_1IN54_V2_HEIGHT)
+
+// Partial refreshes between two full ones, which clear the ghosting
+#define EPD_FULL_REFRESH_INTERVAL   10
+
+// Windows a differential update is split into, and unchanged rows a window
+// spans rather than starting another one
+#define EPD_DIFF_WINDOWS_MAX    8
+#define EPD_DIFF_MERGE_ROWS     4
 
 class DrvEPaper
 {
@@ -30,19 +40,40 @@ public:
         DISPLAY_UPDATE          = 0x22,
         WRITE_RAM_BW            = 0x24,
         WRITE_RAM_RED           = 0x26,
+        VCOM_VOLTAGE            = 0x2C,
         OTP_READ                = 0x2D,
+        WRITE_LUT               = 0x32,
         BORDER_WAVEFORM         = 0x3C,
+        LUT_END_OPTION          = 0x3F,
         RAM_X_ADDR              = 0x44,
         RAM_Y_ADDR              = 0x45,
         RAM_X_COUNTER           = 0x4E,
         RAM_Y_COUNTER           = 0x4F,
     };
 
+    // Stretches of time the panel holds BUSY high
+    enum Phase : uint8_t {
+        PHASE_RESET = 0,
+        PHASE_INIT,
+        PHASE_REFRESH,
+        PHASES
+    };
+
+    // Area of the panel RAM, in bytes across and rows down, ends included
+    struct Window {
+        uint32_t xStart;
+        uint32_t yStart;
+        uint32_t xEnd;
+        uint32_t yEnd;
+    };
+
     DrvEPaper(spi_inst_t *spi, uint32_t cs, uint32_t dc, uint32_t busy, uint32_t reset);
+    ~DrvEPaper();
 
     void initialize();
     void write(uint8_t type, uint8_t byte);
-    // void write(uint8_t cmd, const uint8_t *data, const uint32_t bytes);
+    void write(uint8_t type, const uint8_t *buffer, uint32_t length);
+    void command(uint8_t cmd, const uint8_t *data = nullptr, uint32_t length = 0);
     // void read(uint8_t cmd, uint8_t *data, uint32_t bytes);
     void reset();
     void wake();
@@ -51,14 +82,90 @@ public:
     void fillScreen(uint8_t byte);
 
     bool isBusy();
+    uint32_t uploadUs();
+
+    bool asyncInit();
+    void displayAsync(const uint8_t *image, bool sleepAfter = false);
+    bool uploadBusy();
+    bool refreshBusy();
+    void waitUpload();
+    void waitRefresh();
+    uint32_t refreshUs();
+    uint32_t phaseUs(Phase phase);
+    uint32_t timeouts();
+
+    void displayBase(const uint8_t *image);
+    void displayPartial(const uint8_t *image);
+    void displayPartial(const uint8_t *image, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+    void setFullRefreshInterval(uint32_t partials);
+    bool partialMode();
+
+    bool shadowInit();
+    void invalidateShadow();
+    uint32_t bytesWritten();
 
 private:
+    // Progress of an asynchronous update
+    enum State : uint8_t {
+        IDLE = 0,
+        UPLOADING,
+        REFRESHING
+    };
+
     spi_inst_t *mSpi;
 
     const uint32_t mPinChipSelect;
     const uint32_t mPinDataCommand;
     const uint32_t mPinBusy;
     const uint32_t mPinReset;
+
+    // Registers set up by initialize, back to power-on values after a reset
+    bool mInitialized;
+
+    // Time the last RAM plane took to upload
+    uint32_t mUploadUs;
+
+    // Asynchronous updates, set up by asyncInit
+    int32_t mDmaChannel;
+    volatile State mState;
+    bool mSleepAfter;
+    uint64_t mPhaseStart;
+
+    // Measured length of each phase, up to BUSY falling
+    volatile uint32_t mPhaseUs[PHASES];
+    uint32_t mTimeouts;
+
+    // Partial refreshes, set up by displayBase
+    bool mPartialMode;
+    uint32_t mPartialCount;
+    uint32_t mFullRefreshInterval;
+
+    // Copy of the black/white RAM, set up by shadowInit
+    uint8_t *mShadow;
+    bool mShadowValid;
+
+    // Running count of bytes put on the bus, commands included
+    uint32_t mBytesWritten;
+
+    void send(uint8_t type, const uint8_t *buffer, uint32_t length);
+    void fillRam(uint8_t ram, uint8_t byte);
+    void setWindow(const Window &window);
+    void writeWindow(uint8_t ram, const uint8_t *image, const Window &window);
+    uint32_t diffWindows(const uint8_t *image, Window *windows, uint32_t max);
+
+    void partialInit();
+    void leavePartial();
+    bool baseDue();
+    void refreshPartial(const uint8_t *image, const Window *windows, uint32_t count);
+
+    bool busyIrqInit();
+    bool waitReady(Phase phase, uint64_t start, uint32_t timeoutMs);
+
+    void uploadDone();
+    void refreshDone();
+
+    static void dmaIrq();
+    static void busyIrq();
 };
 
 #endif // RP2040_DRIVERS_EPAPER_H
\ No newline at end of file
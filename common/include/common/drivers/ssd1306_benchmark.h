@@ -0,0 +1,52 @@
+#ifndef SSD1306_BENCHMARK_H
+#define SSD1306_BENCHMARK_H
+
+#include "common/drivers/ssd1306.h"
+
+// Ways of getting a frame to the display, from the least to the most batched
+enum ssd1306_benchmark_strategy {
+    SSD1306_BENCHMARK_RAW = 0,      // One transaction per command byte, data a page at a time
+    SSD1306_BENCHMARK_BLOCKING,     // Window in one transaction, data a page at a time
+    SSD1306_BENCHMARK_BATCHED,      // Window in one transaction, data in another
+    SSD1306_BENCHMARK_DMA,          // Batched, with the data sent by DMA
+    SSD1306_BENCHMARK_STRATEGIES
+};
+
+typedef struct ssd1306_benchmark_result_t {
+    uint32_t clock_hz;                      // Clock asked for
+    uint32_t actual_hz;                     // Clock the bus settled on, 0 if the transport keeps its own
+    ssd1306_benchmark_strategy strategy;
+    uint32_t full_us;                       // Average time to send a full frame
+    uint32_t partial_us;                    // Average time to send a single page
+    uint32_t full_bytes;                    // Bytes on the bus for a full frame, framing included
+    uint32_t partial_bytes;
+    uint32_t errors;                        // Transfers the display did not acknowledge
+} ssd1306_benchmark_result;
+
+/**
+ * @brief Sweeps bus clocks and transfer strategies, timing full frames and
+ * single pages at each. The display is held for the whole sweep and is left
+ * showing a test pattern, with the window open on the whole display.
+ * Strategies the transport cannot do are skipped.
+ *
+ * @param display Display to measure
+ * @param clocks Bus clocks to try, in Hz
+ * @param clock_count Number of clocks
+ * @param restore_hz Bus clock to go back to once done
+ * @param repeats Transfers timed for each measurement
+ * @param results Returns one result per clock and strategy
+ * @param max_results Room in results
+ * @return Number of results
+ */
+uint32_t ssd1306_benchmark_run(SSD1306 *display, const uint32_t *clocks, uint32_t clock_count, uint32_t restore_hz,
+                               uint32_t repeats, ssd1306_benchmark_result *results, uint32_t max_results);
+
+/**
+ * @brief Prints results as a table
+ *
+ * @param results Results of ssd1306_benchmark_run
+ * @param count Number of results
+ */
+void ssd1306_benchmark_print(const ssd1306_benchmark_result *results, uint32_t count);
+
+#endif // SSD1306_BENCHMARK_H
@@ -0,0 +1,234 @@
+#ifndef SSD1306_CORE_H
+#define SSD1306_CORE_H
+
+#include <stdint.h>
+
+#include "common/drivers/ssd1306_transport.h"
+
+// Same as the SDK's, for builds without it
+#ifndef _u
+#define _u(x) x ## u
+#endif
+
+// commands (see datasheet)
+#define OLED_SET_CONTRAST _u(0x81)
+#define OLED_SET_ENTIRE_ON _u(0xA4)
+#define OLED_SET_NORM_INV _u(0xA6)
+#define OLED_SET_DISP _u(0xAE)
+#define OLED_SET_MEM_ADDR _u(0x20)
+#define OLED_SET_COL_ADDR _u(0x21)
+#define OLED_SET_PAGE_ADDR _u(0x22)
+#define OLED_SET_DISP_START_LINE _u(0x40)
+#define OLED_SET_SEG_REMAP _u(0xA0)
+#define OLED_SET_MUX_RATIO _u(0xA8)
+#define OLED_SET_COM_OUT_DIR _u(0xC0)
+#define OLED_SET_DISP_OFFSET _u(0xD3)
+#define OLED_SET_COM_PIN_CFG _u(0xDA)
+#define OLED_SET_DISP_CLK_DIV _u(0xD5)
+#define OLED_SET_PRECHARGE _u(0xD9)
+#define OLED_SET_VCOM_DESEL _u(0xDB)
+#define OLED_SET_CHARGE_PUMP _u(0x8D)
+#define OLED_SET_HORIZ_SCROLL _u(0x26)
+#define OLED_SET_SCROLL _u(0x2E)
+
+#define OLED_ADDR _u(0x3D)
+#define OLED_HEIGHT _u(64)
+#define OLED_WIDTH _u(128)
+#define OLED_PAGE_HEIGHT _u(8)
+#define OLED_NUM_PAGES OLED_HEIGHT / OLED_PAGE_HEIGHT
+#define OLED_BUF_LEN (OLED_NUM_PAGES * OLED_WIDTH)
+
+#define OLED_WRITE_MODE _u(0xFE)
+#define OLED_READ_MODE _u(0xFF)
+
+// Longest run of command bytes sent in one transaction
+#define OLED_COMMAND_STREAM_MAX 32
+
+#define SSD1306_ADDRESSING_PAGE         0x2
+#define SSD1306_ADDRESSING_VERTICAL     0x1
+#define SSD1306_ADDRESSING_HORIZONTAL   0x0
+
+struct SSD1306LockStats {
+    uint32_t acquisitions;
+    uint32_t contentions;   // Acquisitions that found the lock held by another user
+    uint32_t wait_us;       // Time spent waiting on the lock, in total
+    uint32_t wait_max_us;
+};
+
+/**
+ * @brief Keeps the users of a display from splitting up each other's
+ * transactions. Calls have to nest, operations are built from other
+ * operations.
+ */
+class SSD1306Lock
+{
+public:
+    virtual ~SSD1306Lock() = default;
+
+    virtual void lock() = 0;
+    virtual void unlock() = 0;
+    virtual void get_stats(SSD1306LockStats *stats) = 0;
+};
+
+/**
+ * @brief SSD1306 display core. Builds the command and data streams and leaves
+ * the bus to a transport, so the same code drives the display over I2C, SPI,
+ * or a recording transport on the host.
+ */
+class SSD1306
+{
+public:
+    using Page = uint8_t[OLED_WIDTH];
+    using DisplayRam = Page[OLED_PAGE_HEIGHT];
+
+    // Display RAM with a spare byte in front, for transports that frame the
+    // data with a header byte
+    struct DisplayRamWrite {
+        uint8_t address;
+        DisplayRam ram;
+    };
+
+    struct RenderArea {
+        uint8_t start_col;
+        uint8_t end_col;
+        uint8_t start_page;
+        uint8_t end_page;
+
+        int buflen;
+    };
+
+    // Pages of a frame to send to the display and the span of columns that
+    // changed in each, worked out by plan_flush
+    struct FlushPlan {
+        bool full;
+        uint32_t dirty;
+        uint32_t pages;
+        uint8_t span_start[OLED_PAGE_HEIGHT];
+        uint8_t span_end[OLED_PAGE_HEIGHT];
+    };
+
+    enum AddressingMode {
+        HORIZONTAL  = 0,
+        VERTICAL
+    };
+
+    enum ScrollDirection : uint8_t {
+        SCROLL_RIGHT    = 0,
+        SCROLL_LEFT
+    };
+
+    // Frames between two steps of a continuous scroll, in the order the
+    // controller encodes them
+    enum ScrollInterval : uint8_t {
+        SCROLL_FRAMES_5     = 0,
+        SCROLL_FRAMES_64,
+        SCROLL_FRAMES_128,
+        SCROLL_FRAMES_256,
+        SCROLL_FRAMES_3,
+        SCROLL_FRAMES_4,
+        SCROLL_FRAMES_25,
+        SCROLL_FRAMES_2
+    };
+
+    /**
+     * @brief Commands gathered into a single transaction. On I2C the whole run
+     * goes out behind one control byte, so it costs one start, address and
+     * stop.
+     */
+    class CommandStream
+    {
+    public:
+        CommandStream();
+
+        CommandStream &add(uint8_t command);
+        CommandStream &add(uint8_t command, uint8_t arg);
+        CommandStream &add(uint8_t command, uint8_t arg0, uint8_t arg1);
+        void clear();
+
+        const uint8_t *data() const;
+        uint32_t length() const;
+        bool overflow() const;
+        void warn_overflow() const;
+
+    private:
+        uint8_t mBuffer[OLED_COMMAND_STREAM_MAX];
+        uint32_t mLength;
+        bool mOverflow;
+    };
+
+    using TransferCallback = SSD1306Transport::TransferCallback;
+
+    using LockStats = SSD1306LockStats;
+
+    SSD1306(SSD1306Transport *transport, SSD1306Lock *lock = nullptr);
+
+    static void init_sequence(CommandStream &commands);
+
+    void initialize();
+    void ignore_ram(bool enable);
+    void render(uint8_t *buffer, RenderArea *area);
+    void fill_screen(uint8_t buffer);
+    void fill_display(DisplayRam &ram, uint8_t byte = 0x00);
+    void fill_display_random(DisplayRam &ram);
+    void reset_cursor();
+    void set_window(uint8_t start_col, uint8_t end_col, uint8_t start_page, uint8_t end_page);
+    void set_contrast(uint8_t contrast);
+    void set_addressing_mode(AddressingMode mode);
+    void set_display_enable(bool enable);
+    void set_invert(bool invert);
+
+    void scroll_start(ScrollDirection direction, uint8_t start_page, uint8_t end_page, ScrollInterval interval);
+    void scroll_stop();
+    bool scrolling();
+    void set_start_line(uint8_t line);
+    uint8_t start_line();
+    void scroll_rows(int32_t rows, const DisplayRam &frame);
+    void write_frame(const DisplayRam &frame);
+
+    void plan_flush(const DisplayRam &frame, const DisplayRam &shown, bool partial, FlushPlan *plan);
+    uint32_t flush(DisplayRamWrite &frame, const FlushPlan &plan, bool async);
+
+    static void fill(uint8_t *buf, uint8_t fill);
+    static void calc_render_area_buflen(struct RenderArea *area);
+    void write_buffer(const uint8_t buf[], int buflen);
+    void write_buffer(DisplayRamWrite &ram);
+    void write_commands(const CommandStream &commands);
+
+    SSD1306Transport *transport();
+    uint32_t bytes_written();
+
+    bool dma_ready();
+    void write_buffer_async(const uint8_t buf[], int buflen, TransferCallback callback = nullptr,
+                            void *context = nullptr);
+    void write_buffer_async(DisplayRamWrite &ram, TransferCallback callback = nullptr, void *context = nullptr);
+    void render_async(const uint8_t *buffer, RenderArea *area, TransferCallback callback = nullptr,
+                      void *context = nullptr);
+    void wait_transfer();
+    bool transfer_busy();
+    uint32_t transfer_us();
+    uint32_t cpu_us();
+    uint32_t transfer_aborts();
+
+    void lock();
+    void unlock();
+    void get_lock_stats(LockStats *stats);
+
+private:
+    // Held across every transaction, and across all of the transactions of an
+    // operation
+    SSD1306Lock *mLock;
+    SSD1306Transport *mTransport;
+
+    // Display RAM row shown in the top row of the screen
+    uint8_t mStartLine;
+    bool mScrolling;
+
+    // Writes to display RAM are held to less than the whole display
+    bool mWindowed;
+
+    void stop_scroll_for_write();
+    static void ram_page(const DisplayRam &frame, uint8_t start_line, uint32_t page, uint8_t *buffer);
+    void write_ram_pages(CommandStream &commands, const DisplayRam &frame, uint32_t first, uint32_t count);
+};
+
+#endif // SSD1306_CORE_H
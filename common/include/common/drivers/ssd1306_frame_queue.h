@@ -0,0 +1,80 @@
+#ifndef SSD1306_FRAME_QUEUE_H
+#define SSD1306_FRAME_QUEUE_H
+
+#include "pico/critical_section.h"
+
+#include "common/drivers/ssd1306_core.h"
+
+// Frames a queue can cycle through, enough for triple buffering
+#define SSD1306_FRAME_QUEUE_MAX 3
+
+/**
+ * @brief Hands frames from a producer on one core to a presenter on the other,
+ * so drawing the next frame overlaps sending the last one. The producer
+ * acquires a free frame, draws into it and submits it. The presenter sends
+ * submitted frames oldest first and frees each once it is on the display.
+ */
+class SSD1306FrameQueue
+{
+public:
+    // What the producer gets when every frame is taken
+    enum Policy : uint8_t {
+        BLOCK = 0,  // Waits for the presenter to free a frame
+        DROP        // Takes back the oldest frame not yet presented
+    };
+
+    struct Stats {
+        uint32_t submitted;
+        uint32_t presented;
+        uint32_t dropped;           // Frames taken back before they were presented
+        uint32_t producer_waits;    // Acquires that had to wait for a free frame
+        uint32_t producer_wait_us;  // Time the producer spent waiting, in total
+        uint32_t latency_us;        // Submit to on display, last frame
+        uint32_t latency_max_us;
+        uint32_t latency_avg_us;
+        uint32_t present_us;        // Bus time of the last frame
+    };
+
+    SSD1306FrameQueue(SSD1306 *display, uint32_t depth = 2, Policy policy = Policy::BLOCK);
+    ~SSD1306FrameQueue();
+
+    SSD1306::DisplayRamWrite *acquire(bool wait = true);
+    void submit(SSD1306::DisplayRamWrite *frame);
+
+    bool present(bool wait = true);
+    void run();
+
+    uint32_t depth();
+    uint32_t pending();
+    void set_policy(Policy policy);
+    Policy policy();
+    void get_stats(Stats *stats);
+    void reset_stats();
+
+private:
+    enum State : uint8_t {
+        FREE = 0,
+        DRAWING,
+        QUEUED,
+        PRESENTING
+    };
+
+    SSD1306 *mDisplay;
+    uint32_t mDepth;
+    volatile Policy mPolicy;
+    critical_section_t mLock;
+
+    SSD1306::DisplayRamWrite mFrames[SSD1306_FRAME_QUEUE_MAX];
+    volatile State mState[SSD1306_FRAME_QUEUE_MAX];
+    uint32_t mSequence[SSD1306_FRAME_QUEUE_MAX];    // Submission order of queued frames
+    uint64_t mSubmitted[SSD1306_FRAME_QUEUE_MAX];   // Time each frame was submitted
+    uint32_t mNextSequence;
+
+    Stats mStats;
+    uint64_t mLatencyTotal;
+
+    int32_t find(State state);
+    int32_t oldest_queued();
+};
+
+#endif // SSD1306_FRAME_QUEUE_H
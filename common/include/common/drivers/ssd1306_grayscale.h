@@ -0,0 +1,105 @@
+#ifndef SSD1306_GRAYSCALE_H
+#define SSD1306_GRAYSCALE_H
+
+#include "pico/time.h"
+
+#include "common/draw/canvas.h"
+#include "common/drivers/ssd1306.h"
+
+#define SSD1306_GRAYSCALE_PLANES_MAX    4
+
+typedef struct ssd1306_grayscale_stats_t {
+    uint32_t refresh_hz;                                // Refreshes completed over the last second
+    uint32_t refreshes;
+    uint32_t slot_us;                                   // Time on screen of a plane with a weight of 1
+    uint32_t plane_us[SSD1306_GRAYSCALE_PLANES_MAX];    // Time each plane was on screen at the last refresh
+    uint32_t transfer_us;                               // Bus time of the last plane
+    uint32_t overruns;                                  // Planes started late, the previous one still on the bus
+} ssd1306_grayscale_stats;
+
+/**
+ * @brief Shows grayscale on a monochrome SSD1306 by cycling bit planes through
+ * display RAM. Each plane stays on screen for a time proportional to its
+ * weight, so binary weights of 1, 2, 4... turn n planes into 2^n levels. The
+ * planes are started from a timer alarm and sent by DMA, the CPU is only
+ * needed to kick off each plane.
+ */
+typedef struct ssd1306_grayscale_t {
+    SSD1306 *display;
+    uint32_t plane_count;
+    uint8_t weights[SSD1306_GRAYSCALE_PLANES_MAX];
+    uint32_t refresh_hz;
+
+    // Planes on screen, and planes waiting to take their place at the start
+    // of the next refresh
+    Canvas *planes;
+    Canvas *volatile pending;
+
+    alarm_id_t alarm;
+    volatile bool running;
+    uint32_t plane;
+    uint64_t plane_start;
+    uint64_t due;                                       // When the next plane is due to start
+    uint64_t window_start;
+    uint32_t window_refreshes;
+    ssd1306_grayscale_stats stats;
+} ssd1306_grayscale;
+
+/**
+ * @brief Sets up a grayscale presenter
+ *
+ * @param grayscale Presenter to set up
+ * @param display Display to present on, with DMA set up and no lock, since
+ * planes are started from the timer interrupt
+ * @param weights Weight of each plane, the time it spends on screen
+ * @param plane_count Number of planes, up to SSD1306_GRAYSCALE_PLANES_MAX
+ * @param refresh_hz Times per second all of the planes are cycled through
+ * @return True on success
+ */
+bool ssd1306_grayscale_init(ssd1306_grayscale *grayscale, SSD1306 *display, const uint8_t *weights,
+                            uint32_t plane_count, uint32_t refresh_hz);
+
+/**
+ * @brief Starts cycling the planes. Opens the whole display, every plane is
+ * a full frame that leaves the RAM address where the next one starts.
+ *
+ * @param grayscale Desired presenter
+ * @param planes One canvas per plane, left untouched until replaced
+ * @return True on success
+ */
+bool ssd1306_grayscale_start(ssd1306_grayscale *grayscale, Canvas *planes);
+
+/**
+ * @brief Stops cycling the planes, once the plane on the bus is sent
+ *
+ * @param grayscale Desired presenter
+ */
+void ssd1306_grayscale_stop(ssd1306_grayscale *grayscale);
+
+/**
+ * @brief Replaces the planes at the start of the next refresh, so a frame is
+ * never made up of planes from two different images. The planes handed over
+ * before are in use until ssd1306_grayscale_swap_pending returns false.
+ *
+ * @param grayscale Desired presenter
+ * @param planes One canvas per plane
+ */
+void ssd1306_grayscale_present(ssd1306_grayscale *grayscale, Canvas *planes);
+
+/**
+ * @brief Checks if planes handed to ssd1306_grayscale_present are still
+ * waiting for the next refresh
+ *
+ * @param grayscale Desired presenter
+ */
+bool ssd1306_grayscale_swap_pending(ssd1306_grayscale *grayscale);
+
+/**
+ * @brief Retrieves the refresh rate and plane timings
+ *
+ * @param grayscale Desired presenter
+ * @param stats Returns the stats
+ */
+void ssd1306_grayscale_get_stats(ssd1306_grayscale *grayscale, ssd1306_grayscale_stats *stats);
+
+#endif // SSD1306_GRAYSCALE_H
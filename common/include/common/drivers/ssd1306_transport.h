@@ -0,0 +1,89 @@
+#ifndef SSD1306_TRANSPORT_H
+#define SSD1306_TRANSPORT_H
+
+#include <stdint.h>
+
+// Bytes and transactions kept by the recording transport
+#define SSD1306_RECORD_BYTES        2048
+#define SSD1306_RECORD_TRANSACTIONS 64
+
+/**
+ * @brief Moves commands and display RAM data to an SSD1306. The display core
+ * decides what to send, the transport frames it for its bus: a control byte
+ * on I2C, the DC pin on SPI.
+ */
+class SSD1306Transport
+{
+public:
+    // Called once an asynchronous transfer is off the bus, possibly from an
+    // interrupt
+    using TransferCallback = void (*)(void *context);
+
+    SSD1306Transport();
+    virtual ~SSD1306Transport() = default;
+
+    virtual void write_commands(const uint8_t *commands, uint32_t length) = 0;
+    virtual void write_data(const uint8_t *data, uint32_t length) = 0;
+    virtual void write_data_framed(uint8_t *buffer, uint32_t length);
+
+    virtual bool async_ready();
+    virtual void write_data_async(const uint8_t *data, uint32_t length, TransferCallback callback,
+                                  void *context);
+    virtual void wait();
+    virtual bool busy();
+
+    virtual uint32_t set_clock(uint32_t hz);
+
+    virtual uint32_t transfer_us();
+    virtual uint32_t cpu_us();
+    virtual uint32_t transfer_aborts();
+    virtual uint32_t framing_bytes();
+    uint32_t bytes_written();
+
+protected:
+    // Running count of bytes put on the bus, framing included
+    uint32_t mBytesWritten;
+};
+
+/**
+ * @brief Stand-in transport for the host. Keeps every transaction instead of
+ * sending it, so the byte stream the display core produces can be checked.
+ */
+class SSD1306RecordingTransport
+    : public SSD1306Transport
+{
+public:
+    enum Kind : uint8_t {
+        COMMAND = 0,
+        DATA
+    };
+
+    struct Transaction {
+        Kind kind;
+        uint32_t offset;    // Start of the transaction in bytes()
+        uint32_t length;
+    };
+
+    SSD1306RecordingTransport();
+
+    void write_commands(const uint8_t *commands, uint32_t length) override;
+    void write_data(const uint8_t *data, uint32_t length) override;
+
+    void clear();
+    uint32_t transactions();
+    const Transaction *transaction(uint32_t index);
+    const uint8_t *bytes();
+    uint32_t length();
+    bool overflow();
+
+private:
+    uint8_t mBytes[SSD1306_RECORD_BYTES];
+    uint32_t mLength;
+    Transaction mTransactions[SSD1306_RECORD_TRANSACTIONS];
+    uint32_t mTransactionCount;
+    bool mOverflow;
+
+    void record(Kind kind, const uint8_t *bytes, uint32_t length);
+};
+
+#endif // SSD1306_TRANSPORT_H
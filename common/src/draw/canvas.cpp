@@ -208,8 +208,12 @@ void canvas_draw_bmp_sprite(Canvas *canvas, Bitmap *bmp, bmp_sprite_view *sprite
     }
 }
 
-void canvas_draw_grayscale_bmp_sprite(Canvas *canvas, Bitmap *bmp, bmp_sprite_view *sprite, uint32_t layer,
-                            uint32_t offset_x, uint32_t offset_y)
+/**
+ * @brief Draws one plane of a grayscale sprite. Layers light every pixel
+ * brighter than the layer, bit planes light the pixels that have the bit set.
+ */
+static void canvas_draw_grayscale_plane(Canvas *canvas, Bitmap *bmp, bmp_sprite_view *sprite, uint32_t layer,
+                                        bool bitplane, uint32_t offset_x, uint32_t offset_y)
 {
     uint8_t size = sprite->magnify;
     uint32_t x = 0;
@@ -280,7 +284,8 @@ void canvas_draw_grayscale_bmp_sprite(Canvas *canvas, Bitmap *bmp, bmp_sprite_vi
                 }
                 // printf("%d: canvas_x: %d, canvas_y: %d\n", x, x_point, y_point);
                 // Draw the bitmap pixel to the canvas
-                if(byte > layer) {
+                bool lit = bitplane ? ((byte >> layer) & 1) : (byte > layer);
+                if(lit) {
                     // printf("-");
                     canvas_draw_point(canvas, x_point, y_point, white, size);
                 } else {
@@ -292,3 +297,15 @@ void canvas_draw_grayscale_bmp_sprite(Canvas *canvas, Bitmap *bmp, bmp_sprite_vi
     }
     // printf("\n");
 }
+
+void canvas_draw_grayscale_bmp_sprite(Canvas *canvas, Bitmap *bmp, bmp_sprite_view *sprite, uint32_t layer,
+                            uint32_t offset_x, uint32_t offset_y)
+{
+    canvas_draw_grayscale_plane(canvas, bmp, sprite, layer, false, offset_x, offset_y);
+}
+
+void canvas_draw_grayscale_bmp_bitplane(Canvas *canvas, Bitmap *bmp, bmp_sprite_view *sprite, uint32_t bit,
+                                        uint32_t offset_x, uint32_t offset_y)
+{
+    canvas_draw_grayscale_plane(canvas, bmp, sprite, bit, true, offset_x, offset_y);
+}
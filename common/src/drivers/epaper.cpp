@@ -1,12 +1,82 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
 #include "common/drivers/epaper.h"
 
+// Longest the panel may hold BUSY high in each phase
+#define EPD_RESET_TIMEOUT_MS    1000
+#define EPD_REFRESH_TIMEOUT_MS  5000
+
+static uint32_t epaper_window_bytes(const DrvEPaper::Window &window)
+{
+    return ((window.xEnd - window.xStart) + 1) * ((window.yEnd - window.yStart) + 1);
+}
+
+// Panel the DMA and BUSY interrupts belong to, only one panel is driven by
+// interrupts at a time
+static DrvEPaper *epaper_panel = nullptr;
+
+static const DrvEPaper::Window epaper_full_window = {
+    0, 0, EPD_1IN54_V2_WIDTH_BYTES - 1, EPD_1IN54_V2_HEIGHT - 1
+};
+
+// Waveform for partial refreshes, from the panel vendor. The voltages that go
+// with it follow the waveform itself.
+#define EPD_PARTIAL_LUT_LEN     153
+static const uint8_t epaper_lut_partial[] = {
+    0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x40, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00,
+    0x02,                   // LUT_END_OPTION
+    0x17,                   // GATE_DRIVING_VOLTAGE
+    0x41, 0xB0, 0x32,       // SOURCE_DRIVING_VOLTAGE
+    0x28                    // VCOM_VOLTAGE
+};
+
 DrvEPaper::DrvEPaper(spi_inst_t *spi, uint32_t cs, uint32_t dc, uint32_t busy, uint32_t reset) :
     mSpi(spi),
     mPinChipSelect(cs),
     mPinDataCommand(dc),
     mPinBusy(busy),
-    mPinReset(reset)
+    mPinReset(reset),
+    mInitialized(false),
+    mUploadUs(0),
+    mDmaChannel(-1),
+    mState(State::IDLE),
+    mSleepAfter(false),
+    mPhaseStart(0),
+    mTimeouts(0),
+    mPartialMode(false),
+    mPartialCount(0),
+    mFullRefreshInterval(EPD_FULL_REFRESH_INTERVAL),
+    mShadow(nullptr),
+    mShadowValid(false),
+    mBytesWritten(0)
 {
+    for(uint32_t i = 0; i < PHASES; i++) {
+        mPhaseUs[i] = 0;
+    }
+
     // initialize();
     // uint8_t data[11];
     // read(cmd_otp_read, data, sizeof(data));
@@ -15,8 +85,25 @@ DrvEPaper::DrvEPaper(spi_inst_t *spi, uint32_t cs, uint32_t dc, uint32_t busy, u
     // }
 }
 
+DrvEPaper::~DrvEPaper()
+{
+    free(mShadow);
+}
+
 void DrvEPaper::reset()
 {
+    // A reset in the middle of a refresh leaves the panel half drawn
+    waitRefresh();
+
+    // The partial waveform is lost along with the rest of the registers, data
+    // entry mode included
+    mInitialized = false;
+    mPartialMode = false;
+
+    // The RAM is not known to survive a reset, the next update sends it whole
+    invalidateShadow();
+
+    uint64_t start = time_us_64();
     gpio_set_dir(mPinReset, GPIO_OUT);
     LOG_TRACE("Display reset HIGH\n");
     gpio_put(mPinReset, 1);
@@ -28,23 +115,23 @@ void DrvEPaper::reset()
     gpio_put(mPinReset, 1);
     sleep_ms(100);
 
-    while(isBusy()) {
-        sleep_ms(200);
-    }
+    waitReady(PHASE_RESET, start, EPD_RESET_TIMEOUT_MS);
 }
 
 void DrvEPaper::wake()
 {
+    uint64_t start = time_us_64();
     write(COMMAND, DISPLAY_UPDATE);
     write(DATA, 0xC7);
     write(COMMAND, MASTER_ACTIVATION);
-    while(isBusy()) {
-        sleep_ms(200);
-    }
+    waitReady(PHASE_REFRESH, start, EPD_REFRESH_TIMEOUT_MS);
 }
 
 void DrvEPaper::sleep() 
 {
+    // Deep sleep in the middle of a refresh leaves the panel half drawn
+    waitRefresh();
+
     //After this command initiated, the chip will
     // enter Deep Sleep Mode, BUSY pad will keep
     // output high.
@@ -54,17 +141,20 @@ void DrvEPaper::sleep()
     write(COMMAND, 0x10); //enter deep sleep
     write(DATA, 0x01); 
     sleep_ms(100);
+
+    // Only a reset brings the panel back, and the registers with it
+    mInitialized = false;
+    mPartialMode = false;
 }
 
 void DrvEPaper::initialize()
 {
     reset();    
 
+    uint64_t start = time_us_64();
     write(COMMAND, Command::SW_RESET);
 
-    while(isBusy()) {
-        sleep_ms(200);
-    }
+    waitReady(PHASE_INIT, start, EPD_RESET_TIMEOUT_MS);
 
     // Init code
     write(COMMAND, Command::DRIVER_OUTPUT);
@@ -99,11 +189,9 @@ void DrvEPaper::initialize()
     write(DATA, 0xC7);
     write(DATA, 0x00);
 
-    while(isBusy()) {
-        sleep_us(100);
-        // LOG_TRACE("Display busy\n");
-    }
-    sleep_ms(200);
+    // The panel is ready as soon as BUSY falls, no settling time on top
+    waitReady(PHASE_INIT, start, EPD_RESET_TIMEOUT_MS);
+    mInitialized = true;
 }
 
 void DrvEPaper::write(uint8_t type, uint8_t byte)
@@ -117,6 +205,7 @@ void DrvEPaper::write(uint8_t type, uint8_t byte)
 
     gpio_put(mPinChipSelect, 0);
     int32_t written = spi_write_blocking(mSpi, &byte, 1);
+    mBytesWritten += written;
     if(written != 1) {
         LOG_WARN("Failed to write 0x%02x\n", byte);
     } else {
@@ -126,6 +215,84 @@ void DrvEPaper::write(uint8_t type, uint8_t byte)
     gpio_put(mPinChipSelect, 1);
 }
 
+/**
+ * @brief Sets the Data/Command pin and shifts out a buffer, the caller holds
+ * chip select
+ */
+void DrvEPaper::send(uint8_t type, const uint8_t *buffer, uint32_t length)
+{
+    // Only returns once the last bit is out, so the pin can change after it
+    gpio_put(mPinDataCommand, (type == WriteType::COMMAND) ? 0 : 1);
+    int32_t written = spi_write_blocking(mSpi, buffer, length);
+    mBytesWritten += written;
+    if(written != (int32_t)length) {
+        LOG_WARN("Failed to write %u bytes\n", length);
+    }
+}
+
+/**
+ * @brief Writes a buffer of commands or data in a single chip select window
+ * 
+ * @param type Type of write operation being performed
+ * @param buffer Bytes to write
+ * @param length Length of the buffer in bytes
+ */
+void DrvEPaper::write(uint8_t type, const uint8_t *buffer, uint32_t length)
+{
+    gpio_put(mPinChipSelect, 0);
+    send(type, buffer, length);
+    gpio_put(mPinChipSelect, 1);
+}
+
+/**
+ * @brief Writes a command followed by its data in a single chip select window
+ * 
+ * @param cmd Command to write
+ * @param data Data of the command, a whole RAM plane for the write RAM commands
+ * @param length Length of the data in bytes
+ */
+void DrvEPaper::command(uint8_t cmd, const uint8_t *data, uint32_t length)
+{
+    gpio_put(mPinChipSelect, 0);
+    send(WriteType::COMMAND, &cmd, 1);
+    if(length > 0) {
+        send(WriteType::DATA, data, length);
+    }
+    gpio_put(mPinChipSelect, 1);
+}
+
+/**
+ * @brief Fills a RAM plane with the same byte in a single chip select window
+ */
+void DrvEPaper::fillRam(uint8_t ram, uint8_t byte)
+{
+    uint8_t row[EPD_1IN54_V2_WIDTH_BYTES];
+    memset(row, byte, sizeof(row));
+    setWindow(epaper_full_window);
+
+    uint64_t start = time_us_64();
+    gpio_put(mPinChipSelect, 0);
+    send(WriteType::COMMAND, &ram, 1);
+    for(uint32_t y = 0; y < EPD_1IN54_V2_HEIGHT; y++) {
+        send(WriteType::DATA, row, sizeof(row));
+    }
+    gpio_put(mPinChipSelect, 1);
+    if((ram == WRITE_RAM_BW) && (mShadow != nullptr)) {
+        memset(mShadow, byte, EPD_1IN54_V2_BUF_LEN);
+        mShadowValid = true;
+    }
+    mUploadUs = (uint32_t)(time_us_64() - start);
+    LOG_DEBUG("Filled %u bytes in %u us\n", EPD_1IN54_V2_BUF_LEN, mUploadUs);
+}
+
+/**
+ * @brief Retrieves the time the last RAM plane took to upload
+ */
+uint32_t DrvEPaper::uploadUs()
+{
+    return mUploadUs;
+}
+
 bool DrvEPaper::isBusy()
 {
     gpio_set_dir(mPinBusy, GPIO_IN);
@@ -134,43 +301,659 @@ bool DrvEPaper::isBusy()
 
 void DrvEPaper::display(uint8_t *image)
 {
-    uint8_t Width, Height;
-    Width = (EPD_1IN54_V2_WIDTH % 8 == 0)? (EPD_1IN54_V2_WIDTH / 8 ): (EPD_1IN54_V2_WIDTH / 8 + 1);
-    Height = EPD_1IN54_V2_HEIGHT;
+    waitRefresh();
+    leavePartial();
 
-    uint32_t Addr = 0;
-    write(COMMAND, WRITE_RAM_BW);
-    for(uint16_t j = 0; j < Height; j++) {
-        for (uint16_t i = 0; i < Width; i++) {
-            Addr = i + j * Width;
-            write(DATA, image[Addr]);
-        }
+    // Each window goes out in one chip select window, rather than one per
+    // byte, which used to cost more than shifting the byte itself
+    Window windows[EPD_DIFF_WINDOWS_MAX];
+    uint32_t count = diffWindows(image, windows, EPD_DIFF_WINDOWS_MAX);
+    uint32_t written = mBytesWritten;
+    uint64_t start = time_us_64();
+    for(uint32_t i = 0; i < count; i++) {
+        writeWindow(WRITE_RAM_BW, image, windows[i]);
     }
+    mUploadUs = (uint32_t)(time_us_64() - start);
+    LOG_DEBUG("Uploaded %u bytes in %u windows in %u us\n", mBytesWritten - written, count, mUploadUs);
     wake();
 }
 
 void DrvEPaper::fillScreen(uint8_t byte)
 {
-    unsigned int i;	
-    write(COMMAND, WRITE_RAM_BW);   //write RAM for black(0)/white (1)
-    for(i = 0; i < 5000; i++)
-    {               
-        write(DATA, byte);
-    }
-    
+    waitRefresh();
+    leavePartial();
+    fillRam(WRITE_RAM_BW, byte);   //write RAM for black(0)/white (1)
+
     // write(COMMAND, WRITE_RAM_RED);   //write RAM for black(0)/white (1)
     // for(i = 0; i < 5000; i++)
     // {               
     //     write(DATA, 0x55);
     // }
 
+    uint64_t start = time_us_64();
     write(COMMAND, Command::DISPLAY_UPDATE); //Display Update Control
     write(DATA, 0xF7);   
     write(COMMAND, Command::MASTER_ACTIVATION);  //Activate Display Update Sequence
 
-    while(isBusy()) {
-        sleep_us(100);
-        // LOG_TRACE("Display busy\n");
+    waitReady(PHASE_REFRESH, start, EPD_REFRESH_TIMEOUT_MS);
+}
+
+/**
+ * @brief Takes over the BUSY pin interrupt with a raw handler, which leaves
+ * the GPIO callback to the application. Only one panel can own it.
+ * 
+ * @return True if this panel owns the interrupt
+ */
+bool DrvEPaper::busyIrqInit()
+{
+    if(epaper_panel == nullptr) {
+        epaper_panel = this;
+        gpio_add_raw_irq_handler(mPinBusy, busyIrq);
+        irq_set_enabled(IO_IRQ_BANK0, true);
+    }
+    return epaper_panel == this;
+}
+
+/**
+ * @brief Waits for the panel to drop BUSY. Sleeps until the falling edge
+ * interrupt when this panel owns it, polls otherwise.
+ * 
+ * @param phase Phase to record the time against
+ * @param start When the phase started
+ * @param timeoutMs Longest to wait
+ * @return True if the panel is ready, false on timeout
+ */
+bool DrvEPaper::waitReady(Phase phase, uint64_t start, uint32_t timeoutMs)
+{
+    absolute_time_t deadline = make_timeout_time_ms(timeoutMs);
+    bool timedOut = false;
+
+    if(busyIrqInit()) {
+        // An edge between the check and the wait still ends the wait, the
+        // handler raises an event for it
+        gpio_acknowledge_irq(mPinBusy, GPIO_IRQ_EDGE_FALL);
+        gpio_set_irq_enabled(mPinBusy, GPIO_IRQ_EDGE_FALL, true);
+        while(isBusy() && !timedOut) {
+            timedOut = best_effort_wfe_or_timeout(deadline);
+        }
+        gpio_set_irq_enabled(mPinBusy, GPIO_IRQ_EDGE_FALL, false);
+    } else {
+        while(isBusy() && !timedOut) {
+            sleep_us(100);
+            timedOut = time_reached(deadline);
+        }
+    }
+
+    // The loop can time out in the same instant BUSY falls
+    timedOut = timedOut && isBusy();
+    mPhaseUs[phase] = (uint32_t)(time_us_64() - start);
+    if(timedOut) {
+        mTimeouts++;
+        LOG_WARN("Panel still busy after %u ms (phase %u)\n", timeoutMs, phase);
+    } else {
+        LOG_TRACE("Phase %u took %u us\n", phase, mPhaseUs[phase]);
+    }
+    return !timedOut;
+}
+
+/**
+ * @brief Sets up asynchronous updates. Claims a DMA channel to feed the SPI
+ * FIFO, shares DMA_IRQ_0 with any other user and takes over the BUSY pin
+ * interrupt.
+ * 
+ * @return True if updates can run asynchronously
+ */
+bool DrvEPaper::asyncInit()
+{
+    if(mDmaChannel >= 0) {
+        return true;
+    }
+    if(!busyIrqInit()) {
+        return false;
+    }
+
+    mDmaChannel = dma_claim_unused_channel(false);
+    if(mDmaChannel < 0) {
+        return false;
+    }
+
+    dma_channel_config config = dma_channel_get_default_config(mDmaChannel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, spi_get_dreq(mSpi, true));
+    dma_channel_configure(mDmaChannel, &config, &spi_get_hw(mSpi)->dr, NULL, 0, false);
+
+    irq_add_shared_handler(DMA_IRQ_0, dmaIrq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+    dma_channel_set_irq0_enabled(mDmaChannel, true);
+    return true;
+}
+
+/**
+ * @brief Uploads an image by DMA and starts a full refresh, without waiting
+ * for either. The image must stay untouched until uploadBusy returns false,
+ * the refresh then carries on from the panel RAM. Waits for the previous
+ * update first, and wakes a panel left asleep or reset with an init. Falls
+ * back to a blocking update without asyncInit.
+ * 
+ * @param image Image to show, EPD_1IN54_V2_BUF_LEN bytes
+ * @param sleepAfter Put the panel in deep sleep once refreshed
+ */
+void DrvEPaper::displayAsync(const uint8_t *image, bool sleepAfter)
+{
+    if(mDmaChannel < 0) {
+        display((uint8_t*)image);
+        if(sleepAfter) {
+            sleep();
+        }
+        return;
+    }
+
+    waitRefresh();
+    leavePartial();
+
+    mSleepAfter = sleepAfter;
+    mState = State::UPLOADING;
+    mPhaseStart = time_us_64();
+
+    Window windows[EPD_DIFF_WINDOWS_MAX];
+    uint32_t count = diffWindows(image, windows, EPD_DIFF_WINDOWS_MAX);
+    uint32_t bytes = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        bytes += epaper_window_bytes(windows[i]);
+    }
+
+    if((bytes * 2) <= EPD_1IN54_V2_BUF_LEN) {
+        // Small changes go out blocking, over in less time than the refresh
+        // takes to start anyway
+        uint32_t written = mBytesWritten;
+        for(uint32_t i = 0; i < count; i++) {
+            writeWindow(WRITE_RAM_BW, image, windows[i]);
+        }
+        LOG_DEBUG("Uploaded %u bytes in %u windows\n", mBytesWritten - written, count);
+        uploadDone();
+        return;
+    }
+
+    // Larger ones send the whole plane, which the DMA can do in one go
+    setWindow(epaper_full_window);
+    if(mShadow != nullptr) {
+        memcpy(mShadow, image, EPD_1IN54_V2_BUF_LEN);
+        mShadowValid = true;
+    }
+    mBytesWritten += EPD_1IN54_V2_BUF_LEN;
+
+    uint8_t cmd = WRITE_RAM_BW;
+    gpio_put(mPinChipSelect, 0);
+    send(WriteType::COMMAND, &cmd, 1);
+    gpio_put(mPinDataCommand, 1);
+    dma_channel_transfer_from_buffer_now(mDmaChannel, image, EPD_1IN54_V2_BUF_LEN);
+}
+
+/**
+ * @brief Ends the upload and starts the refresh. Runs from the DMA interrupt
+ * once the FIFO has taken the last byte, or straight after a blocking upload.
+ */
+void DrvEPaper::uploadDone()
+{
+    // CS has to hold until the last byte has been shifted out
+    while(spi_is_busy(mSpi)) {
+        tight_loop_contents();
+    }
+    gpio_put(mPinChipSelect, 1);
+
+    uint64_t now = time_us_64();
+    mUploadUs = (uint32_t)(now - mPhaseStart);
+    mPhaseStart = now;
+    mState = State::REFRESHING;
+    __sev();
+
+    // BUSY rises once the refresh starts and falls when it is done. Edges
+    // latched before now belong to earlier updates.
+    gpio_acknowledge_irq(mPinBusy, GPIO_IRQ_EDGE_FALL);
+    gpio_set_irq_enabled(mPinBusy, GPIO_IRQ_EDGE_FALL, true);
+
+    uint8_t update = 0xC7;
+    command(Command::DISPLAY_UPDATE, &update, 1);
+    command(Command::MASTER_ACTIVATION);
+}
+
+/**
+ * @brief Ends the refresh. Runs from the GPIO interrupt once BUSY falls.
+ */
+void DrvEPaper::refreshDone()
+{
+    gpio_set_irq_enabled(mPinBusy, GPIO_IRQ_EDGE_FALL, false);
+    mPhaseUs[PHASE_REFRESH] = (uint32_t)(time_us_64() - mPhaseStart);
+
+    if(mSleepAfter) {
+        // Left until the next reset, as with sleep()
+        uint8_t mode = 0x01;
+        command(Command::DEEP_SLEEP_MODE, &mode, 1);
+        mInitialized = false;
+    }
+    mState = State::IDLE;
+    __sev();
+}
+
+void DrvEPaper::dmaIrq()
+{
+    DrvEPaper *paper = epaper_panel;
+    if(paper && (paper->mDmaChannel >= 0) && dma_channel_get_irq0_status(paper->mDmaChannel)) {
+        dma_channel_acknowledge_irq0(paper->mDmaChannel);
+        paper->uploadDone();
+    }
+}
+
+void DrvEPaper::busyIrq()
+{
+    DrvEPaper *paper = epaper_panel;
+    if(paper && (gpio_get_irq_event_mask(paper->mPinBusy) & GPIO_IRQ_EDGE_FALL)) {
+        gpio_acknowledge_irq(paper->mPinBusy, GPIO_IRQ_EDGE_FALL);
+        if(paper->mState == State::REFRESHING) {
+            paper->refreshDone();
+        }
+        // Wakes blocking waits in waitReady
+        __sev();
+    }
+}
+
+/**
+ * @brief Checks if the image handed to displayAsync is still being read
+ */
+bool DrvEPaper::uploadBusy()
+{
+    return mState == State::UPLOADING;
+}
+
+/**
+ * @brief Checks if an asynchronous update is still in progress
+ */
+bool DrvEPaper::refreshBusy()
+{
+    return mState != State::IDLE;
+}
+
+void DrvEPaper::waitUpload()
+{
+    while(uploadBusy()) {
+        __wfe();
+    }
+}
+
+/**
+ * @brief Waits for the asynchronous update in progress. A panel that never
+ * drops BUSY is given up on after EPD_REFRESH_TIMEOUT_MS, it is reset before
+ * the next update anyway.
+ */
+void DrvEPaper::waitRefresh()
+{
+    if(!refreshBusy()) {
+        return;
+    }
+
+    absolute_time_t deadline = from_us_since_boot(mPhaseStart + (EPD_REFRESH_TIMEOUT_MS * 1000ULL));
+    while(refreshBusy()) {
+        if(best_effort_wfe_or_timeout(deadline) && refreshBusy()) {
+            gpio_set_irq_enabled(mPinBusy, GPIO_IRQ_EDGE_FALL, false);
+            dma_channel_abort(mDmaChannel);
+            gpio_put(mPinChipSelect, 1);
+            mTimeouts++;
+            mState = State::IDLE;
+            // The upload may have been cut short
+            mShadowValid = false;
+            LOG_WARN("Asynchronous update timed out\n");
+        }
+    }
+}
+
+/**
+ * @brief Retrieves the time the last refresh took, waits on the panel included
+ */
+uint32_t DrvEPaper::refreshUs()
+{
+    return mPhaseUs[PHASE_REFRESH];
+}
+
+/**
+ * @brief Retrieves the time the panel held BUSY in the last run of a phase
+ */
+uint32_t DrvEPaper::phaseUs(Phase phase)
+{
+    return (phase < PHASES) ? mPhaseUs[phase] : 0;
+}
+
+/**
+ * @brief Retrieves the number of waits on BUSY that timed out
+ */
+uint32_t DrvEPaper::timeouts()
+{
+    return mTimeouts;
+}
+
+/**
+ * @brief Points the RAM address counters at a window. Writes to the RAM then
+ * fill the window row by row and leave the rest of the RAM alone.
+ */
+void DrvEPaper::setWindow(const Window &window)
+{
+    // Rows count down from the top of the RAM, as set up by DATA_ENTRY_MODE in
+    // initialize
+    uint32_t top = (EPD_1IN54_V2_HEIGHT - 1) - window.yStart;
+    uint32_t bottom = (EPD_1IN54_V2_HEIGHT - 1) - window.yEnd;
+
+    uint8_t x[2] = { (uint8_t)window.xStart, (uint8_t)window.xEnd };
+    uint8_t y[4] = {
+        (uint8_t)(top & 0xFF), (uint8_t)(top >> 8), (uint8_t)(bottom & 0xFF), (uint8_t)(bottom >> 8)
+    };
+    command(Command::RAM_X_ADDR, x, sizeof(x));
+    command(Command::RAM_Y_ADDR, y, sizeof(y));
+    command(Command::RAM_X_COUNTER, &x[0], 1);
+    command(Command::RAM_Y_COUNTER, y, 2);
+}
+
+/**
+ * @brief Writes the part of an image inside a window to a RAM plane, in a
+ * single chip select window
+ * 
+ * @param ram Write RAM command of the plane
+ * @param image Whole image, EPD_1IN54_V2_BUF_LEN bytes
+ * @param window Part of the image to write
+ */
+void DrvEPaper::writeWindow(uint8_t ram, const uint8_t *image, const Window &window)
+{
+    setWindow(window);
+
+    uint32_t width = (window.xEnd - window.xStart) + 1;
+    uint32_t rows = (window.yEnd - window.yStart) + 1;
+    const uint8_t *row = &image[(window.yStart * EPD_1IN54_V2_WIDTH_BYTES) + window.xStart];
+
+    gpio_put(mPinChipSelect, 0);
+    send(WriteType::COMMAND, &ram, 1);
+    if(width == EPD_1IN54_V2_WIDTH_BYTES) {
+        // Full rows follow each other in the image
+        send(WriteType::DATA, row, rows * width);
+    } else {
+        for(uint32_t y = 0; y < rows; y++) {
+            send(WriteType::DATA, row, width);
+            row += EPD_1IN54_V2_WIDTH_BYTES;
+        }
+    }
+    gpio_put(mPinChipSelect, 1);
+
+    if((ram == WRITE_RAM_BW) && (mShadow != nullptr)) {
+        for(uint32_t y = window.yStart; y <= window.yEnd; y++) {
+            uint32_t offset = (y * EPD_1IN54_V2_WIDTH_BYTES) + window.xStart;
+            memcpy(&mShadow[offset], &image[offset], width);
+        }
+        if(epaper_window_bytes(window) == EPD_1IN54_V2_BUF_LEN) {
+            mShadowValid = true;
+        }
+    }
+}
+
+/**
+ * @brief Splits the bytes of an image that differ from the panel RAM into
+ * windows, one per band of changed rows. Bands closer than
+ * EPD_DIFF_MERGE_ROWS share a window, as each costs a few commands to set
+ * up, and the last window takes in the rest once they run out.
+ * 
+ * @param image Whole image, EPD_1IN54_V2_BUF_LEN bytes
+ * @param windows Returns the windows
+ * @param max Windows that fit, at least 1
+ * @return Number of windows, 0 if nothing changed. The whole panel makes up
+ * the only window without a valid shadow.
+ */
+uint32_t DrvEPaper::diffWindows(const uint8_t *image, Window *windows, uint32_t max)
+{
+    if((mShadow == nullptr) || !mShadowValid) {
+        windows[0] = epaper_full_window;
+        return 1;
+    }
+
+    uint32_t count = 0;
+    for(uint32_t y = 0; y < EPD_1IN54_V2_HEIGHT; y++) {
+        const uint8_t *row = &image[y * EPD_1IN54_V2_WIDTH_BYTES];
+        const uint8_t *shadow = &mShadow[y * EPD_1IN54_V2_WIDTH_BYTES];
+        if(memcmp(row, shadow, EPD_1IN54_V2_WIDTH_BYTES) == 0) {
+            continue;
+        }
+
+        uint32_t xStart = 0;
+        while(row[xStart] == shadow[xStart]) {
+            xStart++;
+        }
+        uint32_t xEnd = EPD_1IN54_V2_WIDTH_BYTES - 1;
+        while(row[xEnd] == shadow[xEnd]) {
+            xEnd--;
+        }
+
+        Window *last = (count > 0) ? &windows[count - 1] : nullptr;
+        if((last != nullptr) && (((y - last->yEnd - 1) <= EPD_DIFF_MERGE_ROWS) || (count == max))) {
+            last->yEnd = y;
+            last->xStart = (xStart < last->xStart) ? xStart : last->xStart;
+            last->xEnd = (xEnd > last->xEnd) ? xEnd : last->xEnd;
+        } else {
+            windows[count++] = { xStart, y, xEnd, y };
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Loads the partial waveform. The panel has to be showing the base
+ * image already.
+ */
+void DrvEPaper::partialInit()
+{
+    uint64_t start = time_us_64();
+    command(Command::WRITE_LUT, epaper_lut_partial, EPD_PARTIAL_LUT_LEN);
+    waitReady(PHASE_INIT, start, EPD_RESET_TIMEOUT_MS);
+
+    command(Command::LUT_END_OPTION, &epaper_lut_partial[EPD_PARTIAL_LUT_LEN], 1);
+    command(Command::GATE_DRIVING_VOLTAGE, &epaper_lut_partial[EPD_PARTIAL_LUT_LEN + 1], 1);
+    command(Command::SOURCE_DRIVING_VOLTAGE, &epaper_lut_partial[EPD_PARTIAL_LUT_LEN + 2], 3);
+    command(Command::VCOM_VOLTAGE, &epaper_lut_partial[EPD_PARTIAL_LUT_LEN + 5], 1);
+
+    uint8_t border = 0x80;
+    command(Command::BORDER_WAVEFORM, &border, 1);
+
+    // Powers up the analog side. The refreshes that follow skip loading a
+    // waveform from OTP, which keeps the one loaded above.
+    uint8_t update = 0xC0;
+    command(Command::DISPLAY_UPDATE, &update, 1);
+    command(Command::MASTER_ACTIVATION);
+    waitReady(PHASE_INIT, start, EPD_RESET_TIMEOUT_MS);
+
+    mPartialMode = true;
+    mPartialCount = 0;
+}
+
+/**
+ * @brief Brings back the full waveform and the voltages that go with it, a
+ * full refresh with the partial ones leaves a faded image. Also redoes the
+ * init after a reset or deep sleep, without which windows would be written
+ * with the power-on data entry mode.
+ */
+void DrvEPaper::leavePartial()
+{
+    if(mPartialMode || !mInitialized) {
+        initialize();
     }
-    sleep_ms(200);
+}
+
+/**
+ * @brief Shows an image with a full refresh and makes it the base of the
+ * partial refreshes that follow. The panel is reset first, so it may be
+ * asleep, and is left in partial mode until the next reset, sleep or full
+ * refresh.
+ * 
+ * @param image Image to show, EPD_1IN54_V2_BUF_LEN bytes
+ */
+void DrvEPaper::displayBase(const uint8_t *image)
+{
+    initialize();
+
+    // The red RAM holds the image on the panel, partial refreshes only drive
+    // the pixels that differ from it
+    uint64_t start = time_us_64();
+    writeWindow(WRITE_RAM_BW, image, epaper_full_window);
+    writeWindow(WRITE_RAM_RED, image, epaper_full_window);
+    mUploadUs = (uint32_t)(time_us_64() - start);
+    wake();
+
+    partialInit();
+    LOG_DEBUG("Base image shown in %u us\n", (uint32_t)(time_us_64() - start));
+}
+
+/**
+ * @brief Shows an image with a partial refresh of the windows that changed
+ * since the last update. Every EPD_FULL_REFRESH_INTERVAL partial refreshes,
+ * or without a base image, a full refresh through displayBase is done
+ * instead to clear the ghosting.
+ * 
+ * @param image Whole image, EPD_1IN54_V2_BUF_LEN bytes
+ */
+void DrvEPaper::displayPartial(const uint8_t *image)
+{
+    waitRefresh();
+    if(baseDue()) {
+        displayBase(image);
+        return;
+    }
+
+    Window windows[EPD_DIFF_WINDOWS_MAX];
+    uint32_t count = diffWindows(image, windows, EPD_DIFF_WINDOWS_MAX);
+    if(count == 0) {
+        LOG_DEBUG("Image unchanged, nothing to refresh\n");
+        return;
+    }
+    refreshPartial(image, windows, count);
+}
+
+/**
+ * @brief Shows the part of an image inside a window with a partial refresh,
+ * which skips the flashing of a full one. Full refreshes come in as with the
+ * whole image.
+ * 
+ * @param image Whole image, EPD_1IN54_V2_BUF_LEN bytes
+ * @param x Left of the window in pixels, rounded down to a byte
+ * @param y Top of the window in rows
+ * @param width Width of the window in pixels, rounded up to a byte
+ * @param height Height of the window in rows
+ */
+void DrvEPaper::displayPartial(const uint8_t *image, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    if((width == 0) || (height == 0) || (x >= EPD_1IN54_V2_WIDTH) || (y >= EPD_1IN54_V2_HEIGHT)) {
+        return;
+    }
+
+    waitRefresh();
+    if(baseDue()) {
+        displayBase(image);
+        return;
+    }
+
+    uint32_t right = (x + width < EPD_1IN54_V2_WIDTH) ? (x + width) : EPD_1IN54_V2_WIDTH;
+    uint32_t bottom = (y + height < EPD_1IN54_V2_HEIGHT) ? (y + height) : EPD_1IN54_V2_HEIGHT;
+    Window window = { x / 8, y, (right - 1) / 8, bottom - 1 };
+    refreshPartial(image, &window, 1);
+}
+
+/**
+ * @brief Checks if the next update has to be a full refresh with a new base
+ */
+bool DrvEPaper::baseDue()
+{
+    if(!mPartialMode) {
+        return true;
+    }
+    if((mFullRefreshInterval > 0) && (mPartialCount >= mFullRefreshInterval)) {
+        LOG_DEBUG("Full refresh after %u partial refreshes\n", mPartialCount);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Uploads windows of an image and refreshes them, the panel is in
+ * partial mode
+ */
+void DrvEPaper::refreshPartial(const uint8_t *image, const Window *windows, uint32_t count)
+{
+    uint32_t written = mBytesWritten;
+    uint64_t start = time_us_64();
+    for(uint32_t i = 0; i < count; i++) {
+        writeWindow(WRITE_RAM_BW, image, windows[i]);
+    }
+    mUploadUs = (uint32_t)(time_us_64() - start);
+    written = mBytesWritten - written;
+
+    start = time_us_64();
+    uint8_t update = 0xCF;
+    command(Command::DISPLAY_UPDATE, &update, 1);
+    command(Command::MASTER_ACTIVATION);
+    waitReady(PHASE_REFRESH, start, EPD_REFRESH_TIMEOUT_MS);
+
+    // The windows are now on the panel, they become the base of the next ones
+    for(uint32_t i = 0; i < count; i++) {
+        writeWindow(WRITE_RAM_RED, image, windows[i]);
+    }
+    mPartialCount++;
+
+    LOG_DEBUG("Partial refresh of %u bytes in %u windows, uploaded in %u us, refreshed in %u us\n",
+              written, count, mUploadUs, mPhaseUs[PHASE_REFRESH]);
+}
+
+/**
+ * @brief Sets the number of partial refreshes between two full ones
+ * 
+ * @param partials Partial refreshes, 0 to never force a full refresh
+ */
+void DrvEPaper::setFullRefreshInterval(uint32_t partials)
+{
+    mFullRefreshInterval = partials;
+}
+
+/**
+ * @brief Checks if the panel has a base image and the partial waveform loaded
+ */
+bool DrvEPaper::partialMode()
+{
+    return mPartialMode;
+}
+
+/**
+ * @brief Keeps a copy of the black/white RAM, so updates only send the rows
+ * that changed. A reset, which waking from deep sleep takes, invalidates the
+ * copy, so only updates to an awake panel are cut down.
+ * 
+ * @return True if the copy could be allocated
+ */
+bool DrvEPaper::shadowInit()
+{
+    if(mShadow == nullptr) {
+        mShadow = (uint8_t*)malloc(EPD_1IN54_V2_BUF_LEN);
+        mShadowValid = false;
+    }
+    return mShadow != nullptr;
+}
+
+/**
+ * @brief Makes the next update send the whole image, for when the panel RAM
+ * may no longer match the copy, after a reset or power cycle for one
+ */
+void DrvEPaper::invalidateShadow()
+{
+    mShadowValid = false;
+}
+
+/**
+ * @brief Retrieves the number of bytes put on the bus so far, commands
+ * included. Callers take the difference of two readings to measure an update.
+ */
+uint32_t DrvEPaper::bytesWritten()
+{
+    return mBytesWritten;
 }
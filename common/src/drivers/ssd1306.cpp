@@ -1,576 +1,477 @@
-#include "common/drivers/ssd1306.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/timer.h"
 
-void ssd1306_write(SSD1306Dev *dev, uint8_t byte) 
-{
-    uint8_t buf[2] = {0x80, byte};
-    i2c_write_blocking(dev->bus, (dev->address & OLED_WRITE_MODE), buf, 2, false);
-}
-
-void ssd1306_write_buffer(SSD1306Dev *dev, uint8_t *buffer, int32_t buffer_length)
-{
-    uint8_t *temp_buf = buffer;
-    temp_buf[0] = 0x40;
+#include "common/drivers/ssd1306.h"
 
-    // uint8_t *temp = &buffer[1];
-    // for(int i = 0; i < buffer_length - 1; i++) {
-    //     // temp_buf[i] = buffer[i - 1];
-    //     if(i % 8 == 0) {
-    //         printf("\n%02d: ", i / 8);
-    //     }
-    //     for(int8_t bit = 0; bit < 8; bit++) {
-    //         uint8_t shift = 1 << (bit);
-    //         if(temp[i] & shift) {
-    //             printf("0");
-    //         } else {
-    //             printf(".");
-    //         }
-    //     }
-    //     // printf("%02X ", temp_buf[i]);
-    // }
-    // printf("\n");
+// Display running an asynchronous transfer on each I2C bus, for the interrupt
+static SSD1306I2CTransport *ssd1306_transfer_owner[2] = {nullptr, nullptr};
 
-    i2c_write_blocking(dev->bus, (dev->address & OLED_WRITE_MODE), temp_buf, buffer_length, false);
-}
+// SPI displays sending a transfer by DMA, one per bus, for the interrupt
+static SSD1306SpiTransport *ssd1306_spi_transfer_owner[2] = {nullptr, nullptr};
 
-void ssd1306_fill_screen(SSD1306Dev *dev, uint8_t byte)
+/**
+ * @brief Construct a new SSD1306 I2C transport
+ */
+SSD1306I2CTransport::SSD1306I2CTransport(i2c_inst_t *bus, uint8_t address) :
+    mBus(bus),
+    mAddress(address),
+    mDmaChannel(-1),
+    mTransferBusy(false),
+    mTransferStart(0),
+    mTransferUs(0),
+    mCpuUs(0),
+    mTransferAborts(0),
+    mTransferCallback(nullptr),
+    mTransferContext(nullptr)
 {
-    ssd1306_write(dev, OLED_SET_COL_ADDR);
-    ssd1306_write(dev, 0);
-    ssd1306_write(dev, 0);
-
-    ssd1306_write(dev, OLED_SET_PAGE_ADDR);
-    ssd1306_write(dev, 0);
-    ssd1306_write(dev, 0);
 }
 
-void ssd1306_initialize_device(SSD1306Dev *dev)
+void SSD1306I2CTransport::write_commands(const uint8_t *commands, uint32_t length)
 {
-    // some of these commands are not strictly necessary as the reset
-    // process defaults to some of these but they are shown here
-    // to demonstrate what the initialization sequence looks like
-
-    // some configuration values are recommended by the board manufacturer
-
-    ssd1306_write(dev, OLED_SET_DISP | 0x00); // set display off
-
-    /* timing and driving scheme */
-    ssd1306_write(dev, OLED_SET_DISP_CLK_DIV); // set display clock divide ratio
-    ssd1306_write(dev, 0x80); // div ratio of 1, standard freq
-
-    ssd1306_write(dev, OLED_SET_MUX_RATIO); // set multiplex ratio
-    ssd1306_write(dev, OLED_HEIGHT - 1); // our display is only 32 pixels high
-
-    ssd1306_write(dev, OLED_SET_DISP_OFFSET); // set display offset
-    ssd1306_write(dev, 0x00); // no offset
-
-    /* resolution and layout */
-    ssd1306_write(dev, OLED_SET_DISP_START_LINE); // set display start line to 0
-
-    ssd1306_write(dev, OLED_SET_CHARGE_PUMP); // set charge pump
-    ssd1306_write(dev, 0x14); // Vcc internally generated on our board
-
-    /* memory mapping 
-    */
-    ssd1306_write(dev, OLED_SET_MEM_ADDR); // set memory address mode
-    ssd1306_write(dev, 0x00); // horizontal addressing mode
-
-    ssd1306_write(dev, OLED_SET_SEG_REMAP | 0x01); // set segment re-map
-    // column address 127 is mapped to SEG0
+    // Co = 0, D/C = 0 => the driver takes every byte that follows as a command
+    uint8_t buffer[OLED_COMMAND_STREAM_MAX + 1];
+    buffer[0] = 0x00;
 
-    ssd1306_write(dev, OLED_SET_COM_OUT_DIR | 0x08); // set COM (common) output scan direction
-    // scan from bottom up, COM[N-1] to COM0
+    wait();
 
-    ssd1306_write(dev, OLED_SET_COM_PIN_CFG); // set COM (common) pins hardware configuration
-    ssd1306_write(dev, 0x12); // manufacturer magic number
-
-    /* display */
-    ssd1306_write(dev, OLED_SET_CONTRAST); // set contrast control
-    ssd1306_write(dev, 0xCF);
-
-    ssd1306_write(dev, OLED_SET_PRECHARGE); // set pre-charge period
-    ssd1306_write(dev, 0xF1); // Vcc internally generated on our board
-
-    ssd1306_write(dev, OLED_SET_VCOM_DESEL); // set VCOMH deselect level
-    ssd1306_write(dev, 0x40); // 0.83xVcc
-
-    ssd1306_write(dev, OLED_SET_ENTIRE_ON); // set entire display on to follow RAM content
-
-    ssd1306_write(dev, OLED_SET_NORM_INV); // set normal (not inverted) display
-
-    // ssd1306_write(dev, OLED_SET_SCROLL | 0x00); // deactivate horizontal scrolling if set
-    // this is necessary as memory writes will corrupt if scrolling was enabled
-    ssd1306_write(dev, 0x00);
-    ssd1306_write(dev, 0x10);
-    ssd1306_write(dev, 0x40);
-
-    ssd1306_write(dev, OLED_SET_DISP | 0x01); // turn display on
-}
-
-void ssd1306_ignore_ram(SSD1306Dev *dev, bool enable)
-{
-    if(enable) {
-        // Ignore RAM, all pixels on
-        ssd1306_write(dev, 0xA5);
-    } else {
-        // Follow RAM
-        ssd1306_write(dev, 0x7F);
+    uint32_t offset = 0;
+    while(offset < length) {
+        uint32_t count = length - offset;
+        if(count > OLED_COMMAND_STREAM_MAX) {
+            count = OLED_COMMAND_STREAM_MAX;
+        }
+        memcpy(&buffer[1], &commands[offset], count);
+        if(i2c_write_blocking(mBus, (mAddress & OLED_WRITE_MODE), buffer, count + 1, false) < 0) {
+            mTransferAborts++;
+        }
+        mBytesWritten += count + 2;
+        offset += count;
     }
 }
 
-void ssd1306_set_contrast(SSD1306Dev *dev, uint8_t contrast)
+void SSD1306I2CTransport::write_data(const uint8_t *data, uint32_t length)
 {
-    ssd1306_write(dev, OLED_SET_CONTRAST); // set contrast control
-    ssd1306_write(dev, contrast);
-}
+    // Every transaction has to lead with the control byte, otherwise the
+    // display takes the first data byte as the control byte. Rather than
+    // copying the whole buffer, send it behind the control byte a page at a
+    // time. The column address pointer carries on from one transaction to the
+    // next, so the chunks land back to back.
+    uint8_t chunk[OLED_WIDTH + 1];
 
-void ssd1306_set_addressing(SSD1306Dev *dev, uint8_t mode)
-{
-    ssd1306_write(dev, OLED_SET_MEM_ADDR);
-    ssd1306_write(dev, mode);
-}
+    wait();
 
-void ssd1306_reset_cursor(SSD1306Dev *dev)
-{
-    ssd1306_write(dev, OLED_SET_COL_ADDR);
-    ssd1306_write(dev, 0x00);
-    ssd1306_write(dev, 0x7F);
+    // Co = 0, D/C = 1 => the driver expects data to be written to RAM
+    chunk[0] = 0x40;
 
-    ssd1306_write(dev, OLED_SET_PAGE_ADDR);
-    ssd1306_write(dev, 0x00);
-    ssd1306_write(dev, 0x07);
+    uint32_t offset = 0;
+    while(offset < length) {
+        uint32_t count = length - offset;
+        if(count > OLED_WIDTH) {
+            count = OLED_WIDTH;
+        }
+        memcpy(&chunk[1], &data[offset], count);
+        if(i2c_write_blocking(mBus, (mAddress & OLED_WRITE_MODE), chunk, count + 1, false) < 0) {
+            mTransferAborts++;
+        }
+        mBytesWritten += count + 2;
+        offset += count;
+    }
 }
 
-
-void ssd1306_write(ssd1306_spi_device *device, ssd1306_write_type type, const uint8_t *buffer,
-                   uint32_t buffer_length)
+void SSD1306I2CTransport::write_data_framed(uint8_t *buffer, uint32_t length)
 {
-    gpio_set_dir(device->cs, GPIO_OUT);
-    gpio_set_dir(device->dc, GPIO_OUT);
+    wait();
 
-    gpio_put(device->cs, 0);
-    switch(type) {
-    case ssd1306_write_type::COMMAND:
-        gpio_put(device->dc, 0);
-        break;
-    case ssd1306_write_type::DATA:
-        gpio_put(device->dc, 1);
-        break;
-    default:
-        break;
+    // The control byte takes the spare byte, so the data goes out in one
+    // transaction
+    buffer[0] = 0x40;
+    if(i2c_write_blocking(mBus, (mAddress & OLED_WRITE_MODE), buffer, length + 1, false) < 0) {
+        mTransferAborts++;
     }
-
-    spi_write_blocking(device->bus, buffer, buffer_length);
-    gpio_put(device->cs, 1);
+    mBytesWritten += length + 2;
 }
 
-void ssd1306_display(ssd1306_spi_device *device, const uint8_t *buffer, uint32_t buffer_length)
-{
-    ssd1306_write(device, ssd1306_write_type::DATA, buffer, buffer_length);
+/**
+ * @brief Sets up DMA for asynchronous transfers. Claims a DMA channel and
+ * takes over the interrupt of the I2C bus, which must not be shared.
+ * @return True if asynchronous transfers are available
+ */
+bool SSD1306I2CTransport::dma_init()
+{
+    if(mDmaChannel < 0) {
+        mDmaChannel = dma_claim_unused_channel(false);
+        if(mDmaChannel >= 0) {
+            // Each halfword lands in the data/command register, so every byte
+            // carries its own stop flag
+            dma_channel_config config = dma_channel_get_default_config(mDmaChannel);
+            channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+            channel_config_set_read_increment(&config, true);
+            channel_config_set_write_increment(&config, false);
+            channel_config_set_dreq(&config, i2c_get_dreq(mBus, true));
+            dma_channel_configure(mDmaChannel, &config, &i2c_get_hw(mBus)->data_cmd, mDmaBuffer, 0, false);
+
+            uint32_t index = i2c_hw_index(mBus);
+            ssd1306_transfer_owner[index] = this;
+            i2c_get_hw(mBus)->intr_mask = 0;
+            irq_set_exclusive_handler(I2C0_IRQ + index, (index == 0) ? i2c0_irq : i2c1_irq);
+            irq_set_enabled(I2C0_IRQ + index, true);
+        }
+    }
+    return mDmaChannel >= 0;
 }
 
-void ssd1306_reset_device(ssd1306_spi_device *device)
+bool SSD1306I2CTransport::async_ready()
 {
-    gpio_set_dir(device->reset, GPIO_OUT);
-    gpio_put(device->reset, 1);
-    sleep_ms(1);
-    gpio_put(device->reset, 0);
-    sleep_ms(10);
-    gpio_put(device->reset, 1);
+    return mDmaChannel >= 0;
 }
 
-void ssd1306_initialize_device(ssd1306_spi_device *dev)
+/**
+ * @brief Starts sending data to display RAM and returns as soon as it is on
+ * its way. The data is copied before the call returns, so the caller may
+ * reuse the buffer right away. Falls back to a blocking write if DMA is not
+ * set up.
+ *
+ * @param data Bytes to write to display RAM
+ * @param length Length of the data, at most a full frame
+ * @param callback Called from the I2C interrupt once the transfer is done
+ * @param context Handed to the callback
+ */
+void SSD1306I2CTransport::write_data_async(const uint8_t *data, uint32_t length, TransferCallback callback,
+                                           void *context)
 {
-    // some of these commands are not strictly necessary as the reset
-    // process defaults to some of these but they are shown here
-    // to demonstrate what the initialization sequence looks like
-
-    // some configuration values are recommended by the board manufacturer
-
-    ssd1306_reset_device(dev);
-
-    ssd1306_set_display_enable(dev, false);
-
-    /* timing and driving scheme */
-    uint8_t init2[] = {OLED_SET_DISP_CLK_DIV, 0x80}; // Set display clock divide ratio, div ratio of 1, standard freq
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init2, sizeof(init2)); // div ratio of 1, standard freq
-
-    uint8_t init3[] = {OLED_SET_MUX_RATIO, (OLED_HEIGHT - 1)}; // Set multiplex ratio, display is only 32 pixels high
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init3, sizeof(init3)); // our display is only 32 pixels high
-
-    // Set display offset, no offset
-    uint8_t init4[] = {OLED_SET_DISP_OFFSET, 0x00};
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init4, sizeof(init4));
-
-    /* resolution and layout */
-    // Set display start line to 0
-    uint8_t init5[] = {OLED_SET_DISP_START_LINE};
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init5, sizeof(init5)); // set display start line to 0
-
-    // Set charge pump, vcc internally generated
-    uint8_t init6[] = {OLED_SET_CHARGE_PUMP, 0x14};
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init6, sizeof(init6));
-
-    /* memory mapping */
-    // Set memory address mode, horizontal addressing
-    uint8_t init7[] = {OLED_SET_MEM_ADDR, 0x00};
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init7, sizeof(init7));
-
-    uint8_t init8[] = {(OLED_SET_SEG_REMAP | 0x1)};
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init8, sizeof(init8)); // set segment re-map
-    // column address 127 is mapped to SEG0
-
-    uint8_t init9[] = {(OLED_SET_COM_OUT_DIR | 0x8)};
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init9, sizeof(init9)); // set COM (common) output scan direction
-    // scan from bottom up, COM[N-1] to COM0
-
-    uint8_t init10[] = {OLED_SET_COM_PIN_CFG, 0x12}; // Set COM (common) pins hardware config, manufacturer magic number
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init10, sizeof(init10));
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, OLED_SET_COM_PIN_CFG, 1); // set COM (common) pins hardware configuration
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, 0x12, 1); // manufacturer magic number
+    if(!async_ready() || (length >= (sizeof(mDmaBuffer) / sizeof(mDmaBuffer[0])))) {
+        SSD1306Transport::write_data_async(data, length, callback, context);
+        return;
+    }
 
-    /* display */
-    // Set contrast control
-    ssd1306_set_contrast(dev, 0x01);
+    // Time spent waiting on the previous frame counts against this one
+    uint64_t start = time_us_64();
+    wait();
 
-    uint8_t init12[] = {OLED_SET_PRECHARGE, 0xF1};
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init12, sizeof(init12));
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, OLED_SET_PRECHARGE, 1); // set pre-charge period
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, 0xF1, 1); // Vcc internally generated on our board
+    // Co = 0, D/C = 1 => the driver expects data to be written to RAM
+    mDmaBuffer[0] = 0x40;
+    for(uint32_t i = 0; i < length; i++) {
+        mDmaBuffer[i + 1] = data[i];
+    }
+    mDmaBuffer[length] |= I2C_IC_DATA_CMD_STOP_BITS;
 
-    uint8_t init13[] = {OLED_SET_VCOM_DESEL, 0x40};
-    ssd1306_write(dev, ssd1306_write_type::COMMAND, init13, sizeof(init13));
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, OLED_SET_VCOM_DESEL, 1); // set VCOMH deselect level
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, 0x40, 1); // 0.83xVcc
+    transfer_start(length + 1, callback, context);
+    mCpuUs = (uint32_t)(time_us_64() - start);
+}
 
-    // set entire display on to follow RAM content
-    ssd1306_set_ignore_ram(dev, false);
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, OLED_SET_ENTIRE_ON, 1); // set entire display on to follow RAM content
+void SSD1306I2CTransport::transfer_start(uint32_t count, TransferCallback callback, void *context)
+{
+    i2c_hw_t *hw = i2c_get_hw(mBus);
 
-    // Set normal (not inverted) display
-    ssd1306_set_invert_display(dev, false);
-    // uint8_t init15[] = {OLED_SET_NORM_INV};
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, init15, sizeof(init15));
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, OLED_SET_NORM_INV, 1); // set normal (not inverted) display
+    // The target address can only be changed with the controller disabled
+    hw->enable = 0;
+    hw->tar = (mAddress & OLED_WRITE_MODE);
+    hw->enable = 1;
 
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, OLED_SET_SCROLL | 0x00, 1); // deactivate horizontal scrolling if set
-    // this is necessary as memory writes will corrupt if scrolling was enabled
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, 0x00, 1);
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, 0x10, 1);
-    // ssd1306_write(dev, ssd1306_write_type::COMMAND, 0x40, 1);
+    mTransferCallback = callback;
+    mTransferContext = context;
+    mTransferBusy = true;
+    mTransferStart = time_us_64();
+    mBytesWritten += count + 1;
 
-    ssd1306_set_display_enable(dev, true);
+    // The transfer is over once the stop condition is on the bus, or early if
+    // the display does not acknowledge
+    (void)hw->clr_intr;
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    dma_channel_transfer_from_buffer_now(mDmaChannel, mDmaBuffer, count);
 }
 
-void ssd1306_set_display_enable(ssd1306_spi_device *device, bool enable)
+void SSD1306I2CTransport::transfer_irq()
 {
-    uint8_t command = OLED_SET_DISP;
-    if(enable) {
-        // Enable display 0xAF
-        command |= 0x01;
+    i2c_hw_t *hw = i2c_get_hw(mBus);
+    if(hw->intr_stat & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        // The controller flushes its FIFO on an abort, stop feeding it
+        dma_channel_abort(mDmaChannel);
+        mTransferAborts++;
+    }
+    (void)hw->clr_intr;
+    hw->intr_mask = 0;
+
+    mTransferUs = (uint32_t)(time_us_64() - mTransferStart);
+    mTransferBusy = false;
+    if(mTransferCallback) {
+        mTransferCallback(mTransferContext);
     }
-    ssd1306_write(device, ssd1306_write_type::COMMAND, &command, 1);
 }
 
-void ssd1306_set_contrast(ssd1306_spi_device *device, uint8_t contrast)
+void SSD1306I2CTransport::i2c0_irq()
 {
-    // Contrast is a 2 byte command
-    uint8_t command[2] = {OLED_SET_CONTRAST, contrast};
-    ssd1306_write(device, ssd1306_write_type::COMMAND, command, sizeof(command));
+    if(ssd1306_transfer_owner[0]) {
+        ssd1306_transfer_owner[0]->transfer_irq();
+    }
 }
 
-void ssd1306_set_ignore_ram(ssd1306_spi_device *device, bool enable)
+void SSD1306I2CTransport::i2c1_irq()
 {
-    uint8_t command = OLED_SET_ENTIRE_ON;
-    if(enable) {
-        // Ignore RAM, all pixels on 0xA5
-        command |= 0x01;
+    if(ssd1306_transfer_owner[1]) {
+        ssd1306_transfer_owner[1]->transfer_irq();
     }
-    ssd1306_write(device, ssd1306_write_type::COMMAND, &command, 1);
 }
 
-void ssd1306_set_invert_display(ssd1306_spi_device *device, bool invert)
+/**
+ * @brief Blocks until the last asynchronous transfer is off the bus. Time
+ * spent waiting is added to the CPU time of the transfer.
+ */
+void SSD1306I2CTransport::wait()
 {
-    uint8_t command = OLED_SET_NORM_INV;
-    if(invert) {
-        // Invert the display (0 = ON, 1 = OFF), all pixels on 0xA5
-        command |= 0x01;
+    if(mTransferBusy) {
+        uint64_t start = time_us_64();
+        while(mTransferBusy) {
+            tight_loop_contents();
+        }
+        mCpuUs += (uint32_t)(time_us_64() - start);
     }
-    ssd1306_write(device, ssd1306_write_type::COMMAND, &command, 1);
 }
 
-void ssd1306_set_cursor(ssd1306_spi_device *device, uint8_t start_col, uint8_t end_col, uint8_t start_page, uint8_t end_page)
+bool SSD1306I2CTransport::busy()
 {
-    // Indicates start column and end column
-    uint8_t init_col[] = {OLED_SET_COL_ADDR, start_col, end_col};
-    ssd1306_write(device, ssd1306_write_type::COMMAND, init_col, sizeof(init_col));
-
-    // Indicates start page and end page
-    uint8_t init_page[] = {OLED_SET_PAGE_ADDR, start_page, end_page};
-    ssd1306_write(device, ssd1306_write_type::COMMAND, init_page, sizeof(init_page));
+    return mTransferBusy;
 }
 
-void ssd1306_reset_cursor(ssd1306_spi_device *device)
+uint32_t SSD1306I2CTransport::set_clock(uint32_t hz)
 {
-    ssd1306_set_cursor(device, 0, (OLED_WIDTH - 1), 0, (OLED_NUM_PAGES - 1));
-    // // Indicates start column and end column
-    // uint8_t init_col[] = {OLED_SET_COL_ADDR, 0x00, 0x7F};
-    // ssd1306_write(device, ssd1306_write_type::COMMAND, init_col, sizeof(init_col));
-
-    // // Indicates start page and end page
-    // uint8_t init_page[] = {OLED_SET_PAGE_ADDR, 0x00, 0x07};
-    // ssd1306_write(device, ssd1306_write_type::COMMAND, init_page, sizeof(init_page));
+    wait();
+    return i2c_set_baudrate(mBus, hz);
 }
 
-void ssd1306_fill_screen(ssd1306_spi_device *device, uint8_t byte)
+uint32_t SSD1306I2CTransport::transfer_us()
 {
-    uint8_t buffer[OLED_NUM_PAGES][128];
+    return mTransferUs;
 }
 
-void ssd1306_set_addressing(ssd1306_spi_device *device, uint8_t mode)
+uint32_t SSD1306I2CTransport::cpu_us()
 {
-    uint8_t init_addressing[2] = {OLED_SET_MEM_ADDR, mode};
-    ssd1306_write(device, ssd1306_write_type::COMMAND, init_addressing, sizeof(init_addressing));
+    return mCpuUs;
 }
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-void SSD1306::fill(uint8_t *buf, uint8_t fill) {
-    // fill entire buffer with the same byte
-    for (int i = 0; i < OLED_BUF_LEN; i++) {
-        buf[i] = fill;
-    }
+/**
+ * @brief Retrieves the number of asynchronous transfers the display did not
+ * acknowledge
+ */
+uint32_t SSD1306I2CTransport::transfer_aborts()
+{
+    return mTransferAborts;
 }
 
-void SSD1306::calc_render_area_buflen(struct RenderArea *area) 
+/**
+ * @brief Retrieves the bytes each transaction adds, the address and the
+ * control byte
+ */
+uint32_t SSD1306I2CTransport::framing_bytes()
 {
-    // calculate how long the flattened buffer will be for a render area
-    area->buflen = (area->end_col - area->start_col + 1) * (area->end_page - area->start_page + 1);
+    return 2;
 }
 
 /**
- * @brief Construct a new SSD1306 object
+ * @brief Construct a new SSD1306 SPI transport. The pins are set up as
+ * outputs by the caller.
  */
-SSD1306::SSD1306(i2c_inst_t *bus, uint8_t address) :
-    mMutex(nullptr),
+SSD1306SpiTransport::SSD1306SpiTransport(spi_inst_t *bus, uint32_t cs, uint32_t dc, uint32_t reset) :
     mBus(bus),
-    mAddress(address)
+    mPinChipSelect(cs),
+    mPinDataCommand(dc),
+    mPinReset(reset),
+    mDmaChannel(-1),
+    mTransferBusy(false),
+    mTransferStart(0),
+    mTransferUs(0),
+    mTransferCallback(nullptr),
+    mTransferContext(nullptr)
 {
-    mutex_init(mMutex);
 }
 
-void SSD1306::write(uint8_t data)
+/**
+ * @brief Pulses the reset pin, which puts every register of the display back
+ * to its power-on value. The display has to be initialized again afterwards.
+ */
+void SSD1306SpiTransport::reset()
 {
-    uint8_t buf[2] = {0x80, data};
-    i2c_write_blocking(mBus, (mAddress & OLED_WRITE_MODE), buf, 2, false);
+    wait();
+    gpio_put(mPinReset, 1);
+    sleep_ms(1);
+    gpio_put(mPinReset, 0);
+    sleep_ms(10);
+    gpio_put(mPinReset, 1);
 }
 
-void SSD1306::write_buffer(const uint8_t buffer[], int bufferLen)
+/**
+ * @brief Shifts out a buffer in a single chip select window, the DC pin
+ * telling commands from data
+ */
+void SSD1306SpiTransport::write(bool data, const uint8_t *buffer, uint32_t length)
 {
-    // in horizontal addressing mode, the column address pointer auto-increments
-    // and then wraps around to the next page, so we can send the entire frame
-    // buffer in one gooooooo!
-
-    // copy our frame buffer into a new buffer because we need to add the control byte
-    // to the beginning
-
-    // TODO find a more memory-efficient way to do this..
-    // maybe break the data transfer into pages?
-    // uint8_t *temp_buf = (uint8_t*)malloc(bufferLen + 1);
-
-    // for (int i = 1; i < bufferLen + 1; i++) {
-    //     temp_buf[i] = buffer[i - 1];
-    // }
-    // // Co = 0, D/C = 1 => the driver expects data to be written to RAM
-    // temp_buf[0] = 0x40;
-    uint8_t control_byte = 0x40;
-    i2c_write_blocking(mBus, (mAddress & OLED_WRITE_MODE), &control_byte, 1, false);
-    i2c_write_raw_blocking(mBus, buffer, bufferLen);
-
-    // free(temp_buf);
+    wait();
+    gpio_put(mPinChipSelect, 0);
+    gpio_put(mPinDataCommand, data ? 1 : 0);
+    spi_write_blocking(mBus, buffer, length);
+    gpio_put(mPinChipSelect, 1);
+    mBytesWritten += length;
 }
 
-void SSD1306::write_buffer(DisplayRamWrite &ram)
+void SSD1306SpiTransport::write_commands(const uint8_t *commands, uint32_t length)
 {
-    uint8_t *temp_buf = (uint8_t*)(&ram);
-    // for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
-    //     for(uint32_t column = 0; OLED_WIDTH; column++) {
-    //         uint8_t i = (page * OLED_WIDTH) + column;
-    //         temp_buf[i] = ram[page][column];
-    //     }
-    // }
-    temp_buf[0] = 0x40;
-    i2c_write_blocking(mBus, (mAddress & OLED_WRITE_MODE), temp_buf, sizeof(DisplayRamWrite), false);
-
-    // free(temp_buf);
+    write(false, commands, length);
 }
 
-void SSD1306::initialize()
+void SSD1306SpiTransport::write_data(const uint8_t *data, uint32_t length)
 {
-    // some of these commands are not strictly necessary as the reset
-    // process defaults to some of these but they are shown here
-    // to demonstrate what the initialization sequence looks like
-
-    // some configuration values are recommended by the board manufacturer
-
-    write(OLED_SET_DISP | 0x00); // set display off
-
-    /* timing and driving scheme */
-    write(OLED_SET_DISP_CLK_DIV); // set display clock divide ratio
-    write(0x80); // div ratio of 1, standard freq
-
-    write(OLED_SET_MUX_RATIO); // set multiplex ratio
-    write(OLED_HEIGHT - 1); // our display is only 32 pixels high
-
-    write(OLED_SET_DISP_OFFSET); // set display offset
-    write(0x00); // no offset
-
-    /* resolution and layout */
-    write(OLED_SET_DISP_START_LINE); // set display start line to 0
-
-    write(OLED_SET_CHARGE_PUMP); // set charge pump
-    write(0x14); // Vcc internally generated on our board
-
-    /* memory mapping 
-    */
-    write(OLED_SET_MEM_ADDR); // set memory address mode
-    write(0x00); // horizontal addressing mode
-
-    write(OLED_SET_SEG_REMAP | 0x01); // set segment re-map
-    // column address 127 is mapped to SEG0
-
-    write(OLED_SET_COM_OUT_DIR | 0x08); // set COM (common) output scan direction
-    // scan from bottom up, COM[N-1] to COM0
+    write(true, data, length);
+}
 
-    write(OLED_SET_COM_PIN_CFG); // set COM (common) pins hardware configuration
-    write(0x12); // manufacturer magic number
+/**
+ * @brief Sets up DMA for asynchronous transfers. Claims a DMA channel and
+ * shares DMA_IRQ_0 with any other user.
+ * @return True if asynchronous transfers are available
+ */
+bool SSD1306SpiTransport::dma_init()
+{
+    if(mDmaChannel < 0) {
+        mDmaChannel = dma_claim_unused_channel(false);
+        if(mDmaChannel >= 0) {
+            dma_channel_config config = dma_channel_get_default_config(mDmaChannel);
+            channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+            channel_config_set_read_increment(&config, true);
+            channel_config_set_write_increment(&config, false);
+            channel_config_set_dreq(&config, spi_get_dreq(mBus, true));
+            dma_channel_configure(mDmaChannel, &config, &spi_get_hw(mBus)->dr, NULL, 0, false);
+
+            if((ssd1306_spi_transfer_owner[0] == nullptr) && (ssd1306_spi_transfer_owner[1] == nullptr)) {
+                irq_add_shared_handler(DMA_IRQ_0, dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+                irq_set_enabled(DMA_IRQ_0, true);
+            }
+            ssd1306_spi_transfer_owner[spi_get_index(mBus)] = this;
+            dma_channel_set_irq0_enabled(mDmaChannel, true);
+        }
+    }
+    return mDmaChannel >= 0;
+}
 
-    /* display */
-    write(OLED_SET_CONTRAST); // set contrast control
-    write(0xCF);
+bool SSD1306SpiTransport::async_ready()
+{
+    return mDmaChannel >= 0;
+}
 
-    write(OLED_SET_PRECHARGE); // set pre-charge period
-    write(0xF1); // Vcc internally generated on our board
+/**
+ * @brief Starts sending data to display RAM. Unlike the I2C transport the data
+ * is not copied, the buffer must stay untouched until the transfer is done.
+ * Falls back to a blocking write if DMA is not set up.
+ *
+ * @param data Bytes to write to display RAM
+ * @param length Length of the data
+ * @param callback Called from the DMA interrupt once the transfer is done
+ * @param context Handed to the callback
+ */
+void SSD1306SpiTransport::write_data_async(const uint8_t *data, uint32_t length, TransferCallback callback,
+                                           void *context)
+{
+    if(!async_ready()) {
+        SSD1306Transport::write_data_async(data, length, callback, context);
+        return;
+    }
 
-    write(OLED_SET_VCOM_DESEL); // set VCOMH deselect level
-    write(0x40); // 0.83xVcc
+    wait();
 
-    write(OLED_SET_ENTIRE_ON); // set entire display on to follow RAM content
+    mTransferCallback = callback;
+    mTransferContext = context;
+    mTransferBusy = true;
+    mTransferStart = time_us_64();
+    mBytesWritten += length;
 
-    write(OLED_SET_NORM_INV); // set normal (not inverted) display
+    gpio_put(mPinChipSelect, 0);
+    gpio_put(mPinDataCommand, 1);
+    dma_channel_transfer_from_buffer_now(mDmaChannel, data, length);
+}
 
-    // write(OLED_SET_SCROLL | 0x00); // deactivate horizontal scrolling if set
-    // this is necessary as memory writes will corrupt if scrolling was enabled
-    write(0x00);
-    write(0x10);
-    write(0x40);
+void SSD1306SpiTransport::transfer_irq()
+{
+    // DMA is done once the FIFO has taken the last byte, chip select has to
+    // hold until it has been shifted out
+    while(spi_is_busy(mBus)) {
+        tight_loop_contents();
+    }
+    gpio_put(mPinChipSelect, 1);
 
-    write(OLED_SET_DISP | 0x01); // turn display on
+    mTransferUs = (uint32_t)(time_us_64() - mTransferStart);
+    mTransferBusy = false;
+    if(mTransferCallback) {
+        mTransferCallback(mTransferContext);
+    }
 }
 
-void SSD1306::ignore_ram(bool enable)
+void SSD1306SpiTransport::dma_irq()
 {
-    if(enable) {
-        // Ignore RAM, all pixels on
-        write(0xA5);
-    } else {
-        // Follow RAM
-        write(0x7F);
+    for(uint32_t i = 0; i < 2; i++) {
+        SSD1306SpiTransport *transport = ssd1306_spi_transfer_owner[i];
+        if(transport && dma_channel_get_irq0_status(transport->mDmaChannel)) {
+            dma_channel_acknowledge_irq0(transport->mDmaChannel);
+            transport->transfer_irq();
+        }
     }
 }
 
-void SSD1306::render(uint8_t *buffer, RenderArea *area)
+void SSD1306SpiTransport::wait()
 {
-    // update a portion of the display with a render area
-    write(OLED_SET_COL_ADDR);
-    write(area->start_col);
-    write(area->end_col);
-
-    write(OLED_SET_PAGE_ADDR);
-    write(area->start_page);
-    write(area->end_page);
-
-    write_buffer(buffer, area->buflen);
+    while(mTransferBusy) {
+        tight_loop_contents();
+    }
 }
 
-void SSD1306::fill_screen(uint8_t buffer)
+bool SSD1306SpiTransport::busy()
 {
-    // initialize render area for entire frame (128 pixels by 4 pages)
-    struct SSD1306::RenderArea frame_area = {start_col: 0, end_col : OLED_WIDTH - 1, start_page : 0, end_page : OLED_NUM_PAGES -
-                                                                                                        1};
-    SSD1306::calc_render_area_buflen(&frame_area);
-    uint8_t buf[OLED_BUF_LEN];
-    fill(buf, buffer);
-    render(buf, &frame_area);
+    return mTransferBusy;
 }
 
-void SSD1306::fill_display(DisplayRam &ram, uint8_t byte)
+uint32_t SSD1306SpiTransport::set_clock(uint32_t hz)
 {
-    for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
-        for(uint32_t column = 0; column < OLED_WIDTH; column++) {
-            ram[page][column] = byte;
-        }
-    }
+    wait();
+    return spi_set_baudrate(mBus, hz);
 }
 
-void SSD1306::fill_display_random(DisplayRam &ram)
+uint32_t SSD1306SpiTransport::transfer_us()
 {
-    for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
-        for(uint32_t column = 0; column < OLED_WIDTH; column++) {
-            ram[page][column] = rand() % 255;
-        }
-    }
+    return mTransferUs;
 }
 
-void SSD1306::set_contrast(uint8_t contrast)
+/**
+ * @brief Construct a new SSD1306 lock for both cores
+ */
+SSD1306Mutex::SSD1306Mutex()
 {
-    write(OLED_SET_CONTRAST); // set contrast control
-    write(contrast);
+    recursive_mutex_init(&mMutex);
+    memset(&mStats, 0, sizeof(SSD1306LockStats));
 }
 
-void SSD1306::set_addressing_mode(AddressingMode mode)
-{
-    write(OLED_SET_MEM_ADDR);
-    switch(mode) {
-    case AddressingMode::HORIZONTAL :
-        write(0x00); // horizontal addressing mode
-        break;
-    case AddressingMode::VERTICAL :
-        write(0x01); // horizontal addressing mode
-        break;
-    default:
-        break;
+/**
+ * @brief Takes the lock. Waiting for the other core is counted in the stats.
+ */
+void SSD1306Mutex::lock()
+{
+    uint32_t owner;
+    if(!recursive_mutex_try_enter(&mMutex, &owner)) {
+        uint64_t start = time_us_64();
+        recursive_mutex_enter_blocking(&mMutex);
+        uint32_t waited = (uint32_t)(time_us_64() - start);
+        mStats.contentions++;
+        mStats.wait_us += waited;
+        if(waited > mStats.wait_max_us) {
+            mStats.wait_max_us = waited;
+        }
     }
+    mStats.acquisitions++;
 }
 
-void SSD1306::reset_cursor()
+void SSD1306Mutex::unlock()
 {
-    static const uint8_t config22[] = {0x21, 0x00, 0x7F};             // Display ON
-    static const uint8_t config23[] = {0x22, 0x00, 0x07};             // Display ON
+    recursive_mutex_exit(&mMutex);
+}
 
-    write_buffer(config22, 3);
-    write_buffer(config23, 3);
+void SSD1306Mutex::get_stats(SSD1306LockStats *stats)
+{
+    *stats = mStats;
 }
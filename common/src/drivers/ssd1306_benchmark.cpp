@@ -0,0 +1,152 @@
+#include "hardware/timer.h"
+
+#include "common/drivers/ssd1306_benchmark.h"
+
+// Page sent by the partial frame measurements
+#define SSD1306_BENCHMARK_PAGE  3
+
+static const char *ssd1306_benchmark_names[SSD1306_BENCHMARK_STRATEGIES] = {
+    "raw",
+    "blocking",
+    "batched",
+    "dma"
+};
+
+// Test pattern, with the spare byte the batched strategy frames it behind
+static SSD1306::DisplayRamWrite ssd1306_benchmark_frame;
+
+/**
+ * @brief Sets the window one command byte per transaction, the way the driver
+ * did before commands were batched
+ */
+static void ssd1306_benchmark_window_raw(SSD1306 *display, uint8_t start_page, uint8_t end_page)
+{
+    const uint8_t window[] = {
+        OLED_SET_COL_ADDR, 0x00, OLED_WIDTH - 1,
+        OLED_SET_PAGE_ADDR, start_page, end_page
+    };
+    for(uint32_t i = 0; i < sizeof(window); i++) {
+        SSD1306::CommandStream commands;
+        commands.add(window[i]);
+        display->write_commands(commands);
+    }
+}
+
+static void ssd1306_benchmark_send(SSD1306 *display, ssd1306_benchmark_strategy strategy, bool full)
+{
+    uint8_t start_page = full ? 0 : SSD1306_BENCHMARK_PAGE;
+    uint8_t end_page = full ? (OLED_PAGE_HEIGHT - 1) : SSD1306_BENCHMARK_PAGE;
+    const uint8_t *data = &ssd1306_benchmark_frame.ram[start_page][0];
+    uint32_t length = (end_page - start_page + 1) * OLED_WIDTH;
+
+    switch(strategy) {
+    case SSD1306_BENCHMARK_RAW:
+        ssd1306_benchmark_window_raw(display, start_page, end_page);
+        display->write_buffer(data, length);
+        break;
+    case SSD1306_BENCHMARK_BLOCKING:
+        display->set_window(0, OLED_WIDTH - 1, start_page, end_page);
+        display->write_buffer(data, length);
+        break;
+    case SSD1306_BENCHMARK_BATCHED:
+        display->set_window(0, OLED_WIDTH - 1, start_page, end_page);
+        if(full) {
+            display->write_buffer(ssd1306_benchmark_frame);
+        } else {
+            // A single page already goes out in one transaction
+            display->write_buffer(data, length);
+        }
+        break;
+    case SSD1306_BENCHMARK_DMA:
+        display->set_window(0, OLED_WIDTH - 1, start_page, end_page);
+        display->write_buffer_async(data, length);
+        display->wait_transfer();
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Times a transfer over a number of repeats
+ *
+ * @param bytes Returns the bytes one transfer puts on the bus
+ * @return Average time of one transfer
+ */
+static uint32_t ssd1306_benchmark_time(SSD1306 *display, ssd1306_benchmark_strategy strategy, bool full,
+                                       uint32_t repeats, uint32_t *bytes)
+{
+    uint32_t start_bytes = display->bytes_written();
+    uint64_t start = time_us_64();
+    for(uint32_t i = 0; i < repeats; i++) {
+        ssd1306_benchmark_send(display, strategy, full);
+    }
+    uint64_t elapsed = time_us_64() - start;
+    *bytes = (display->bytes_written() - start_bytes) / repeats;
+    return (uint32_t)(elapsed / repeats);
+}
+
+uint32_t ssd1306_benchmark_run(SSD1306 *display, const uint32_t *clocks, uint32_t clock_count, uint32_t restore_hz,
+                               uint32_t repeats, ssd1306_benchmark_result *results, uint32_t max_results)
+{
+    if(repeats == 0) {
+        return 0;
+    }
+
+    // Diagonal stripes, so a torn or shifted frame shows on the panel
+    for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
+        for(uint32_t column = 0; column < OLED_WIDTH; column++) {
+            ssd1306_benchmark_frame.ram[page][column] = (uint8_t)(0x11 << ((column + page) % 4));
+        }
+    }
+
+    SSD1306Transport *transport = display->transport();
+    uint32_t count = 0;
+
+    // The other core waits for the whole sweep rather than disturb it
+    display->lock();
+    for(uint32_t clock = 0; clock < clock_count; clock++) {
+        uint32_t actual = transport->set_clock(clocks[clock]);
+        for(uint32_t strategy = 0; strategy < SSD1306_BENCHMARK_STRATEGIES; strategy++) {
+            if((strategy == SSD1306_BENCHMARK_DMA) && !display->dma_ready()) {
+                continue;
+            }
+            if(count >= max_results) {
+                break;
+            }
+
+            ssd1306_benchmark_result *result = &results[count++];
+            result->clock_hz = clocks[clock];
+            result->actual_hz = actual;
+            result->strategy = (ssd1306_benchmark_strategy)strategy;
+
+            uint32_t aborts = display->transfer_aborts();
+            result->full_us = ssd1306_benchmark_time(display, result->strategy, true, repeats,
+                                                     &result->full_bytes);
+            result->partial_us = ssd1306_benchmark_time(display, result->strategy, false, repeats,
+                                                        &result->partial_bytes);
+            result->errors = display->transfer_aborts() - aborts;
+        }
+    }
+    if(restore_hz > 0) {
+        transport->set_clock(restore_hz);
+    }
+    // Partial measurements leave a single page open
+    display->reset_cursor();
+    display->unlock();
+
+    return count;
+}
+
+void ssd1306_benchmark_print(const ssd1306_benchmark_result *results, uint32_t count)
+{
+    printf("%10s %10s %-9s %8s %6s %8s %7s %7s %6s\n", "clock_hz", "actual_hz", "strategy", "full_us", "fps",
+           "page_us", "full_b", "page_b", "errors");
+    for(uint32_t i = 0; i < count; i++) {
+        const ssd1306_benchmark_result *result = &results[i];
+        uint32_t fps = (result->full_us > 0) ? (1000000 / result->full_us) : 0;
+        printf("%10u %10u %-9s %8u %6u %8u %7u %7u %6u\n", result->clock_hz, result->actual_hz,
+               ssd1306_benchmark_names[result->strategy], result->full_us, fps, result->partial_us,
+               result->full_bytes, result->partial_bytes, result->errors);
+    }
+}
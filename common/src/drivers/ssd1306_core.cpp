@@ -0,0 +1,724 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/logger.h"
+#include "common/drivers/ssd1306_core.h"
+
+void SSD1306::fill(uint8_t *buf, uint8_t fill) {
+    // fill entire buffer with the same byte
+    for (int i = 0; i < OLED_BUF_LEN; i++) {
+        buf[i] = fill;
+    }
+}
+
+void SSD1306::calc_render_area_buflen(struct RenderArea *area) 
+{
+    // calculate how long the flattened buffer will be for a render area
+    area->buflen = (area->end_col - area->start_col + 1) * (area->end_page - area->start_page + 1);
+}
+
+SSD1306::CommandStream::CommandStream() :
+    mLength(0),
+    mOverflow(false)
+{
+}
+
+/**
+ * @brief Appends a command. A command that no longer fits is dropped whole
+ * and flags the stream as overflowed, never half of a command is sent.
+ */
+SSD1306::CommandStream &SSD1306::CommandStream::add(uint8_t command)
+{
+    if(mLength < sizeof(mBuffer)) {
+        mBuffer[mLength++] = command;
+    } else {
+        mOverflow = true;
+    }
+    return *this;
+}
+
+SSD1306::CommandStream &SSD1306::CommandStream::add(uint8_t command, uint8_t arg)
+{
+    if((mLength + 2) <= sizeof(mBuffer)) {
+        mBuffer[mLength++] = command;
+        mBuffer[mLength++] = arg;
+    } else {
+        mOverflow = true;
+    }
+    return *this;
+}
+
+SSD1306::CommandStream &SSD1306::CommandStream::add(uint8_t command, uint8_t arg0, uint8_t arg1)
+{
+    if((mLength + 3) <= sizeof(mBuffer)) {
+        mBuffer[mLength++] = command;
+        mBuffer[mLength++] = arg0;
+        mBuffer[mLength++] = arg1;
+    } else {
+        mOverflow = true;
+    }
+    return *this;
+}
+
+void SSD1306::CommandStream::clear()
+{
+    mLength = 0;
+    mOverflow = false;
+}
+
+const uint8_t *SSD1306::CommandStream::data() const
+{
+    return mBuffer;
+}
+
+uint32_t SSD1306::CommandStream::length() const
+{
+    return mLength;
+}
+
+bool SSD1306::CommandStream::overflow() const
+{
+    return mOverflow;
+}
+
+/**
+ * @brief Warns about commands that did not fit in the stream. The ones that
+ * did still go out, they are whole commands.
+ */
+void SSD1306::CommandStream::warn_overflow() const
+{
+    if(mOverflow) {
+        LOG_WARN("Command stream overflowed, only %u bytes sent\n", mLength);
+    }
+}
+
+/**
+ * @brief Construct a new SSD1306 object
+ *
+ * @param transport Bus the display sits on
+ * @param lock Lock shared with the other users of the display, nullptr if the
+ * display has only the one user
+ */
+SSD1306::SSD1306(SSD1306Transport *transport, SSD1306Lock *lock) :
+    mLock(lock),
+    mTransport(transport),
+    mStartLine(0),
+    mScrolling(false),
+    mWindowed(true)
+{
+}
+
+/**
+ * @brief Takes the display for a run of transactions that must not be split
+ * up by another user, such as a window followed by its data. Calls nest.
+ */
+void SSD1306::lock()
+{
+    if(mLock) {
+        mLock->lock();
+    }
+}
+
+void SSD1306::unlock()
+{
+    if(mLock) {
+        mLock->unlock();
+    }
+}
+
+void SSD1306::get_lock_stats(LockStats *stats)
+{
+    if(mLock) {
+        mLock->get_stats(stats);
+    } else {
+        memset(stats, 0, sizeof(LockStats));
+    }
+}
+
+void SSD1306::write_buffer(const uint8_t buffer[], int bufferLen)
+{
+    lock();
+    stop_scroll_for_write();
+    mTransport->write_data(buffer, bufferLen);
+    unlock();
+}
+
+void SSD1306::write_buffer(DisplayRamWrite &ram)
+{
+    lock();
+    stop_scroll_for_write();
+    mTransport->write_data_framed((uint8_t*)(&ram), sizeof(DisplayRam));
+    unlock();
+}
+
+/**
+ * @brief Sends a run of commands in a single transaction
+ */
+void SSD1306::write_commands(const CommandStream &commands)
+{
+    commands.warn_overflow();
+    lock();
+    mTransport->write_commands(commands.data(), commands.length());
+    unlock();
+}
+
+SSD1306Transport *SSD1306::transport()
+{
+    return mTransport;
+}
+
+/**
+ * @brief Retrieves the number of bytes put on the bus so far, framing
+ * included. Callers take the difference of two readings to measure a transfer.
+ */
+uint32_t SSD1306::bytes_written()
+{
+    return mTransport->bytes_written();
+}
+
+bool SSD1306::dma_ready()
+{
+    return mTransport->async_ready();
+}
+
+/**
+ * @brief Starts sending a buffer to display RAM and returns as soon as it is
+ * on its way, if the transport can send asynchronously. Blocks otherwise.
+ *
+ * @param buffer Bytes to write to display RAM
+ * @param bufferLen Length of the buffer, at most a full frame
+ * @param callback Called once the transfer is done, possibly from an interrupt
+ * @param context Handed to the callback
+ */
+void SSD1306::write_buffer_async(const uint8_t buffer[], int bufferLen, TransferCallback callback,
+                                 void *context)
+{
+    lock();
+    stop_scroll_for_write();
+    mTransport->write_data_async(buffer, bufferLen, callback, context);
+    unlock();
+}
+
+void SSD1306::write_buffer_async(DisplayRamWrite &ram, TransferCallback callback, void *context)
+{
+    write_buffer_async(&ram.ram[0][0], sizeof(DisplayRam), callback, context);
+}
+
+/**
+ * @brief Updates a portion of the display like render, but hands the data to
+ * the transport asynchronously. The window is still set up with a blocking
+ * write, which first waits for any transfer in flight.
+ */
+void SSD1306::render_async(const uint8_t *buffer, RenderArea *area, TransferCallback callback, void *context)
+{
+    lock();
+    stop_scroll_for_write();
+    set_window(area->start_col, area->end_col, area->start_page, area->end_page);
+    write_buffer_async(buffer, area->buflen, callback, context);
+    unlock();
+}
+
+void SSD1306::wait_transfer()
+{
+    mTransport->wait();
+}
+
+bool SSD1306::transfer_busy()
+{
+    return mTransport->busy();
+}
+
+uint32_t SSD1306::transfer_us()
+{
+    return mTransport->transfer_us();
+}
+
+uint32_t SSD1306::cpu_us()
+{
+    return mTransport->cpu_us();
+}
+
+uint32_t SSD1306::transfer_aborts()
+{
+    return mTransport->transfer_aborts();
+}
+
+/**
+ * @brief Appends the power up sequence shared by every SSD1306 driver
+ */
+void SSD1306::init_sequence(CommandStream &commands)
+{
+    // some of these commands are not strictly necessary as the reset
+    // process defaults to some of these but they are shown here
+    // to demonstrate what the initialization sequence looks like
+
+    // some configuration values are recommended by the board manufacturer
+
+    commands.add(OLED_SET_DISP | 0x00); // set display off
+
+    /* timing and driving scheme */
+    commands.add(OLED_SET_DISP_CLK_DIV, 0x80); // set display clock divide ratio, div ratio of 1, standard freq
+
+    commands.add(OLED_SET_MUX_RATIO, OLED_HEIGHT - 1); // set multiplex ratio, our display is only 32 pixels high
+
+    commands.add(OLED_SET_DISP_OFFSET, 0x00); // set display offset, no offset
+
+    /* resolution and layout */
+    commands.add(OLED_SET_DISP_START_LINE); // set display start line to 0
+
+    commands.add(OLED_SET_CHARGE_PUMP, 0x14); // set charge pump, Vcc internally generated on our board
+
+    /* memory mapping 
+    */
+    commands.add(OLED_SET_MEM_ADDR, 0x00); // set memory address mode, horizontal addressing mode
+
+    commands.add(OLED_SET_SEG_REMAP | 0x01); // set segment re-map
+    // column address 127 is mapped to SEG0
+
+    commands.add(OLED_SET_COM_OUT_DIR | 0x08); // set COM (common) output scan direction
+    // scan from bottom up, COM[N-1] to COM0
+
+    commands.add(OLED_SET_COM_PIN_CFG, 0x12); // set COM (common) pins hardware configuration, manufacturer magic number
+
+    /* display */
+    commands.add(OLED_SET_CONTRAST, 0xCF); // set contrast control
+
+    commands.add(OLED_SET_PRECHARGE, 0xF1); // set pre-charge period, Vcc internally generated on our board
+
+    commands.add(OLED_SET_VCOM_DESEL, 0x40); // set VCOMH deselect level, 0.83xVcc
+
+    commands.add(OLED_SET_ENTIRE_ON); // set entire display on to follow RAM content
+
+    commands.add(OLED_SET_NORM_INV); // set normal (not inverted) display
+
+    commands.add(OLED_SET_SCROLL | 0x00); // deactivate horizontal scrolling if set
+    // this is necessary as memory writes will corrupt if scrolling was enabled
+    commands.add(0x00);
+    commands.add(0x10);
+    commands.add(0x40);
+
+    commands.add(OLED_SET_DISP | 0x01); // turn display on
+}
+
+void SSD1306::initialize()
+{
+    // The whole sequence goes out in one transaction
+    CommandStream commands;
+    init_sequence(commands);
+    lock();
+    write_commands(commands);
+    mStartLine = 0;
+    mScrolling = false;
+    unlock();
+}
+
+void SSD1306::ignore_ram(bool enable)
+{
+    CommandStream commands;
+    if(enable) {
+        // Ignore RAM, all pixels on
+        commands.add(OLED_SET_ENTIRE_ON | 0x01);
+    } else {
+        // Follow RAM
+        commands.add(OLED_SET_ENTIRE_ON);
+    }
+    write_commands(commands);
+}
+
+void SSD1306::render(uint8_t *buffer, RenderArea *area)
+{
+    // update a portion of the display with a render area
+    lock();
+    stop_scroll_for_write();
+    set_window(area->start_col, area->end_col, area->start_page, area->end_page);
+    write_buffer(buffer, area->buflen);
+    unlock();
+}
+
+void SSD1306::fill_screen(uint8_t buffer)
+{
+    // initialize render area for entire frame (128 pixels by 4 pages)
+    struct SSD1306::RenderArea frame_area = {start_col: 0, end_col : OLED_WIDTH - 1, start_page : 0, end_page : OLED_NUM_PAGES -
+                                                                                                        1};
+    SSD1306::calc_render_area_buflen(&frame_area);
+    uint8_t buf[OLED_BUF_LEN];
+    fill(buf, buffer);
+    render(buf, &frame_area);
+}
+
+void SSD1306::fill_display(DisplayRam &ram, uint8_t byte)
+{
+    for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
+        for(uint32_t column = 0; column < OLED_WIDTH; column++) {
+            ram[page][column] = byte;
+        }
+    }
+}
+
+void SSD1306::fill_display_random(DisplayRam &ram)
+{
+    for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
+        for(uint32_t column = 0; column < OLED_WIDTH; column++) {
+            ram[page][column] = rand() % 255;
+        }
+    }
+}
+
+void SSD1306::set_contrast(uint8_t contrast)
+{
+    CommandStream commands;
+    commands.add(OLED_SET_CONTRAST, contrast); // set contrast control
+    write_commands(commands);
+}
+
+void SSD1306::set_addressing_mode(AddressingMode mode)
+{
+    CommandStream commands;
+    switch(mode) {
+    case AddressingMode::HORIZONTAL :
+        commands.add(OLED_SET_MEM_ADDR, 0x00); // horizontal addressing mode
+        break;
+    case AddressingMode::VERTICAL :
+        commands.add(OLED_SET_MEM_ADDR, 0x01); // vertical addressing mode
+        break;
+    default:
+        break;
+    }
+    write_commands(commands);
+}
+
+void SSD1306::set_display_enable(bool enable)
+{
+    CommandStream commands;
+    commands.add(OLED_SET_DISP | (enable ? 0x01 : 0x00));
+    write_commands(commands);
+}
+
+/**
+ * @brief Inverts the display, lighting the pixels that are 0 in display RAM
+ */
+void SSD1306::set_invert(bool invert)
+{
+    CommandStream commands;
+    commands.add(OLED_SET_NORM_INV | (invert ? 0x01 : 0x00));
+    write_commands(commands);
+}
+
+/**
+ * @brief Starts a continuous horizontal scroll of a band of pages. The
+ * controller moves display RAM by one column every interval and wraps it
+ * around, so content that loops, such as a ticker, keeps moving without a
+ * byte on the bus. Display RAM must not be written while the scroll runs, so
+ * any write through this class stops it first.
+ *
+ * @param direction Direction the content moves in
+ * @param start_page First page of the band
+ * @param end_page Last page of the band
+ * @param interval Frames between two steps
+ */
+void SSD1306::scroll_start(ScrollDirection direction, uint8_t start_page, uint8_t end_page,
+                           ScrollInterval interval)
+{
+    CommandStream commands;
+    // The setup is only taken while no scroll is running
+    commands.add(OLED_SET_SCROLL | 0x00);
+    commands.add(OLED_SET_HORIZ_SCROLL | direction, 0x00, start_page);
+    commands.add(interval, end_page);
+    // Dummy bytes closing the setup
+    commands.add(0x00, 0xFF);
+    commands.add(OLED_SET_SCROLL | 0x01);
+    lock();
+    write_commands(commands);
+    mScrolling = true;
+    unlock();
+}
+
+/**
+ * @brief Stops a continuous scroll. The content is left wherever the scroll
+ * stopped it, so the scrolled band has to be written again.
+ */
+void SSD1306::scroll_stop()
+{
+    CommandStream commands;
+    commands.add(OLED_SET_SCROLL | 0x00);
+    lock();
+    write_commands(commands);
+    mScrolling = false;
+    unlock();
+}
+
+bool SSD1306::scrolling()
+{
+    return mScrolling;
+}
+
+/**
+ * @brief Stops a continuous scroll ahead of a display RAM write, since RAM
+ * written while the controller scrolls it is corrupted. Only the area being
+ * written is good afterwards, the rest of the scrolled band is left where the
+ * scroll stopped it. Called with the lock held.
+ */
+void SSD1306::stop_scroll_for_write()
+{
+    if(mScrolling) {
+        scroll_stop();
+    }
+}
+
+/**
+ * @brief Sets the display RAM row shown in the top row of the screen. Moving
+ * it moves the whole picture up or down without touching display RAM.
+ */
+void SSD1306::set_start_line(uint8_t line)
+{
+    CommandStream commands;
+    lock();
+    mStartLine = line % OLED_HEIGHT;
+    commands.add(OLED_SET_DISP_START_LINE | mStartLine);
+    write_commands(commands);
+    unlock();
+}
+
+uint8_t SSD1306::start_line()
+{
+    return mStartLine;
+}
+
+/**
+ * @brief Scrolls the screen by moving the display start line, then writes only
+ * the display RAM pages holding the rows that came into view. Rows that left
+ * the screen on one edge are the ones that come back on the other, so a one
+ * row step costs a single page instead of the whole display.
+ *
+ * @param rows Rows the content moves up by, negative to move it down
+ * @param frame Screen as it is after the scroll, top row first
+ */
+void SSD1306::scroll_rows(int32_t rows, const DisplayRam &frame)
+{
+    if(rows == 0) {
+        return;
+    }
+
+    lock();
+    // A continuous scroll moved the whole band, so none of it can be kept
+    bool scrolled = mScrolling;
+    stop_scroll_for_write();
+    // Display RAM wraps around every OLED_HEIGHT rows, as does unsigned
+    // arithmetic, so a negative step works out the same
+    uint8_t line = (mStartLine + (uint32_t)rows) % OLED_HEIGHT;
+    uint32_t count = abs(rows);
+    if((count >= OLED_HEIGHT) || scrolled) {
+        // Nothing on screen is kept
+        set_start_line(line);
+        write_frame(frame);
+        unlock();
+        return;
+    }
+
+    // Content moving up comes in at the bottom, which is where the old top
+    // rows sit in display RAM
+    uint32_t first = (rows > 0) ? mStartLine : line;
+    uint32_t last = first + count - 1;
+    uint32_t pages = (last / OLED_PAGE_HEIGHT) - (first / OLED_PAGE_HEIGHT) + 1;
+    if(pages > OLED_PAGE_HEIGHT) {
+        pages = OLED_PAGE_HEIGHT;
+    }
+
+    // The new start line goes out with the first window, so the screen moves
+    // right before the rows it exposes are written
+    mStartLine = line;
+    CommandStream commands;
+    commands.add(OLED_SET_DISP_START_LINE | mStartLine);
+    write_ram_pages(commands, frame, first / OLED_PAGE_HEIGHT, pages);
+    unlock();
+}
+
+/**
+ * @brief Writes a whole screen to display RAM, placed to follow the display
+ * start line. Use it in place of write_buffer once the start line has moved.
+ *
+ * @param frame Screen to show, top row first
+ */
+void SSD1306::write_frame(const DisplayRam &frame)
+{
+    CommandStream commands;
+    lock();
+    stop_scroll_for_write();
+    write_ram_pages(commands, frame, 0, OLED_PAGE_HEIGHT);
+    unlock();
+}
+
+/**
+ * @brief Works out how a new frame is sent to the display. When partial
+ * flushes are allowed, each page is compared against the frame on screen so
+ * only the span of columns that differ is sent. The whole frame is sent
+ * instead when the windows would cost more than a full transfer, framing of
+ * the bus included.
+ *
+ * @param frame Frame to display
+ * @param shown Frame currently on the display
+ * @param partial True to allow partial flushes
+ * @param plan Returns the pages and columns to send
+ */
+void SSD1306::plan_flush(const DisplayRam &frame, const DisplayRam &shown, bool partial, FlushPlan *plan)
+{
+    // A window costs its six address commands and the data that follows, each
+    // a transaction of its own
+    uint32_t framing = mTransport->framing_bytes();
+    uint32_t windowCost = (6 + framing) + framing;
+    uint32_t fullCost = sizeof(DisplayRam) + framing;
+    uint32_t cost = 0;
+
+    plan->dirty = 0;
+    plan->pages = 0;
+    if(partial) {
+        for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
+            int32_t first = 0;
+            int32_t last = OLED_WIDTH - 1;
+            while((first <= last) && (frame[page][first] == shown[page][first])) {
+                first++;
+            }
+            while((last > first) && (frame[page][last] == shown[page][last])) {
+                last--;
+            }
+
+            if(first <= last) {
+                plan->span_start[page] = first;
+                plan->span_end[page] = last;
+                cost += windowCost + (last - first + 1);
+                plan->dirty |= (1 << page);
+                plan->pages++;
+            }
+        }
+    }
+
+    plan->full = !partial || (cost >= fullCost);
+    if(plan->full) {
+        plan->pages = OLED_PAGE_HEIGHT;
+    }
+}
+
+/**
+ * @brief Sends a frame to the display as laid out by plan_flush, with the
+ * display start line left at 0. Only reads the frame, so the next one may be
+ * computed from it meanwhile. The windows and their data go out without
+ * another user in between.
+ *
+ * @param frame Frame to display
+ * @param plan Pages and columns to send
+ * @param async True to hand the data to the transport asynchronously, only
+ * the window commands of a partial flush wait for the transfer in flight
+ * @return Number of bytes sent over the bus
+ */
+uint32_t SSD1306::flush(DisplayRamWrite &frame, const FlushPlan &plan, bool async)
+{
+    lock();
+    stop_scroll_for_write();
+    uint32_t start = bytes_written();
+
+    if(plan.full) {
+        // Partial flushes leave the display with a narrow window, a full
+        // frame has to reopen the whole display first
+        if(mWindowed) {
+            reset_cursor();
+        }
+        if(async) {
+            write_buffer_async(frame);
+        } else {
+            write_buffer(frame);
+        }
+    } else {
+        for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
+            if(plan.dirty & (1 << page)) {
+                RenderArea area = {};
+                area.start_col = plan.span_start[page];
+                area.end_col = plan.span_end[page];
+                area.start_page = page;
+                area.end_page = page;
+                calc_render_area_buflen(&area);
+                if(async) {
+                    render_async(&frame.ram[page][area.start_col], &area);
+                } else {
+                    render(&frame.ram[page][area.start_col], &area);
+                }
+            }
+        }
+    }
+
+    uint32_t sent = bytes_written() - start;
+    unlock();
+    return sent;
+}
+
+/**
+ * @brief Builds a page of display RAM from the screen it has to show. With a
+ * start line that is not a multiple of eight, a RAM page straddles two pages
+ * of the screen.
+ */
+void SSD1306::ram_page(const DisplayRam &frame, uint8_t start_line, uint32_t page, uint8_t *buffer)
+{
+    // Screen row shown by the first row of the page
+    uint32_t row = ((page * OLED_PAGE_HEIGHT) + OLED_HEIGHT - start_line) % OLED_HEIGHT;
+    uint32_t shift = row % OLED_PAGE_HEIGHT;
+    const uint8_t *upper = frame[row / OLED_PAGE_HEIGHT];
+    if(shift == 0) {
+        memcpy(buffer, upper, OLED_WIDTH);
+        return;
+    }
+
+    const uint8_t *lower = frame[((row / OLED_PAGE_HEIGHT) + 1) % OLED_PAGE_HEIGHT];
+    for(uint32_t column = 0; column < OLED_WIDTH; column++) {
+        buffer[column] = (upper[column] >> shift) | (lower[column] << (OLED_PAGE_HEIGHT - shift));
+    }
+}
+
+/**
+ * @brief Writes a run of display RAM pages, wrapping past the last page. Each
+ * window goes out behind the commands already gathered by the caller.
+ */
+void SSD1306::write_ram_pages(CommandStream &commands, const DisplayRam &frame, uint32_t first, uint32_t count)
+{
+    uint8_t buffer[OLED_BUF_LEN];
+    while(count > 0) {
+        uint32_t run = count;
+        if((first + run) > OLED_PAGE_HEIGHT) {
+            run = OLED_PAGE_HEIGHT - first;
+        }
+        for(uint32_t i = 0; i < run; i++) {
+            ram_page(frame, mStartLine, first + i, &buffer[i * OLED_WIDTH]);
+        }
+
+        commands.add(OLED_SET_COL_ADDR, 0x00, OLED_WIDTH - 1);
+        commands.add(OLED_SET_PAGE_ADDR, first, first + run - 1);
+        write_commands(commands);
+        mWindowed = (run < OLED_PAGE_HEIGHT);
+        write_buffer(buffer, run * OLED_WIDTH);
+
+        commands.clear();
+        first = 0;
+        count -= run;
+    }
+}
+
+void SSD1306::reset_cursor()
+{
+    set_window(0x00, OLED_WIDTH - 1, 0x00, OLED_NUM_PAGES - 1);
+}
+
+/**
+ * @brief Limits writes to display RAM to a window, both address commands in
+ * one transaction
+ */
+void SSD1306::set_window(uint8_t start_col, uint8_t end_col, uint8_t start_page, uint8_t end_page)
+{
+    CommandStream commands;
+    // Indicates start column and end column
+    commands.add(OLED_SET_COL_ADDR, start_col, end_col);
+    // Indicates start page and end page
+    commands.add(OLED_SET_PAGE_ADDR, start_page, end_page);
+    lock();
+    write_commands(commands);
+    mWindowed = (start_col > 0) || (end_col < (OLED_WIDTH - 1)) || (start_page > 0) ||
+                (end_page < (OLED_NUM_PAGES - 1));
+    unlock();
+}
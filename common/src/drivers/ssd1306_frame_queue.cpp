@@ -0,0 +1,242 @@
+#include <string.h>
+
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+#include "common/drivers/ssd1306_frame_queue.h"
+
+/**
+ * @brief Construct a new frame queue
+ *
+ * @param display Display the frames are presented on
+ * @param depth Number of frames, 2 for double and 3 for triple buffering
+ * @param policy What the producer gets when every frame is taken
+ */
+SSD1306FrameQueue::SSD1306FrameQueue(SSD1306 *display, uint32_t depth, Policy policy) :
+    mDisplay(display),
+    mDepth(depth),
+    mPolicy(policy),
+    mNextSequence(0),
+    mLatencyTotal(0)
+{
+    if(mDepth < 2) {
+        mDepth = 2;
+    } else if(mDepth > SSD1306_FRAME_QUEUE_MAX) {
+        mDepth = SSD1306_FRAME_QUEUE_MAX;
+    }
+
+    for(uint32_t i = 0; i < SSD1306_FRAME_QUEUE_MAX; i++) {
+        mState[i] = State::FREE;
+        mSequence[i] = 0;
+        mSubmitted[i] = 0;
+    }
+    memset(&mStats, 0, sizeof(Stats));
+    critical_section_init(&mLock);
+}
+
+SSD1306FrameQueue::~SSD1306FrameQueue()
+{
+    critical_section_deinit(&mLock);
+}
+
+/**
+ * @brief Finds a frame in the given state, the lock must be held
+ *
+ * @return Index of the frame, -1 if there is none
+ */
+int32_t SSD1306FrameQueue::find(State state)
+{
+    for(uint32_t i = 0; i < mDepth; i++) {
+        if(mState[i] == state) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Finds the queued frame submitted first, the lock must be held
+ *
+ * @return Index of the frame, -1 if nothing is queued
+ */
+int32_t SSD1306FrameQueue::oldest_queued()
+{
+    int32_t oldest = -1;
+    for(uint32_t i = 0; i < mDepth; i++) {
+        // Sequence numbers are compared by distance so they can wrap
+        if((mState[i] == State::QUEUED) &&
+           ((oldest < 0) || ((int32_t)(mSequence[i] - mSequence[oldest]) < 0))) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+/**
+ * @brief Takes a frame to draw into. When every frame is taken the producer
+ * either waits for the presenter or, under the DROP policy, takes back the
+ * oldest frame that has not been presented yet.
+ *
+ * @param wait Wait for a frame to be freed rather than give up
+ * @return Frame to draw into, nullptr if none is free and not waiting
+ */
+SSD1306::DisplayRamWrite *SSD1306FrameQueue::acquire(bool wait)
+{
+    uint64_t waitStart = 0;
+    do {
+        critical_section_enter_blocking(&mLock);
+        int32_t index = find(State::FREE);
+        if((index < 0) && (mPolicy == Policy::DROP)) {
+            index = oldest_queued();
+            if(index >= 0) {
+                mStats.dropped++;
+            }
+        }
+        if(index >= 0) {
+            mState[index] = State::DRAWING;
+            if(waitStart != 0) {
+                mStats.producer_wait_us += (uint32_t)(time_us_64() - waitStart);
+            }
+        } else if(wait && (waitStart == 0)) {
+            mStats.producer_waits++;
+            waitStart = time_us_64();
+        }
+        critical_section_exit(&mLock);
+
+        if(index >= 0) {
+            return &mFrames[index];
+        }
+        if(!wait) {
+            return nullptr;
+        }
+        // Woken by the presenter freeing a frame
+        __wfe();
+    } while(true);
+}
+
+/**
+ * @brief Queues a frame drawn into since acquire, for the presenter to send.
+ * The frame must not be touched afterwards.
+ */
+void SSD1306FrameQueue::submit(SSD1306::DisplayRamWrite *frame)
+{
+    uint32_t index = frame - mFrames;
+    if((index >= mDepth) || (mState[index] != State::DRAWING)) {
+        return;
+    }
+
+    critical_section_enter_blocking(&mLock);
+    mState[index] = State::QUEUED;
+    mSequence[index] = mNextSequence++;
+    mSubmitted[index] = time_us_64();
+    mStats.submitted++;
+    critical_section_exit(&mLock);
+    __sev();
+}
+
+/**
+ * @brief Sends the oldest queued frame to the display and frees it. Meant to
+ * run on the core that does not draw.
+ *
+ * @param wait Wait for a frame to be submitted rather than give up
+ * @return True if a frame was presented
+ */
+bool SSD1306FrameQueue::present(bool wait)
+{
+    int32_t index = -1;
+    do {
+        critical_section_enter_blocking(&mLock);
+        index = oldest_queued();
+        if(index >= 0) {
+            mState[index] = State::PRESENTING;
+        }
+        critical_section_exit(&mLock);
+
+        if(index >= 0) {
+            break;
+        }
+        if(!wait) {
+            return false;
+        }
+        // Woken by the producer submitting a frame
+        __wfe();
+    } while(true);
+
+    uint64_t start = time_us_64();
+    mDisplay->lock();
+    mDisplay->reset_cursor();
+    mDisplay->write_buffer(mFrames[index]);
+    mDisplay->unlock();
+    uint64_t now = time_us_64();
+
+    critical_section_enter_blocking(&mLock);
+    mState[index] = State::FREE;
+    mStats.presented++;
+    mStats.present_us = (uint32_t)(now - start);
+    mStats.latency_us = (uint32_t)(now - mSubmitted[index]);
+    if(mStats.latency_us > mStats.latency_max_us) {
+        mStats.latency_max_us = mStats.latency_us;
+    }
+    mLatencyTotal += mStats.latency_us;
+    mStats.latency_avg_us = (uint32_t)(mLatencyTotal / mStats.presented);
+    critical_section_exit(&mLock);
+    __sev();
+    return true;
+}
+
+/**
+ * @brief Presents frames as they are submitted, never returns. Launch it on
+ * the presenting core.
+ */
+void SSD1306FrameQueue::run()
+{
+    do {
+        present(true);
+    } while(true);
+}
+
+uint32_t SSD1306FrameQueue::depth()
+{
+    return mDepth;
+}
+
+/**
+ * @brief Retrieves the number of frames submitted and not yet presented
+ */
+uint32_t SSD1306FrameQueue::pending()
+{
+    uint32_t count = 0;
+    critical_section_enter_blocking(&mLock);
+    for(uint32_t i = 0; i < mDepth; i++) {
+        if(mState[i] == State::QUEUED) {
+            count++;
+        }
+    }
+    critical_section_exit(&mLock);
+    return count;
+}
+
+void SSD1306FrameQueue::set_policy(Policy policy)
+{
+    mPolicy = policy;
+}
+
+SSD1306FrameQueue::Policy SSD1306FrameQueue::policy()
+{
+    return mPolicy;
+}
+
+void SSD1306FrameQueue::get_stats(Stats *stats)
+{
+    critical_section_enter_blocking(&mLock);
+    *stats = mStats;
+    critical_section_exit(&mLock);
+}
+
+void SSD1306FrameQueue::reset_stats()
+{
+    critical_section_enter_blocking(&mLock);
+    memset(&mStats, 0, sizeof(Stats));
+    mLatencyTotal = 0;
+    critical_section_exit(&mLock);
+}
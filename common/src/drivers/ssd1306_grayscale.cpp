@@ -0,0 +1,145 @@
+#include "hardware/timer.h"
+
+#include "common/drivers/ssd1306_grayscale.h"
+
+// Delay before trying again to start a plane while the previous one is still
+// on the bus
+#define SSD1306_GRAYSCALE_RETRY_US  50
+
+static uint32_t ssd1306_grayscale_plane_length(const Canvas *canvas)
+{
+    // Canvases pack eight rows into a byte
+    return ((canvas->height + 7) / 8) * canvas->width;
+}
+
+/**
+ * @brief Starts the next plane and schedules the one after it. Runs in the
+ * timer interrupt, so it never waits on the bus.
+ */
+static int64_t ssd1306_grayscale_alarm(alarm_id_t id, void *user_data)
+{
+    ssd1306_grayscale *grayscale = (ssd1306_grayscale*)user_data;
+    if(!grayscale->running) {
+        return 0;
+    }
+
+    if(grayscale->display->transfer_busy()) {
+        grayscale->stats.overruns++;
+        return -SSD1306_GRAYSCALE_RETRY_US;
+    }
+
+    uint64_t now = time_us_64();
+    if(grayscale->plane_start != 0) {
+        uint32_t previous = (grayscale->plane + grayscale->plane_count - 1) % grayscale->plane_count;
+        grayscale->stats.plane_us[previous] = (uint32_t)(now - grayscale->plane_start);
+        grayscale->stats.transfer_us = grayscale->display->transfer_us();
+    }
+    grayscale->plane_start = now;
+
+    if(grayscale->plane == 0) {
+        // New planes only ever take over between two refreshes
+        if(grayscale->pending) {
+            grayscale->planes = grayscale->pending;
+            grayscale->pending = nullptr;
+        }
+
+        grayscale->stats.refreshes++;
+        grayscale->window_refreshes++;
+        uint64_t elapsed = now - grayscale->window_start;
+        if(elapsed >= 1000000) {
+            grayscale->stats.refresh_hz = (uint32_t)((grayscale->window_refreshes * 1000000ULL) / elapsed);
+            grayscale->window_refreshes = 0;
+            grayscale->window_start = now;
+        }
+    }
+
+    Canvas *canvas = &grayscale->planes[grayscale->plane];
+    grayscale->display->write_buffer_async(canvas->image, ssd1306_grayscale_plane_length(canvas));
+
+    // Counted from when this plane was due, so late planes do not push the
+    // rest of the refresh back. The alarm counts positive delays from the
+    // last time it fired, retries included, so the delay is given from now.
+    uint32_t weight = grayscale->weights[grayscale->plane];
+    grayscale->plane = (grayscale->plane + 1) % grayscale->plane_count;
+    grayscale->due += (uint64_t)weight * grayscale->stats.slot_us;
+
+    uint64_t returned = time_us_64();
+    return (grayscale->due > returned) ? -(int64_t)(grayscale->due - returned) : -1;
+}
+
+bool ssd1306_grayscale_init(ssd1306_grayscale *grayscale, SSD1306 *display, const uint8_t *weights,
+                            uint32_t plane_count, uint32_t refresh_hz)
+{
+    memset(grayscale, 0, sizeof(ssd1306_grayscale));
+    if(!display->dma_ready() || (plane_count == 0) || (plane_count > SSD1306_GRAYSCALE_PLANES_MAX) ||
+       (refresh_hz == 0)) {
+        return false;
+    }
+
+    uint32_t total = 0;
+    for(uint32_t i = 0; i < plane_count; i++) {
+        grayscale->weights[i] = weights[i];
+        total += weights[i];
+    }
+    if(total == 0) {
+        return false;
+    }
+
+    grayscale->display = display;
+    grayscale->plane_count = plane_count;
+    grayscale->refresh_hz = refresh_hz;
+    grayscale->stats.slot_us = 1000000 / (refresh_hz * total);
+    return true;
+}
+
+bool ssd1306_grayscale_start(ssd1306_grayscale *grayscale, Canvas *planes)
+{
+    if((grayscale->display == nullptr) || grayscale->running) {
+        return false;
+    }
+
+    grayscale->display->reset_cursor();
+
+    grayscale->planes = planes;
+    grayscale->pending = nullptr;
+    grayscale->plane = 0;
+    grayscale->plane_start = 0;
+    grayscale->window_start = time_us_64();
+    grayscale->window_refreshes = 0;
+    grayscale->running = true;
+    grayscale->due = grayscale->window_start + grayscale->stats.slot_us;
+
+    grayscale->alarm = add_alarm_in_us(grayscale->stats.slot_us, ssd1306_grayscale_alarm, grayscale, true);
+    if(grayscale->alarm <= 0) {
+        grayscale->running = false;
+    }
+    return grayscale->running;
+}
+
+void ssd1306_grayscale_stop(ssd1306_grayscale *grayscale)
+{
+    if(grayscale->running) {
+        grayscale->running = false;
+        cancel_alarm(grayscale->alarm);
+        grayscale->display->wait_transfer();
+    }
+}
+
+void ssd1306_grayscale_present(ssd1306_grayscale *grayscale, Canvas *planes)
+{
+    if(grayscale->running) {
+        grayscale->pending = planes;
+    } else {
+        grayscale->planes = planes;
+    }
+}
+
+bool ssd1306_grayscale_swap_pending(ssd1306_grayscale *grayscale)
+{
+    return grayscale->pending != nullptr;
+}
+
+void ssd1306_grayscale_get_stats(ssd1306_grayscale *grayscale, ssd1306_grayscale_stats *stats)
+{
+    *stats = grayscale->stats;
+}
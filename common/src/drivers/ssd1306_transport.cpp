@@ -0,0 +1,173 @@
+#include <string.h>
+
+#include "common/drivers/ssd1306_transport.h"
+
+SSD1306Transport::SSD1306Transport() :
+    mBytesWritten(0)
+{
+}
+
+/**
+ * @brief Writes data that sits one byte into the buffer. The byte in front is
+ * free for the transport to put its framing in, so the data goes out without
+ * being copied.
+ *
+ * @param buffer Spare byte followed by the data
+ * @param length Length of the data, not counting the spare byte
+ */
+void SSD1306Transport::write_data_framed(uint8_t *buffer, uint32_t length)
+{
+    write_data(&buffer[1], length);
+}
+
+/**
+ * @brief Checks if the transport can send data without blocking
+ */
+bool SSD1306Transport::async_ready()
+{
+    return false;
+}
+
+/**
+ * @brief Starts sending data and returns while it is still on its way, if the
+ * transport can. The data is sent blocking otherwise.
+ */
+void SSD1306Transport::write_data_async(const uint8_t *data, uint32_t length, TransferCallback callback,
+                                        void *context)
+{
+    write_data(data, length);
+    if(callback) {
+        callback(context);
+    }
+}
+
+/**
+ * @brief Blocks until the asynchronous transfer in flight is done
+ */
+void SSD1306Transport::wait()
+{
+}
+
+bool SSD1306Transport::busy()
+{
+    return false;
+}
+
+/**
+ * @brief Changes the bus clock, once the transfer in flight is done
+ *
+ * @param hz Desired clock
+ * @return Clock the bus settled on, 0 if the transport has no clock to set
+ */
+uint32_t SSD1306Transport::set_clock(uint32_t hz)
+{
+    (void)hz;
+    return 0;
+}
+
+/**
+ * @brief Retrieves the time the last asynchronous transfer spent on the bus
+ */
+uint32_t SSD1306Transport::transfer_us()
+{
+    return 0;
+}
+
+/**
+ * @brief Retrieves the time callers spent on the last asynchronous transfer
+ */
+uint32_t SSD1306Transport::cpu_us()
+{
+    return 0;
+}
+
+uint32_t SSD1306Transport::transfer_aborts()
+{
+    return 0;
+}
+
+/**
+ * @brief Retrieves the bytes each transaction puts on the bus on top of its
+ * payload, which decides when a few windows cost more than a whole frame
+ */
+uint32_t SSD1306Transport::framing_bytes()
+{
+    return 0;
+}
+
+/**
+ * @brief Retrieves the number of bytes put on the bus so far, framing
+ * included. Callers take the difference of two readings to measure a transfer.
+ */
+uint32_t SSD1306Transport::bytes_written()
+{
+    return mBytesWritten;
+}
+
+SSD1306RecordingTransport::SSD1306RecordingTransport() :
+    mLength(0),
+    mTransactionCount(0),
+    mOverflow(false)
+{
+}
+
+void SSD1306RecordingTransport::write_commands(const uint8_t *commands, uint32_t length)
+{
+    record(Kind::COMMAND, commands, length);
+}
+
+void SSD1306RecordingTransport::write_data(const uint8_t *data, uint32_t length)
+{
+    record(Kind::DATA, data, length);
+}
+
+/**
+ * @brief Keeps a transaction. Transactions that no longer fit are dropped
+ * whole and flag the recording as overflowed.
+ */
+void SSD1306RecordingTransport::record(Kind kind, const uint8_t *bytes, uint32_t length)
+{
+    if((mTransactionCount < SSD1306_RECORD_TRANSACTIONS) && ((mLength + length) <= SSD1306_RECORD_BYTES)) {
+        Transaction *transaction = &mTransactions[mTransactionCount++];
+        transaction->kind = kind;
+        transaction->offset = mLength;
+        transaction->length = length;
+        memcpy(&mBytes[mLength], bytes, length);
+        mLength += length;
+    } else {
+        mOverflow = true;
+    }
+    mBytesWritten += length;
+}
+
+void SSD1306RecordingTransport::clear()
+{
+    mLength = 0;
+    mTransactionCount = 0;
+    mOverflow = false;
+}
+
+uint32_t SSD1306RecordingTransport::transactions()
+{
+    return mTransactionCount;
+}
+
+const SSD1306RecordingTransport::Transaction *SSD1306RecordingTransport::transaction(uint32_t index)
+{
+    return (index < mTransactionCount) ? &mTransactions[index] : nullptr;
+}
+
+const uint8_t *SSD1306RecordingTransport::bytes()
+{
+    return mBytes;
+}
+
+uint32_t SSD1306RecordingTransport::length()
+{
+    return mLength;
+}
+
+bool SSD1306RecordingTransport::overflow()
+{
+    return mOverflow;
+}
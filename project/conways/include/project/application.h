@@ -13,6 +13,7 @@
 #include "common/drivers/ssd1306.h"
 #include "common/logger.h"
 
+#include "project/command/command_conways.h"
 #include "project/game.h"
 
 #ifndef CONWAYS_VERSION
@@ -41,10 +42,15 @@ public:
     int32_t run();
 
 private:
+    SSD1306I2CTransport mDisplayBus;
+    SSD1306Mutex mDisplayLock;
     SSD1306 mDisplay;
 
+    Conways mConways;
+
     CommandHandler mHandler;
     CommandHelp mCmdHelp;
+    CommandConways mCmdConways;
 };
 
 #endif // CONWAYS_APPLICATION_H
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef CONWAYS_COMMAND_CONWAYS_H
+#define CONWAYS_COMMAND_CONWAYS_H
+
+#include "common/command/command_template.h"
+
+#include "project/game.h"
+
+#define COMMAND_NAME_CONWAYS    "conways"
+#define COMMAND_NAME_ENGINE     "engine"
+#define COMMAND_NAME_CORES      "cores"
+#define COMMAND_NAME_TRACKING   "tracking"
+#define COMMAND_NAME_PARTIAL    "partial"
+#define COMMAND_NAME_DMA        "dma"
+#define COMMAND_NAME_FPS        "fps"
+#define COMMAND_NAME_OVERLAP    "overlap"
+#define COMMAND_NAME_WORLD      "world"
+#define COMMAND_NAME_WRAP       "wrap"
+#define COMMAND_NAME_VIEW_X     "view_x"
+#define COMMAND_NAME_VIEW_Y     "view_y"
+#define COMMAND_NAME_BENCHMARK  "benchmark"
+#define COMMAND_NAME_BUS_BENCHMARK  "bus_benchmark"
+#define COMMAND_NAME_ADVANCE    "advance"
+#define COMMAND_NAME_RULE       "rule"
+#define COMMAND_NAME_PATTERN    "pattern"
+#define COMMAND_NAME_PATTERNS   "patterns"
+#define COMMAND_NAME_CYCLE_PERIOD   "cycle_period"
+#define COMMAND_NAME_CYCLE_ACTION   "cycle_action"
+#define COMMAND_NAME_STATS      "stats"
+
+class CommandConways
+        : public CommandTemplate< Conways >
+{
+public:
+    CommandConways();
+
+    int32_t setEngine( cJSON *json );
+    int32_t getEngine( cJSON *json );
+    int32_t setCores( cJSON *json );
+    int32_t getCores( cJSON *json );
+    int32_t setTracking( cJSON *json );
+    int32_t getTracking( cJSON *json );
+    int32_t setPartial( cJSON *json );
+    int32_t getPartial( cJSON *json );
+    int32_t setDma( cJSON *json );
+    int32_t getDma( cJSON *json );
+    int32_t setFps( cJSON *json );
+    int32_t getFps( cJSON *json );
+    int32_t setOverlap( cJSON *json );
+    int32_t getOverlap( cJSON *json );
+    int32_t setWorld( cJSON *json );
+    int32_t getWorld( cJSON *json );
+    int32_t setWrap( cJSON *json );
+    int32_t getWrap( cJSON *json );
+    int32_t setViewX( cJSON *json );
+    int32_t getViewX( cJSON *json );
+    int32_t setViewY( cJSON *json );
+    int32_t getViewY( cJSON *json );
+    int32_t benchmark( cJSON *json );
+    int32_t busBenchmark( cJSON *json );
+    int32_t advance( cJSON *json );
+    int32_t setRule( cJSON *json );
+    int32_t getRule( cJSON *json );
+    int32_t placePattern( cJSON *json );
+    int32_t getPatterns( cJSON *json );
+    int32_t setCyclePeriod( cJSON *json );
+    int32_t getCyclePeriod( cJSON *json );
+    int32_t setCycleAction( cJSON *json );
+    int32_t getCycleAction( cJSON *json );
+    int32_t stats( cJSON *json );
+
+protected:
+    int32_t setup() override;
+};
+
+#endif // CONWAYS_COMMAND_CONWAYS_H
@@ -1,16 +1,201 @@
 #ifndef CONWAYS_GAME_H
 #define CONWAYS_GAME_H
 
+#include "common/control/control_template.h"
 #include "common/drivers/ssd1306.h"
 
+#include "project/kernel.h"
+#include "project/rule.h"
+#include "project/pattern.h"
+
+enum ConwaysCycleAction : uint32_t {
+    CONWAYS_CYCLE_IDLE = 0,     // Stop computing and sending frames until the board is changed
+    CONWAYS_CYCLE_RESEED,       // Start over from a random board
+    CONWAYS_CYCLE_ACTION_MAX
+};
+
+#define CONWAYS_MAX_CORES   2
+#define CONWAYS_FPS_MAX     1000
+
+// Node pool of the HashLife engine, 32 bytes per node. The depth of the tree
+// is capped to keep the recursion within the core1 stack.
+#define CONWAYS_HASHLIFE_NODES      3072
+#define CONWAYS_HASHLIFE_BUCKETS    1024
+#define CONWAYS_HASHLIFE_MAX_LEVEL  16
+
+// Longest period looked for by cycle detection, and how often an idle game
+// loop looks for changes to the board
+#define CONWAYS_CYCLE_PERIOD_MAX        64
+#define CONWAYS_CYCLE_PERIOD_DEFAULT    16
+#define CONWAYS_IDLE_POLL_MS            20
+
+// Places a pattern in the middle of the display
+#define CONWAYS_PATTERN_CENTER  INT32_MIN
+
+struct ConwaysStats {
+    uint32_t generation;
+    uint32_t generationsPerSecond;          // Generations shown per second
+    uint32_t kernelGenerationsPerSecond;    // Generations per second of kernel time only
+    uint32_t kernelUs;                      // Kernel time of the last generation
+    uint32_t transferUs;                    // Time the game loop spent sending the last frame
+    uint32_t frameUs;                       // Time from the frame deadline to the end of the frame
+    uint32_t cores;                         // Cores sharing the generation work
+
+    // Frame pacing
+    uint32_t fps;                           // Target frame rate, 0 when unpaced
+    bool overlap;                           // Next generation computed while the frame is sent
+    uint32_t missedFrames;                  // Deadlines passed while a frame was still in progress
+
+    // Kernel generation rate last measured with one and with two cores
+    uint32_t coreGenerationsPerSecond[CONWAYS_MAX_CORES];
+
+    // Active region tracking
+    bool tracking;
+    uint32_t tilesActive;                   // Tiles computed in the last generation
+    uint32_t tileSkipPercent;               // Share of tiles skipped over the last second
+
+    // Display transfers
+    bool partial;
+    uint32_t flushBytes;                    // Bytes sent over I2C for the last frame
+    uint32_t flushBytesPerFrame;            // Average bytes per frame over the last second
+    uint32_t flushPages;                    // Pages sent for the last frame
+    bool dma;                               // Frames handed to DMA rather than written by the CPU
+    uint32_t busUs;                         // Time the last DMA transfer spent on the bus
+    uint32_t transferAborts;                // Transfers the display did not acknowledge
+    uint32_t lockContentions;               // Display accesses that waited on the other core
+    uint32_t lockWaitUs;                    // Time spent waiting on the other core, in total
+
+    ConwaysRule rule;
+
+    // Cycle and extinction detection
+    uint32_t population;                    // Live cells in the last generation
+    uint32_t cyclePeriod;                   // Period of the last cycle found, 1 for still boards
+    uint32_t cycleGeneration;               // Generation the last cycle was found at
+    uint32_t cycles;                        // Cycles found, extinctions included
+    uint32_t extinctions;
+    bool idle;                              // Game loop idles until the board is changed
+
+    // World shown through the viewport
+    bool world;
+    bool wrap;
+    int32_t viewX;
+    int32_t viewY;
+
+    // Last jump made with the HashLife engine
+    uint32_t advanceGenerations;
+    uint32_t advanceUs;
+    bool advanceFailed;                     // Engine ran out of nodes or levels before the jump completed
+    uint32_t hashlifeNodes;                 // Nodes in use after the jump
+    uint32_t hashlifeCollections;
+
+    // Last pattern placed
+    uint32_t patternCells;
+    uint32_t patternUs;                     // Time spent decoding the pattern
+
+    // Results of the last benchmark
+    uint32_t benchmarkGenerations;
+    uint32_t benchmarkCellGenerationsPerSecond;
+    uint32_t benchmarkSwarGenerationsPerSecond;
+    bool benchmarkMatch;
+};
+
 void conwaysRun();
+void conwaysStartWorker();
 
 void conwaysSetDisplay(SSD1306 *display);
+void conwaysSetBusClock(uint32_t hz);
 void conwaysSetReset();
 void conwaysStepSpeed();
+int32_t conwaysSetFps(uint32_t fps);
+uint32_t conwaysGetFps();
+int32_t conwaysSetOverlap(bool enable);
+bool conwaysGetOverlap();
+void conwaysSetWorld(bool enable);
+bool conwaysGetWorld();
+void conwaysSetWrap(bool enable);
+bool conwaysGetWrap();
+void conwaysSetRule(ConwaysRule rule);
+ConwaysRule conwaysGetRule();
+int32_t conwaysSetCyclePeriod(uint32_t period);
+uint32_t conwaysGetCyclePeriod();
+void conwaysSetCycleAction(ConwaysCycleAction action);
+ConwaysCycleAction conwaysGetCycleAction();
+void conwaysSetView(int32_t viewX, int32_t viewY);
+void conwaysGetView(int32_t *viewX, int32_t *viewY);
+void conwaysAdvance(uint32_t generations);
+int32_t conwaysPlacePattern(const char *name, int32_t x, int32_t y, bool clear);
+int32_t conwaysGetPattern(uint32_t index, ConwaysPattern *pattern);
+void conwaysSetEngine(ConwaysEngine engine);
+ConwaysEngine conwaysGetEngine();
+int32_t conwaysSetCores(uint32_t cores);
+uint32_t conwaysGetCores();
+void conwaysSetTracking(bool enable);
+bool conwaysGetTracking();
+void conwaysSetPartial(bool enable);
+bool conwaysGetPartial();
+int32_t conwaysSetDma(bool enable);
+bool conwaysGetDma();
+const char *conwaysEngineName(ConwaysEngine engine);
+void conwaysGetStats(ConwaysStats *stats);
+void conwaysBenchmark(uint32_t generations);
+void conwaysBusBenchmark(uint32_t repeats);
+
+/**
+ * @brief Control object exposing the game to the console
+ */
+class Conways
+    : public ControlTemplate< Conways >
+{
+public:
+    Conways();
+
+    int32_t setEngine(const char *name);
+    const char *engine();
+
+    int32_t setCores(uint32_t cores);
+    uint32_t cores();
+
+    void setTracking(bool enable);
+    bool tracking();
+
+    void setPartial(bool enable);
+    bool partial();
+
+    int32_t setDma(bool enable);
+    bool dma();
+
+    int32_t setFps(uint32_t fps);
+    uint32_t fps();
+
+    int32_t setOverlap(bool enable);
+    bool overlap();
+
+    void setWorld(bool enable);
+    bool world();
+
+    void setWrap(bool enable);
+    bool wrap();
+
+    void setView(int32_t viewX, int32_t viewY);
+    void view(int32_t *viewX, int32_t *viewY);
+
+    int32_t setRule(const char *name);
+    const char *rule();
+
+    int32_t setCyclePeriod(uint32_t period);
+    uint32_t cyclePeriod();
+
+    int32_t setCycleAction(const char *name);
+    const char *cycleAction();
+
+    void advance(uint32_t generations);
+
+    int32_t placePattern(const char *name, int32_t x, int32_t y, bool clear);
+    int32_t pattern(uint32_t index, ConwaysPattern *pattern);
 
-void printRamBoard(SSD1306::DisplayRam &ram);
-void checkRamBoard(SSD1306::DisplayRam &ram, SSD1306::DisplayRam &newRam, bool debug = false);
-void checkRamBoardNew(SSD1306::DisplayRam &ram, SSD1306::DisplayRam &newRam, bool debug = false);
+    void stats(ConwaysStats *stats);
+    void benchmark(uint32_t generations);
+    void busBenchmark(uint32_t repeats);
+};
 
 #endif // RP2040_CONTROL_GAME_H
@@ -0,0 +1,105 @@
+#ifndef CONWAYS_HASHLIFE_H
+#define CONWAYS_HASHLIFE_H
+
+#include <stdint.h>
+
+#define HASHLIFE_NONE       0xFFFFFFFF
+#define HASHLIFE_LEAF_LEVEL 2
+#define HASHLIFE_MIN_LEVEL  5
+#define HASHLIFE_MAX_LEVEL  62
+
+/**
+ * @brief Memoized quadtree Life engine. Identical squares of the board share
+ * one node and the future of every node is cached, so a board can be moved
+ * ahead by thousands of generations in a handful of steps. Nodes come from a
+ * fixed pool handed over by the owner and are reclaimed by mark and sweep once
+ * the pool runs low. This file has no dependency on the pico SDK so it can be
+ * built for the host as well.
+ */
+class HashLife
+{
+public:
+    /**
+     * @brief Square of 2^level cells. Leaves are 4x4 squares and keep their
+     * cells in the first child, one bit per cell in row order.
+     */
+    struct Node {
+        uint32_t child[4];      // North west, north east, south west, south east
+        uint32_t result;        // Center advanced by 2^step generations
+        uint32_t next;          // Next node in the hash bucket or in the free list
+        uint32_t population;
+        uint8_t level;
+        uint8_t step;           // Step the result was computed for
+        uint8_t mark;
+    };
+
+    // Reads the cell at x,y of the board loaded
+    using CellGetter = bool (*)(void *context, int32_t x, int32_t y);
+    // Sets the cell at x,y of the board rendered
+    using CellSetter = void (*)(void *context, int32_t x, int32_t y);
+
+    HashLife(Node *nodes, uint32_t capacity, uint32_t *buckets, uint32_t bucketCount,
+             uint32_t maxLevel = HASHLIFE_MAX_LEVEL);
+
+    int32_t setRule(uint16_t birth, uint16_t survive);
+    int32_t load(CellGetter get, void *context, int32_t width, int32_t height, bool bounded = false);
+    void render(CellSetter set, void *context, int32_t width, int32_t height);
+    int32_t advance(uint64_t generations);
+    void collect();
+
+    uint64_t generation();
+    uint32_t population();
+    uint32_t level();
+    uint32_t nodesUsed();
+    uint32_t capacity();
+    uint32_t collections();
+    bool exhausted();
+
+private:
+    Node *mNodes;
+    uint32_t *mBuckets;
+    uint32_t mCapacity;
+    uint32_t mBucketCount;
+    uint32_t mMaxLevel;
+    uint32_t mFree;
+    uint32_t mUsed;
+    uint32_t mCollections;
+    bool mExhausted;
+
+    uint32_t mRoot;
+    uint64_t mGeneration;
+    uint32_t mEmpty[HASHLIFE_MAX_LEVEL + 1];
+
+    // Board the root was loaded from, centered on the root
+    int32_t mWidth;
+    int32_t mHeight;
+    // Cells off the board are kept dead, as by the bounded kernels
+    bool mBounded;
+
+    // Block sums that bring a cell to life and that keep it alive
+    uint16_t mBirth;
+    uint16_t mSurvive;
+
+    void reset();
+    uint32_t allocate();
+    uint32_t hash(uint32_t level, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+    uint32_t leaf(uint32_t cells);
+    uint32_t node(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+    uint32_t empty(uint32_t level);
+    uint32_t center(uint32_t index);
+    uint32_t expand(uint32_t index);
+    uint32_t step(uint32_t index, uint32_t step);
+    int32_t advanceStep(uint32_t step);
+    int32_t advanceUnbounded(uint64_t generations);
+    uint32_t stepBase(uint32_t index, uint32_t step);
+    uint32_t build(CellGetter get, void *context, uint32_t level, int32_t x, int32_t y);
+    void draw(CellSetter set, void *context, uint32_t index, int32_t x, int32_t y);
+    bool padded(uint32_t index);
+    void bounds(uint32_t index, int64_t x, int64_t y, int64_t box[4]);
+    uint64_t margin();
+    uint32_t clip(uint32_t index, int64_t x, int64_t y);
+    int32_t clipRoot();
+    void mark(uint32_t index);
+};
+
+#endif // CONWAYS_HASHLIFE_H
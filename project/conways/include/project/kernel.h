@@ -0,0 +1,52 @@
+#ifndef CONWAYS_KERNEL_H
+#define CONWAYS_KERNEL_H
+
+#include <stdint.h>
+
+#include "project/rule.h"
+
+enum ConwaysEngine : uint32_t {
+    CONWAYS_ENGINE_CELL = 0,    // Reference kernel, one cell at a time
+    CONWAYS_ENGINE_SWAR,        // Bit parallel kernel, one page column at a time
+    CONWAYS_ENGINE_MAX
+};
+
+// Board laid out like the display RAM, a page of eight rows per byte with bit 0
+// holding the top row of the page. Matches SSD1306::DisplayRam, so the kernels
+// can be built without the pico SDK.
+#define CONWAYS_BOARD_WIDTH     128
+#define CONWAYS_BOARD_HEIGHT    64
+#define CONWAYS_BOARD_PAGES     (CONWAYS_BOARD_HEIGHT / 8)
+
+using ConwaysBoard = uint8_t[CONWAYS_BOARD_PAGES][CONWAYS_BOARD_WIDTH];
+
+// Active region tracking works on tiles of 8x8 cells, one page tall and eight
+// columns wide, giving a 16 bit tile mask per page
+#define CONWAYS_TILE_WIDTH      8
+#define CONWAYS_TILES_PER_PAGE  (CONWAYS_BOARD_WIDTH / CONWAYS_TILE_WIDTH)
+#define CONWAYS_TILES           (CONWAYS_TILES_PER_PAGE * CONWAYS_BOARD_PAGES)
+#define CONWAYS_TILES_ALL       0xFFFF
+
+/**
+ * @brief Change bitmaps carried from one generation to the next
+ */
+struct ConwaysTiles {
+    uint16_t active[CONWAYS_BOARD_PAGES];   // Tiles that must be computed this generation
+    uint16_t changed[CONWAYS_BOARD_PAGES];  // Tiles that changed in this generation
+};
+
+using ConwaysKernel = void (*)(ConwaysBoard &ram, ConwaysBoard &newRam, bool debug,
+                               int32_t pageStart, int32_t pageEnd, ConwaysTiles *tiles);
+
+ConwaysKernel conwaysGetKernel(ConwaysEngine engine, ConwaysRule rule);
+
+void printRamBoard(ConwaysBoard &ram);
+void checkRamBoard(ConwaysBoard &ram, ConwaysBoard &newRam, bool debug = false,
+                   int32_t pageStart = 0, int32_t pageEnd = CONWAYS_BOARD_PAGES, ConwaysTiles *tiles = nullptr);
+void checkRamBoardSwar(ConwaysBoard &ram, ConwaysBoard &newRam, bool debug = false,
+                       int32_t pageStart = 0, int32_t pageEnd = CONWAYS_BOARD_PAGES, ConwaysTiles *tiles = nullptr);
+
+void conwaysTilesMarkAll(ConwaysTiles *tiles);
+uint32_t conwaysTilesUpdate(ConwaysTiles *tiles);
+
+#endif // CONWAYS_KERNEL_H
@@ -0,0 +1,38 @@
+#ifndef CONWAYS_PATTERN_H
+#define CONWAYS_PATTERN_H
+
+#include <stdint.h>
+
+#define CONWAYS_PATTERN_NAME_MAX    32
+
+enum ConwaysPatternFormat : uint32_t {
+    CONWAYS_PATTERN_RLE = 0,        // Run length encoded, "x = 3, y = 3" header then b/o/$ runs up to "!"
+    CONWAYS_PATTERN_LIFE_106        // "#Life 1.06" followed by one "x y" pair per live cell
+};
+
+/**
+ * @brief Pattern found in a pattern library. A library is a text blob holding
+ * any number of patterns, each starting with a "#N <name>" line and running up
+ * to the next one. The pattern is decoded from the library in place.
+ */
+struct ConwaysPattern {
+    const char *name;
+    uint32_t nameLength;
+    const char *body;       // First line after the name
+    const char *end;        // End of the pattern in the library
+    ConwaysPatternFormat format;
+    int32_t width;
+    int32_t height;
+    int32_t originX;        // Smallest coordinate of a Life 1.06 pattern, 0 for RLE
+    int32_t originY;
+};
+
+// Sets a horizontal run of live cells starting at x,y
+using ConwaysPatternRun = void (*)(void *context, int32_t x, int32_t y, int32_t length);
+
+int32_t conwaysPatternFind(const char *library, uint32_t size, const char *name, ConwaysPattern *pattern);
+int32_t conwaysPatternAt(const char *library, uint32_t size, uint32_t index, ConwaysPattern *pattern);
+uint32_t conwaysPatternDecode(const ConwaysPattern *pattern, ConwaysPatternRun run, void *context,
+                              int32_t x, int32_t y, int32_t width, int32_t height);
+
+#endif // CONWAYS_PATTERN_H
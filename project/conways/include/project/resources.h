@@ -0,0 +1,8 @@
+#ifndef CONWAYS_RESOURCES_H
+#define CONWAYS_RESOURCES_H
+
+// Library of RLE and Life 1.06 patterns, see resources/patterns.rle
+extern "C" char patterns_rle[];
+extern "C" const unsigned int patterns_rle_size;
+
+#endif // CONWAYS_RESOURCES_H
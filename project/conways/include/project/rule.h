@@ -0,0 +1,91 @@
+#ifndef CONWAYS_RULE_H
+#define CONWAYS_RULE_H
+
+#include <stdint.h>
+
+// Bit n of a rule mask stands for n live neighbors
+#define CONWAYS_RULE_NEIGHBORS(n) (1 << (n))
+
+enum ConwaysRule : uint32_t {
+    CONWAYS_RULE_LIFE = 0,
+    CONWAYS_RULE_HIGHLIFE,
+    CONWAYS_RULE_SEEDS,
+    CONWAYS_RULE_DAY_NIGHT,
+    CONWAYS_RULE_REPLICATOR,
+    CONWAYS_RULE_MAZE,
+    CONWAYS_RULE_MAX
+};
+
+/**
+ * @brief Life-like rule, given as the neighbor counts that bring a dead cell
+ * to life and the counts that keep a live cell alive
+ */
+struct ConwaysRuleMasks {
+    const char *name;
+    const char *notation;
+    uint16_t birth;
+    uint16_t survive;
+};
+
+constexpr ConwaysRuleMasks conways_rules[CONWAYS_RULE_MAX] = {
+    {"life", "B3/S23",
+     CONWAYS_RULE_NEIGHBORS(3),
+     CONWAYS_RULE_NEIGHBORS(2) | CONWAYS_RULE_NEIGHBORS(3)},
+    {"highlife", "B36/S23",
+     CONWAYS_RULE_NEIGHBORS(3) | CONWAYS_RULE_NEIGHBORS(6),
+     CONWAYS_RULE_NEIGHBORS(2) | CONWAYS_RULE_NEIGHBORS(3)},
+    {"seeds", "B2/S",
+     CONWAYS_RULE_NEIGHBORS(2),
+     0},
+    {"daynight", "B3678/S34678",
+     CONWAYS_RULE_NEIGHBORS(3) | CONWAYS_RULE_NEIGHBORS(6) | CONWAYS_RULE_NEIGHBORS(7) | CONWAYS_RULE_NEIGHBORS(8),
+     CONWAYS_RULE_NEIGHBORS(3) | CONWAYS_RULE_NEIGHBORS(4) | CONWAYS_RULE_NEIGHBORS(6) | CONWAYS_RULE_NEIGHBORS(7) |
+     CONWAYS_RULE_NEIGHBORS(8)},
+    {"replicator", "B1357/S1357",
+     CONWAYS_RULE_NEIGHBORS(1) | CONWAYS_RULE_NEIGHBORS(3) | CONWAYS_RULE_NEIGHBORS(5) | CONWAYS_RULE_NEIGHBORS(7),
+     CONWAYS_RULE_NEIGHBORS(1) | CONWAYS_RULE_NEIGHBORS(3) | CONWAYS_RULE_NEIGHBORS(5) | CONWAYS_RULE_NEIGHBORS(7)},
+    {"maze", "B3/S12345",
+     CONWAYS_RULE_NEIGHBORS(3),
+     CONWAYS_RULE_NEIGHBORS(1) | CONWAYS_RULE_NEIGHBORS(2) | CONWAYS_RULE_NEIGHBORS(3) | CONWAYS_RULE_NEIGHBORS(4) |
+     CONWAYS_RULE_NEIGHBORS(5)}
+};
+
+/**
+ * @brief Next state of a cell from its neighbor count
+ */
+template< uint32_t Rule >
+static inline bool conwaysRuleCell(int32_t neighbors, bool alive)
+{
+    constexpr uint16_t birth = conways_rules[Rule].birth;
+    constexpr uint16_t survive = conways_rules[Rule].survive;
+    return ((alive ? survive : birth) >> neighbors) & 1;
+}
+
+/**
+ * @brief Next state of 32 cells at once from their 3x3 block sums, given as
+ * a four bit number per lane in s3..s0. The block sum includes the cell
+ * itself, so a live cell with n neighbors has a sum of n + 1. Sums the rule
+ * does not use are dropped at compile time.
+ */
+template< uint32_t Rule >
+static inline uint32_t conwaysRuleLanes(uint32_t s3, uint32_t s2, uint32_t s1, uint32_t s0, uint32_t alive)
+{
+    constexpr uint16_t birth = conways_rules[Rule].birth;
+    constexpr uint16_t survive = conways_rules[Rule].survive << 1;
+
+    uint32_t born = 0;
+    uint32_t kept = 0;
+    // Fully unrolled, so the tests of the rule fold away
+#pragma GCC unroll 10
+    for(uint32_t sum = 0; sum <= 9; sum++) {
+        if(((birth | survive) >> sum) & 1) {
+            uint32_t match = ((sum & 8) ? s3 : ~s3) & ((sum & 4) ? s2 : ~s2) &
+                             ((sum & 2) ? s1 : ~s1) & ((sum & 1) ? s0 : ~s0);
+            born |= ((birth >> sum) & 1) ? match : 0;
+            kept |= ((survive >> sum) & 1) ? match : 0;
+        }
+    }
+    return (born & ~alive) | (kept & alive);
+}
+
+#endif // CONWAYS_RULE_H
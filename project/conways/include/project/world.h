@@ -0,0 +1,22 @@
+#ifndef CONWAYS_WORLD_H
+#define CONWAYS_WORLD_H
+
+#include "project/kernel.h"
+#include "project/rule.h"
+
+// The world is kept as bands of 32 rows, each column of a band packed into a
+// word with bit 0 holding the top row of the band
+#define CONWAYS_WORLD_WIDTH         512
+#define CONWAYS_WORLD_HEIGHT        512
+#define CONWAYS_WORLD_BAND_HEIGHT   32
+#define CONWAYS_WORLD_BANDS         (CONWAYS_WORLD_HEIGHT / CONWAYS_WORLD_BAND_HEIGHT)
+
+using ConwaysWorld = uint32_t[CONWAYS_WORLD_BANDS][CONWAYS_WORLD_WIDTH];
+
+void conwaysWorldRandom(ConwaysWorld &world);
+void conwaysWorldStep(ConwaysWorld &world, ConwaysWorld &newWorld, bool wrap, ConwaysRule rule = CONWAYS_RULE_LIFE,
+                      int32_t bandStart = 0, int32_t bandEnd = CONWAYS_WORLD_BANDS);
+void conwaysWorldClampView(int32_t *viewX, int32_t *viewY, bool wrap);
+void conwaysWorldView(ConwaysWorld &world, ConwaysBoard &ram, int32_t viewX, int32_t viewY, bool wrap);
+
+#endif // CONWAYS_WORLD_H
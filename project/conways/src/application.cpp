@@ -2,6 +2,9 @@
 
 #define I2C_BUS_SPEED_KHZ(x) x * 1000
 
+// Clock the display bus runs at, found with the bus_benchmark command
+static const uint32_t i2c_bus_speed = I2C_BUS_SPEED_KHZ(1000);
+
 // Debounce control
 static uint32_t debounce_reset_button = to_ms_since_boot(get_absolute_time());
 static uint32_t debounce_speed_button = to_ms_since_boot(get_absolute_time());
@@ -79,7 +82,8 @@ const uint32_t Application::pin_i2c1_scl     = 27;
 const uint8_t Application::ssd1306_display_addr = 0x3D;
 
 Application::Application()
-    : mDisplay(i2c1, ssd1306_display_addr)
+    : mDisplayBus(i2c1, ssd1306_display_addr)
+    , mDisplay(&mDisplayBus, &mDisplayLock)
 {
 
 }
@@ -105,7 +109,7 @@ void Application::initialize()
 void Application::initializeI2C()
 {
     LOG_INFO("Initializing I2C...\n");
-    i2c_init(i2c1, I2C_BUS_SPEED_KHZ(1000));
+    i2c_init(i2c1, i2c_bus_speed);
     gpio_set_function(pin_i2c1_sda, GPIO_FUNC_I2C);
     gpio_set_function(pin_i2c1_scl, GPIO_FUNC_I2C);
     gpio_pull_up(pin_i2c1_sda);
@@ -118,20 +122,29 @@ void Application::initializeDisplay()
 {
     LOG_INFO("Initializing display...\n");
     LOG_INFO("Display @ 0x%02X\n", ssd1306_display_addr);
+    uint64_t start = time_us_64();
     mDisplay.initialize();
+    LOG_INFO("Display initialized in %u us\n", (uint32_t)(time_us_64() - start));
 
     // Flash display so we know it's alive
     mDisplay.fill_screen(0xFF);
     sleep_ms(500);
     mDisplay.fill_screen(0x00);
+
+    // Frames are sent through DMA when a channel is free
+    if(!mDisplayBus.dma_init()) {
+        LOG_WARN("Display DMA unavailable, frames will be sent blocking\n");
+    }
 }
 
 void Application::initializeConsole()
 {
     mCmdHelp.addControlObject(&mHandler);
+    mCmdConways.addControlObject(&mConways);
     // mCmdPixel.addControlObject(&mNeopixel);
 
     mHandler.addCommand(&mCmdHelp);
+    mHandler.addCommand(&mCmdConways);
     // mHandler.addCommand(&mCmdPixel);
     // mHandler.addCommand(&mCmdI2CDetect);
 
@@ -144,7 +157,9 @@ int32_t Application::run()
     initialize();
     
     conwaysSetDisplay(&mDisplay);
+    conwaysSetBusClock(i2c_bus_speed);
     multicore_launch_core1(conwaysRun);
+    conwaysStartWorker();
     
     LOG_INFO("Conways Version: %s\n", CONWAYS_VERSION);
     LOG_INFO(" Common Version: %s\n", COMMON_VERSION);
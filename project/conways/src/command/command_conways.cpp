@@ -0,0 +1,527 @@
+#include "project/command/command_conways.h"
+
+CommandConways::CommandConways()
+    : CommandTemplate< Conways >(COMMAND_NAME_CONWAYS)
+{
+    mMutableMap[COMMAND_NAME_ENGINE] = BIND_PARAMETER( &CommandConways::setEngine );
+    mMutableMap[COMMAND_NAME_CORES] = BIND_PARAMETER( &CommandConways::setCores );
+    mMutableMap[COMMAND_NAME_TRACKING] = BIND_PARAMETER( &CommandConways::setTracking );
+    mMutableMap[COMMAND_NAME_PARTIAL] = BIND_PARAMETER( &CommandConways::setPartial );
+    mMutableMap[COMMAND_NAME_DMA] = BIND_PARAMETER( &CommandConways::setDma );
+    mMutableMap[COMMAND_NAME_FPS] = BIND_PARAMETER( &CommandConways::setFps );
+    mMutableMap[COMMAND_NAME_OVERLAP] = BIND_PARAMETER( &CommandConways::setOverlap );
+    mMutableMap[COMMAND_NAME_WORLD] = BIND_PARAMETER( &CommandConways::setWorld );
+    mMutableMap[COMMAND_NAME_WRAP] = BIND_PARAMETER( &CommandConways::setWrap );
+    mMutableMap[COMMAND_NAME_VIEW_X] = BIND_PARAMETER( &CommandConways::setViewX );
+    mMutableMap[COMMAND_NAME_VIEW_Y] = BIND_PARAMETER( &CommandConways::setViewY );
+    mMutableMap[COMMAND_NAME_RULE] = BIND_PARAMETER( &CommandConways::setRule );
+    mMutableMap[COMMAND_NAME_BENCHMARK] = BIND_PARAMETER( &CommandConways::benchmark );
+    mMutableMap[COMMAND_NAME_BUS_BENCHMARK] = BIND_PARAMETER( &CommandConways::busBenchmark );
+    mMutableMap[COMMAND_NAME_ADVANCE] = BIND_PARAMETER( &CommandConways::advance );
+    mMutableMap[COMMAND_NAME_PATTERN] = BIND_PARAMETER( &CommandConways::placePattern );
+    mMutableMap[COMMAND_NAME_CYCLE_PERIOD] = BIND_PARAMETER( &CommandConways::setCyclePeriod );
+    mMutableMap[COMMAND_NAME_CYCLE_ACTION] = BIND_PARAMETER( &CommandConways::setCycleAction );
+
+    mAccessableMap[COMMAND_NAME_ENGINE] = BIND_PARAMETER( &CommandConways::getEngine );
+    mAccessableMap[COMMAND_NAME_CORES] = BIND_PARAMETER( &CommandConways::getCores );
+    mAccessableMap[COMMAND_NAME_TRACKING] = BIND_PARAMETER( &CommandConways::getTracking );
+    mAccessableMap[COMMAND_NAME_PARTIAL] = BIND_PARAMETER( &CommandConways::getPartial );
+    mAccessableMap[COMMAND_NAME_DMA] = BIND_PARAMETER( &CommandConways::getDma );
+    mAccessableMap[COMMAND_NAME_FPS] = BIND_PARAMETER( &CommandConways::getFps );
+    mAccessableMap[COMMAND_NAME_OVERLAP] = BIND_PARAMETER( &CommandConways::getOverlap );
+    mAccessableMap[COMMAND_NAME_WORLD] = BIND_PARAMETER( &CommandConways::getWorld );
+    mAccessableMap[COMMAND_NAME_WRAP] = BIND_PARAMETER( &CommandConways::getWrap );
+    mAccessableMap[COMMAND_NAME_VIEW_X] = BIND_PARAMETER( &CommandConways::getViewX );
+    mAccessableMap[COMMAND_NAME_VIEW_Y] = BIND_PARAMETER( &CommandConways::getViewY );
+    mAccessableMap[COMMAND_NAME_RULE] = BIND_PARAMETER( &CommandConways::getRule );
+    mAccessableMap[COMMAND_NAME_PATTERNS] = BIND_PARAMETER( &CommandConways::getPatterns );
+    mAccessableMap[COMMAND_NAME_CYCLE_PERIOD] = BIND_PARAMETER( &CommandConways::getCyclePeriod );
+    mAccessableMap[COMMAND_NAME_CYCLE_ACTION] = BIND_PARAMETER( &CommandConways::getCycleAction );
+    mAccessableMap[COMMAND_NAME_STATS] = BIND_PARAMETER( &CommandConways::stats );
+}
+
+int32_t CommandConways::setup()
+{
+    mControlObject = static_cast< Conways* >( mControlObjects.back() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setEngine( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsString( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else if( mControlObject->setEngine( json->valuestring ) != 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getEngine( cJSON *json )
+{
+    cJSON_AddStringToObject( json, COMMAND_NAME_ENGINE, mControlObject->engine() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setCores( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsNumber( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else if( json->valueint <= 0 || mControlObject->setCores( json->valueint ) != 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getCores( cJSON *json )
+{
+    cJSON_AddNumberToObject( json, COMMAND_NAME_CORES, mControlObject->cores() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setTracking( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( cJSON_IsBool( json ) ) {
+        mControlObject->setTracking( cJSON_IsTrue( json ) );
+    } else if( cJSON_IsNumber( json ) ) {
+        mControlObject->setTracking( json->valueint != 0 );
+    } else {
+        error = Error::PARAM_WRONG_TYPE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getTracking( cJSON *json )
+{
+    cJSON_AddBoolToObject( json, COMMAND_NAME_TRACKING, mControlObject->tracking() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setPartial( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( cJSON_IsBool( json ) ) {
+        mControlObject->setPartial( cJSON_IsTrue( json ) );
+    } else if( cJSON_IsNumber( json ) ) {
+        mControlObject->setPartial( json->valueint != 0 );
+    } else {
+        error = Error::PARAM_WRONG_TYPE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getPartial( cJSON *json )
+{
+    cJSON_AddBoolToObject( json, COMMAND_NAME_PARTIAL, mControlObject->partial() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setDma( cJSON *json )
+{
+    int32_t error = Error::NONE;
+    bool enable = false;
+
+    if( cJSON_IsBool( json ) ) {
+        enable = cJSON_IsTrue( json );
+    } else if( cJSON_IsNumber( json ) ) {
+        enable = json->valueint != 0;
+    } else {
+        error = Error::PARAM_WRONG_TYPE;
+    }
+
+    if( error == Error::NONE && mControlObject->setDma( enable ) != 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getDma( cJSON *json )
+{
+    cJSON_AddBoolToObject( json, COMMAND_NAME_DMA, mControlObject->dma() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setFps( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsNumber( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else if( json->valueint < 0 || mControlObject->setFps( json->valueint ) != 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getFps( cJSON *json )
+{
+    cJSON_AddNumberToObject( json, COMMAND_NAME_FPS, mControlObject->fps() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setOverlap( cJSON *json )
+{
+    int32_t error = Error::NONE;
+    bool enable = false;
+
+    if( cJSON_IsBool( json ) ) {
+        enable = cJSON_IsTrue( json );
+    } else if( cJSON_IsNumber( json ) ) {
+        enable = json->valueint != 0;
+    } else {
+        error = Error::PARAM_WRONG_TYPE;
+    }
+
+    if( error == Error::NONE && mControlObject->setOverlap( enable ) != 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getOverlap( cJSON *json )
+{
+    cJSON_AddBoolToObject( json, COMMAND_NAME_OVERLAP, mControlObject->overlap() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setWorld( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( cJSON_IsBool( json ) ) {
+        mControlObject->setWorld( cJSON_IsTrue( json ) );
+    } else if( cJSON_IsNumber( json ) ) {
+        mControlObject->setWorld( json->valueint != 0 );
+    } else {
+        error = Error::PARAM_WRONG_TYPE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getWorld( cJSON *json )
+{
+    cJSON_AddBoolToObject( json, COMMAND_NAME_WORLD, mControlObject->world() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setWrap( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( cJSON_IsBool( json ) ) {
+        mControlObject->setWrap( cJSON_IsTrue( json ) );
+    } else if( cJSON_IsNumber( json ) ) {
+        mControlObject->setWrap( json->valueint != 0 );
+    } else {
+        error = Error::PARAM_WRONG_TYPE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getWrap( cJSON *json )
+{
+    cJSON_AddBoolToObject( json, COMMAND_NAME_WRAP, mControlObject->wrap() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setViewX( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsNumber( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else {
+        int32_t viewX = 0;
+        int32_t viewY = 0;
+        mControlObject->view( &viewX, &viewY );
+        mControlObject->setView( json->valueint, viewY );
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getViewX( cJSON *json )
+{
+    int32_t viewX = 0;
+    int32_t viewY = 0;
+    mControlObject->view( &viewX, &viewY );
+    cJSON_AddNumberToObject( json, COMMAND_NAME_VIEW_X, viewX );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setViewY( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsNumber( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else {
+        int32_t viewX = 0;
+        int32_t viewY = 0;
+        mControlObject->view( &viewX, &viewY );
+        mControlObject->setView( viewX, json->valueint );
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getViewY( cJSON *json )
+{
+    int32_t viewX = 0;
+    int32_t viewY = 0;
+    mControlObject->view( &viewX, &viewY );
+    cJSON_AddNumberToObject( json, COMMAND_NAME_VIEW_Y, viewY );
+    return Error::NONE;
+}
+
+int32_t CommandConways::benchmark( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsNumber( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else if( json->valueint <= 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    } else {
+        mControlObject->benchmark( json->valueint );
+    }
+
+    return error;
+}
+
+int32_t CommandConways::busBenchmark( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsNumber( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else if( json->valueint <= 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    } else {
+        mControlObject->busBenchmark( json->valueint );
+    }
+
+    return error;
+}
+
+int32_t CommandConways::advance( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsNumber( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else if( json->valueint <= 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    } else {
+        mControlObject->advance( json->valueint );
+    }
+
+    return error;
+}
+
+int32_t CommandConways::setRule( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsString( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else if( mControlObject->setRule( json->valuestring ) != 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getRule( cJSON *json )
+{
+    cJSON_AddStringToObject( json, COMMAND_NAME_RULE, mControlObject->rule() );
+    return Error::NONE;
+}
+
+/**
+ * @brief Places a pattern from the pattern library, either given by name to
+ * place it in the middle of the display or as an object,
+ * {"name": "glider", "x": 10, "y": 20, "clear": false}
+ */
+int32_t CommandConways::placePattern( cJSON *json )
+{
+    int32_t error = Error::NONE;
+    const char *name = nullptr;
+    int32_t x = CONWAYS_PATTERN_CENTER;
+    int32_t y = CONWAYS_PATTERN_CENTER;
+    bool clear = true;
+
+    if( cJSON_IsString( json ) ) {
+        name = json->valuestring;
+    } else if( cJSON_IsObject( json ) ) {
+        cJSON *nameJson = cJSON_GetObjectItem( json, "name" );
+        cJSON *xJson = cJSON_GetObjectItem( json, "x" );
+        cJSON *yJson = cJSON_GetObjectItem( json, "y" );
+        cJSON *clearJson = cJSON_GetObjectItem( json, "clear" );
+
+        if( !cJSON_IsString( nameJson ) ||
+            ( ( xJson != nullptr ) && !cJSON_IsNumber( xJson ) ) ||
+            ( ( yJson != nullptr ) && !cJSON_IsNumber( yJson ) ) ||
+            ( ( clearJson != nullptr ) && !cJSON_IsBool( clearJson ) ) ) {
+            error = Error::PARAM_WRONG_TYPE;
+        } else {
+            name = nameJson->valuestring;
+            if( ( xJson != nullptr ) || ( yJson != nullptr ) ) {
+                x = xJson ? xJson->valueint : 0;
+                y = yJson ? yJson->valueint : 0;
+            }
+            clear = ( clearJson == nullptr ) || cJSON_IsTrue( clearJson );
+        }
+    } else {
+        error = Error::PARAM_WRONG_TYPE;
+    }
+
+    if( error == Error::NONE && mControlObject->placePattern( name, x, y, clear ) != 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getPatterns( cJSON *json )
+{
+    cJSON *patterns = cJSON_CreateArray();
+
+    ConwaysPattern pattern;
+    for( uint32_t index = 0; mControlObject->pattern( index, &pattern ) == 0; index++ ) {
+        char name[ CONWAYS_PATTERN_NAME_MAX ];
+        uint32_t length = ( pattern.nameLength < CONWAYS_PATTERN_NAME_MAX ) ?
+                    pattern.nameLength : CONWAYS_PATTERN_NAME_MAX - 1;
+        memcpy( name, pattern.name, length );
+        name[ length ] = '\0';
+        cJSON_AddItemToArray( patterns, cJSON_CreateString( name ) );
+    }
+
+    cJSON_AddItemToObject( json, COMMAND_NAME_PATTERNS, patterns );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setCyclePeriod( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsNumber( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else if( json->valueint < 0 || mControlObject->setCyclePeriod( json->valueint ) != 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getCyclePeriod( cJSON *json )
+{
+    cJSON_AddNumberToObject( json, COMMAND_NAME_CYCLE_PERIOD, mControlObject->cyclePeriod() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::setCycleAction( cJSON *json )
+{
+    int32_t error = Error::NONE;
+
+    if( !cJSON_IsString( json ) ) {
+        error = Error::PARAM_WRONG_TYPE;
+    } else if( mControlObject->setCycleAction( json->valuestring ) != 0 ) {
+        error = Error::PARAM_OUT_OF_RANGE;
+    }
+
+    return error;
+}
+
+int32_t CommandConways::getCycleAction( cJSON *json )
+{
+    cJSON_AddStringToObject( json, COMMAND_NAME_CYCLE_ACTION, mControlObject->cycleAction() );
+    return Error::NONE;
+}
+
+int32_t CommandConways::stats( cJSON *json )
+{
+    ConwaysStats stats;
+    mControlObject->stats( &stats );
+
+    cJSON *object = cJSON_CreateObject();
+    cJSON_AddNumberToObject( object, "generation", stats.generation );
+    cJSON_AddNumberToObject( object, "gen_per_sec", stats.generationsPerSecond );
+    cJSON_AddNumberToObject( object, "kernel_gen_per_sec", stats.kernelGenerationsPerSecond );
+    cJSON_AddNumberToObject( object, "kernel_us", stats.kernelUs );
+    cJSON_AddNumberToObject( object, "transfer_us", stats.transferUs );
+    cJSON_AddNumberToObject( object, "frame_us", stats.frameUs );
+    cJSON_AddNumberToObject( object, COMMAND_NAME_FPS, stats.fps );
+    cJSON_AddBoolToObject( object, COMMAND_NAME_OVERLAP, stats.overlap );
+    cJSON_AddNumberToObject( object, "missed_frames", stats.missedFrames );
+    cJSON_AddNumberToObject( object, COMMAND_NAME_CORES, stats.cores );
+    cJSON_AddNumberToObject( object, "one_core_gen_per_sec", stats.coreGenerationsPerSecond[0] );
+    cJSON_AddNumberToObject( object, "two_core_gen_per_sec", stats.coreGenerationsPerSecond[1] );
+    cJSON_AddBoolToObject( object, COMMAND_NAME_TRACKING, stats.tracking );
+    cJSON_AddNumberToObject( object, "tiles_active", stats.tilesActive );
+    cJSON_AddNumberToObject( object, "tiles_total", CONWAYS_TILES );
+    cJSON_AddNumberToObject( object, "tile_skip_percent", stats.tileSkipPercent );
+    cJSON_AddBoolToObject( object, COMMAND_NAME_PARTIAL, stats.partial );
+    cJSON_AddNumberToObject( object, "flush_bytes", stats.flushBytes );
+    cJSON_AddNumberToObject( object, "flush_bytes_per_frame", stats.flushBytesPerFrame );
+    cJSON_AddNumberToObject( object, "flush_pages", stats.flushPages );
+    cJSON_AddBoolToObject( object, COMMAND_NAME_DMA, stats.dma );
+    cJSON_AddNumberToObject( object, "bus_us", stats.busUs );
+    cJSON_AddNumberToObject( object, "transfer_aborts", stats.transferAborts );
+    cJSON_AddNumberToObject( object, "lock_contentions", stats.lockContentions );
+    cJSON_AddNumberToObject( object, "lock_wait_us", stats.lockWaitUs );
+    cJSON_AddStringToObject( object, COMMAND_NAME_RULE, conways_rules[stats.rule].notation );
+    cJSON_AddNumberToObject( object, "population", stats.population );
+    cJSON_AddBoolToObject( object, "idle", stats.idle );
+    cJSON_AddBoolToObject( object, COMMAND_NAME_WORLD, stats.world );
+    cJSON_AddBoolToObject( object, COMMAND_NAME_WRAP, stats.wrap );
+    cJSON_AddNumberToObject( object, COMMAND_NAME_VIEW_X, stats.viewX );
+    cJSON_AddNumberToObject( object, COMMAND_NAME_VIEW_Y, stats.viewY );
+
+    cJSON *benchmark = cJSON_CreateObject();
+    cJSON_AddNumberToObject( benchmark, "generations", stats.benchmarkGenerations );
+    cJSON_AddNumberToObject( benchmark, "cell_gen_per_sec", stats.benchmarkCellGenerationsPerSecond );
+    cJSON_AddNumberToObject( benchmark, "swar_gen_per_sec", stats.benchmarkSwarGenerationsPerSecond );
+    cJSON_AddBoolToObject( benchmark, "match", stats.benchmarkMatch );
+    cJSON_AddItemToObject( object, COMMAND_NAME_BENCHMARK, benchmark );
+
+    cJSON *advance = cJSON_CreateObject();
+    cJSON_AddNumberToObject( advance, "generations", stats.advanceGenerations );
+    cJSON_AddNumberToObject( advance, "us", stats.advanceUs );
+    cJSON_AddBoolToObject( advance, "failed", stats.advanceFailed );
+    cJSON_AddNumberToObject( advance, "nodes", stats.hashlifeNodes );
+    cJSON_AddNumberToObject( advance, "nodes_total", CONWAYS_HASHLIFE_NODES );
+    cJSON_AddNumberToObject( advance, "collections", stats.hashlifeCollections );
+    cJSON_AddItemToObject( object, COMMAND_NAME_ADVANCE, advance );
+
+    cJSON *cycle = cJSON_CreateObject();
+    cJSON_AddNumberToObject( cycle, "period", stats.cyclePeriod );
+    cJSON_AddNumberToObject( cycle, "generation", stats.cycleGeneration );
+    cJSON_AddNumberToObject( cycle, "count", stats.cycles );
+    cJSON_AddNumberToObject( cycle, "extinctions", stats.extinctions );
+    cJSON_AddItemToObject( object, "cycle", cycle );
+
+    cJSON *pattern = cJSON_CreateObject();
+    cJSON_AddNumberToObject( pattern, "cells", stats.patternCells );
+    cJSON_AddNumberToObject( pattern, "us", stats.patternUs );
+    cJSON_AddItemToObject( object, COMMAND_NAME_PATTERN, pattern );
+
+    cJSON_AddItemToObject( json, COMMAND_NAME_STATS, object );
+
+    return Error::NONE;
+}
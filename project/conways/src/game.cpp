@@ -1,14 +1,147 @@
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/irq.h"
+
+#include "common/logger.h"
+#include "common/drivers/ssd1306_benchmark.h"
+
 #include "project/game.h"
+#include "project/world.h"
+#include "project/hashlife.h"
+#include "project/kernel.h"
+#include "project/rule.h"
+#include "project/pattern.h"
+#include "project/resources.h"
+
+// The kernels work on the display RAM in place
+static_assert(sizeof(ConwaysBoard) == sizeof(SSD1306::DisplayRam), "Board does not match the display RAM");
 
 static SSD1306 *conways_display = nullptr;
+static uint32_t conways_bus_hz = 0;
 static bool reset = false;
-uint32_t speed = 0;
+static volatile bool conways_redraw = false;
+
+static volatile ConwaysEngine conways_engine = CONWAYS_ENGINE_SWAR;
+static volatile uint32_t conways_cores = 1;
+static volatile bool conways_worker_ready = false;
+static volatile bool conways_tracking = true;
+static volatile bool conways_partial = true;
+static volatile bool conways_dma = true;
+static volatile bool conways_overlap = false;
+static volatile uint32_t conways_fps = 0;
+static volatile bool conways_world_enabled = false;
+static volatile bool conways_wrap = true;
+static volatile int32_t conways_view_x = 0;
+static volatile int32_t conways_view_y = 0;
+static volatile uint32_t conways_advance = 0;
+static volatile ConwaysRule conways_rule = CONWAYS_RULE_LIFE;
+static volatile bool conways_pattern_pending = false;
+static volatile uint32_t conways_cycle_period = CONWAYS_CYCLE_PERIOD_DEFAULT;
+static volatile ConwaysCycleAction conways_cycle_action = CONWAYS_CYCLE_IDLE;
+static ConwaysStats conways_stats = {};
+
+static const char *conways_engine_names[CONWAYS_ENGINE_MAX] = {
+    "cell",
+    "swar"
+};
+
+static const char *conways_cycle_action_names[CONWAYS_CYCLE_ACTION_MAX] = {
+    "idle",
+    "reseed"
+};
+
+// Frame rate targets stepped through by the speed button, 0 runs unpaced
+static const uint32_t conways_fps_steps[] = {0, 30, 20, 10, 5};
+static const uint32_t conways_fps_step_count = sizeof(conways_fps_steps) / sizeof(conways_fps_steps[0]);
+
+// Frame deadlines raised by the frame timer. Only the timer writes the count,
+// the game loop keeps track of how many it has consumed.
+static volatile uint32_t conways_frame_ticks = 0;
+static repeating_timer_t conways_frame_timer;
+
+// Game boards live outside of the core1 stack, which is too small to hold both
+static SSD1306::DisplayRamWrite conways_ram[2] = {};
+static ConwaysTiles conways_tiles = {};
+
+// Packed world larger than the display, shown through a viewport
+static ConwaysWorld conways_world[2] = {};
+
+/**
+ * @brief Pattern waiting to be placed by the game loop
+ */
+struct ConwaysPatternRequest {
+    ConwaysPattern pattern;
+    int32_t x;
+    int32_t y;
+    bool clear;
+};
+
+static ConwaysPatternRequest conways_pattern = {};
+
+/**
+ * @brief Hashes of the most recent generations, oldest overwritten first
+ */
+struct ConwaysCycle {
+    uint64_t hashes[CONWAYS_CYCLE_PERIOD_MAX];
+    uint32_t count;         // Generations held
+    uint32_t next;          // Slot the next generation goes to
+};
+
+static ConwaysCycle conways_cycle = {};
+
+// Node pool of the HashLife engine
+static HashLife::Node conways_hashlife_nodes[CONWAYS_HASHLIFE_NODES];
+static uint32_t conways_hashlife_buckets[CONWAYS_HASHLIFE_BUCKETS];
+static HashLife conways_hashlife(conways_hashlife_nodes, CONWAYS_HASHLIFE_NODES, conways_hashlife_buckets,
+                                 CONWAYS_HASHLIFE_BUCKETS, CONWAYS_HASHLIFE_MAX_LEVEL);
+
+/**
+ * @brief Share of a generation handed from core1 to the worker on core0. Jobs
+ * either cover pages of the display board or, when a world is set, bands of
+ * the world.
+ */
+struct ConwaysJob {
+    ConwaysKernel kernel;
+    SSD1306::DisplayRam *ram;
+    SSD1306::DisplayRam *newRam;
+    ConwaysWorld *world;
+    ConwaysWorld *newWorld;
+    bool wrap;
+    ConwaysRule rule;
+    int32_t pageStart;
+    int32_t pageEnd;
+    ConwaysTiles *tiles;
+    uint32_t kernelUs;      // Time core0 spent in the kernel
+};
+
+static ConwaysJob conways_job = {};
+
+// Values passed through the inter-core FIFO
+static const uint32_t conways_job_start = 0xC0DE0001;
+static const uint32_t conways_job_done  = 0xC0DE0002;
+
+// Scratch boards used by the benchmark, one pair per engine
+static SSD1306::DisplayRam conways_benchmark_ram[CONWAYS_ENGINE_MAX][2];
+
+// Bus clocks swept by the bus benchmark, around the 400 kHz the SSD1306 is
+// rated for
+static const uint32_t conways_bus_clocks[] = {100000, 400000, 1000000, 1500000, 2000000};
+#define CONWAYS_BUS_CLOCKS  (sizeof(conways_bus_clocks) / sizeof(conways_bus_clocks[0]))
 
 void conwaysSetDisplay(SSD1306 *display)
 {
     conways_display = display;
 }
 
+/**
+ * @brief Records the clock the display bus was set up with, so it can be put
+ * back after the bus benchmark
+ */
+void conwaysSetBusClock(uint32_t hz)
+{
+    conways_bus_hz = hz;
+}
+
 void conwaysSetReset()
 {
     reset = true;
@@ -18,184 +151,1224 @@ void conwaysStepSpeed()
 {
     static uint32_t step = 0;
 
-    speed = 50000 * step;
-
     step++;
 
-    if(step >= 5) {
+    if(step >= conways_fps_step_count) {
         step = 0;
     }
 
+    conways_fps = conways_fps_steps[step];
+}
+
+/**
+ * @brief Sets the frame rate the game is paced to
+ * @param fps Frames per second, 0 to run as fast as possible
+ * @return 0 on success, -1 if the rate is out of range
+ */
+int32_t conwaysSetFps(uint32_t fps)
+{
+    int32_t error = -1;
+    if(fps <= CONWAYS_FPS_MAX) {
+        conways_fps = fps;
+        error = 0;
+    }
+    return error;
+}
+
+uint32_t conwaysGetFps()
+{
+    return conways_fps;
+}
+
+/**
+ * @brief Sets whether the next generation is computed on core0 while core1
+ * sends the current one to the display. Only available once the worker has
+ * been started on core0.
+ * @param enable True to overlap compute and transfer
+ * @return 0 on success, -1 if the worker is not running
+ */
+int32_t conwaysSetOverlap(bool enable)
+{
+    int32_t error = -1;
+    if(!enable || conways_worker_ready) {
+        conways_overlap = enable;
+        error = 0;
+    }
+    return error;
+}
+
+bool conwaysGetOverlap()
+{
+    return conways_overlap;
+}
+
+/**
+ * @brief Sets whether the game runs on the world instead of the display
+ * board. The world is seeded with a new random board when enabled.
+ */
+void conwaysSetWorld(bool enable)
+{
+    conways_world_enabled = enable;
+}
+
+bool conwaysGetWorld()
+{
+    return conways_world_enabled;
+}
+
+void conwaysSetWrap(bool enable)
+{
+    conways_wrap = enable;
+}
+
+bool conwaysGetWrap()
+{
+    return conways_wrap;
+}
+
+void conwaysSetRule(ConwaysRule rule)
+{
+    if(rule < CONWAYS_RULE_MAX) {
+        conways_rule = rule;
+    }
+}
+
+ConwaysRule conwaysGetRule()
+{
+    return conways_rule;
+}
+
+/**
+ * @brief Sets the longest period cycle detection looks for
+ * @param period Longest period, 0 turns detection off
+ * @return 0 on success, -1 if the period is longer than the history kept
+ */
+int32_t conwaysSetCyclePeriod(uint32_t period)
+{
+    int32_t error = -1;
+    if(period <= CONWAYS_CYCLE_PERIOD_MAX) {
+        conways_cycle_period = period;
+        error = 0;
+    }
+    return error;
+}
+
+uint32_t conwaysGetCyclePeriod()
+{
+    return conways_cycle_period;
+}
+
+void conwaysSetCycleAction(ConwaysCycleAction action)
+{
+    if(action < CONWAYS_CYCLE_ACTION_MAX) {
+        conways_cycle_action = action;
+    }
+}
+
+ConwaysCycleAction conwaysGetCycleAction()
+{
+    return conways_cycle_action;
+}
+
+/**
+ * @brief Hashes the display board and counts its live cells. Two
+ * multiplicative hashes are run side by side so a false match between
+ * boards is out of reach over the life of the game.
+ */
+static uint64_t conwaysRamHash(SSD1306::DisplayRam &ram, uint32_t *population)
+{
+    uint32_t h0 = 0x811C9DC5;
+    uint32_t h1 = 0x9E3779B9;
+    uint32_t cells = 0;
+    for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
+        for(uint32_t column = 0; column < OLED_WIDTH; column++) {
+            uint8_t bits = ram[page][column];
+            h0 = (h0 ^ bits) * 0x01000193;
+            h1 = ((h1 + bits) * 0x85EBCA77) ^ (h1 >> 15);
+            cells += __builtin_popcount(bits);
+        }
+    }
+    *population = cells;
+    return ((uint64_t)h1 << 32) | h0;
+}
+
+static uint64_t conwaysWorldHash(ConwaysWorld &world, uint32_t *population)
+{
+    uint32_t h0 = 0x811C9DC5;
+    uint32_t h1 = 0x9E3779B9;
+    uint32_t cells = 0;
+    for(uint32_t band = 0; band < CONWAYS_WORLD_BANDS; band++) {
+        for(uint32_t column = 0; column < CONWAYS_WORLD_WIDTH; column++) {
+            uint32_t bits = world[band][column];
+            h0 = (h0 ^ bits) * 0x01000193;
+            h1 = ((h1 + bits) * 0x85EBCA77) ^ (h1 >> 15);
+            cells += __builtin_popcount(bits);
+        }
+    }
+    *population = cells;
+    return ((uint64_t)h1 << 32) | h0;
 }
 
+static void conwaysCycleClear(ConwaysCycle *cycle)
+{
+    cycle->count = 0;
+    cycle->next = 0;
+}
+
+/**
+ * @brief Looks for the hash of a generation among the generations before it
+ * and adds it to the history
+ * @param cycle History of recent generations
+ * @param hash Hash of the generation
+ * @param period Longest period to look for
+ * @return Period of the cycle the board is in, 0 if it was not seen within the
+ * period
+ */
+static uint32_t conwaysCycleCheck(ConwaysCycle *cycle, uint64_t hash, uint32_t period)
+{
+    uint32_t found = 0;
+    uint32_t depth = (cycle->count < period) ? cycle->count : period;
+    for(uint32_t back = 1; (back <= depth) && (found == 0); back++) {
+        uint32_t slot = (cycle->next + CONWAYS_CYCLE_PERIOD_MAX - back) % CONWAYS_CYCLE_PERIOD_MAX;
+        if(cycle->hashes[slot] == hash) {
+            found = back;
+        }
+    }
+
+    cycle->hashes[cycle->next] = hash;
+    cycle->next = (cycle->next + 1) % CONWAYS_CYCLE_PERIOD_MAX;
+    if(cycle->count < CONWAYS_CYCLE_PERIOD_MAX) {
+        cycle->count++;
+    }
+
+    return found;
+}
+
+/**
+ * @brief Moves the viewport over the world. Positions outside of the world
+ * wrap around or are clamped to its edges depending on the wrap setting.
+ */
+void conwaysSetView(int32_t viewX, int32_t viewY)
+{
+    conwaysWorldClampView(&viewX, &viewY, conways_wrap);
+    conways_view_x = viewX;
+    conways_view_y = viewY;
+}
+
+void conwaysGetView(int32_t *viewX, int32_t *viewY)
+{
+    *viewX = conways_view_x;
+    *viewY = conways_view_y;
+}
+
+/**
+ * @brief Jumps the game ahead with the HashLife engine. The jump is made by
+ * the game loop before its next frame. The jump is refused, with a warning,
+ * on a world that wraps around.
+ * @param generations Number of generations to jump
+ */
+void conwaysAdvance(uint32_t generations)
+{
+    conways_advance = generations;
+}
+
+static bool conwaysRamGet(void *context, int32_t x, int32_t y)
+{
+    SSD1306::DisplayRam &ram = *static_cast<SSD1306::DisplayRam*>(context);
+    return (ram[y / 8][x] >> (y % 8)) & 0x01;
+}
+
+static void conwaysRamSet(void *context, int32_t x, int32_t y)
+{
+    SSD1306::DisplayRam &ram = *static_cast<SSD1306::DisplayRam*>(context);
+    ram[y / 8][x] |= (1 << (y % 8));
+}
+
+/**
+ * @brief Places a pattern from the pattern library. The pattern is decoded by
+ * the game loop before its next frame.
+ *
+ * @param name Name of the pattern
+ * @param x Column of the top left corner of the pattern, in world coordinates
+ * when a world is set, CONWAYS_PATTERN_CENTER to place it in the middle of the
+ * display
+ * @param y Row of the top left corner of the pattern
+ * @param clear Clears the board before the pattern is placed
+ * @return 0 on success, -1 if the pattern does not exist or the last one has
+ * not been placed yet
+ */
+int32_t conwaysPlacePattern(const char *name, int32_t x, int32_t y, bool clear)
+{
+    int32_t error = -1;
+    if(!conways_pattern_pending &&
+       (conwaysPatternFind(patterns_rle, patterns_rle_size, name, &conways_pattern.pattern) == 0)) {
+        conways_pattern.x = x;
+        conways_pattern.y = y;
+        conways_pattern.clear = clear;
+        conways_pattern_pending = true;
+        error = 0;
+    }
+    return error;
+}
+
+/**
+ * @brief Looks up a pattern of the pattern library by its place in it
+ * @return 0 on success, -1 past the last pattern
+ */
+int32_t conwaysGetPattern(uint32_t index, ConwaysPattern *pattern)
+{
+    return conwaysPatternAt(patterns_rle, patterns_rle_size, index, pattern);
+}
+
+static void conwaysRamRun(void *context, int32_t x, int32_t y, int32_t length)
+{
+    SSD1306::DisplayRam &ram = *static_cast<SSD1306::DisplayRam*>(context);
+    uint8_t *column = &ram[y / 8][x];
+    uint8_t bit = 1 << (y % 8);
+    for(int32_t i = 0; i < length; i++) {
+        column[i] |= bit;
+    }
+}
+
+static void conwaysWorldRun(void *context, int32_t x, int32_t y, int32_t length)
+{
+    ConwaysWorld &world = *static_cast<ConwaysWorld*>(context);
+    uint32_t *column = &world[y / CONWAYS_WORLD_BAND_HEIGHT][x];
+    uint32_t bit = 1 << (y % CONWAYS_WORLD_BAND_HEIGHT);
+    for(int32_t i = 0; i < length; i++) {
+        column[i] |= bit;
+    }
+}
+
+/**
+ * @brief Decodes the pattern requested onto the board or the world
+ * @param ram Display board, used when no world is given
+ * @param world World to place the pattern in, nullptr to use the display board
+ * @param viewX Column of the world shown in the left column of the display
+ * @param viewY Row of the world shown in the top row of the display
+ */
+static void conwaysPatternPlace(SSD1306::DisplayRam &ram, ConwaysWorld *world, int32_t viewX, int32_t viewY)
+{
+    const ConwaysPattern &pattern = conways_pattern.pattern;
+    int32_t x = conways_pattern.x;
+    int32_t y = conways_pattern.y;
+    if(x == CONWAYS_PATTERN_CENTER) {
+        x = (OLED_WIDTH - pattern.width) / 2 + (world ? viewX : 0);
+        y = (OLED_HEIGHT - pattern.height) / 2 + (world ? viewY : 0);
+    }
+
+    uint64_t start = time_us_64();
+    uint32_t cells = 0;
+    if(world) {
+        if(conways_pattern.clear) {
+            memset(*world, 0, sizeof(ConwaysWorld));
+        }
+        cells = conwaysPatternDecode(&pattern, conwaysWorldRun, world, x, y,
+                                     CONWAYS_WORLD_WIDTH, CONWAYS_WORLD_HEIGHT);
+    } else {
+        if(conways_pattern.clear) {
+            memset(ram, 0, sizeof(SSD1306::DisplayRam));
+        }
+        cells = conwaysPatternDecode(&pattern, conwaysRamRun, &ram, x, y, OLED_WIDTH, OLED_HEIGHT);
+    }
+
+    conways_stats.patternCells = cells;
+    conways_stats.patternUs = (uint32_t)(time_us_64() - start);
+}
+
+static bool conwaysWorldGet(void *context, int32_t x, int32_t y)
+{
+    ConwaysWorld &world = *static_cast<ConwaysWorld*>(context);
+    return (world[y / CONWAYS_WORLD_BAND_HEIGHT][x] >> (y % CONWAYS_WORLD_BAND_HEIGHT)) & 0x01;
+}
+
+static void conwaysWorldSet(void *context, int32_t x, int32_t y)
+{
+    ConwaysWorld &world = *static_cast<ConwaysWorld*>(context);
+    world[y / CONWAYS_WORLD_BAND_HEIGHT][x] |= (1 << (y % CONWAYS_WORLD_BAND_HEIGHT));
+}
+
+/**
+ * @brief Moves the board or the world ahead with the HashLife engine. The
+ * engine keeps the cells off the edges dead, so the result matches stepping
+ * the bounded kernels, though patterns that touch an edge slow it down to a
+ * generation at a time. A world that wraps around is turned down, its edges
+ * would not meet. The board is left as it was if the node pool runs out.
+ *
+ * @param generations Number of generations to advance
+ * @param ram Display board, used when no world is given
+ * @param world World to advance, nullptr to advance the display board
+ * @param wrap Whether the world wraps around
+ * @return Number of generations advanced
+ */
+static uint32_t conwaysHashLifeAdvance(uint32_t generations, SSD1306::DisplayRam &ram, ConwaysWorld *world,
+                                       bool wrap)
+{
+    uint64_t start = time_us_64();
+
+    if(world && wrap) {
+        LOG_WARN("HashLife cannot advance a wrapping world, turn wrap off first\n");
+        conways_stats.advanceGenerations = 0;
+        conways_stats.advanceUs = 0;
+        conways_stats.advanceFailed = true;
+        return 0;
+    }
+
+    ConwaysRule rule = conways_rule;
+    // Rules that bring empty space to life are turned down by the engine
+    int32_t error = conways_hashlife.setRule(conways_rules[rule].birth, conways_rules[rule].survive);
+    if(error == 0) {
+        if(world) {
+            error = conways_hashlife.load(conwaysWorldGet, world, CONWAYS_WORLD_WIDTH, CONWAYS_WORLD_HEIGHT,
+                                          true);
+        } else {
+            error = conways_hashlife.load(conwaysRamGet, &ram, OLED_WIDTH, OLED_HEIGHT, true);
+        }
+    }
+
+    if(error == 0) {
+        error = conways_hashlife.advance(generations);
+    }
+
+    if(error == 0) {
+        if(world) {
+            memset(*world, 0, sizeof(ConwaysWorld));
+            conways_hashlife.render(conwaysWorldSet, world, CONWAYS_WORLD_WIDTH, CONWAYS_WORLD_HEIGHT);
+        } else {
+            memset(ram, 0, sizeof(SSD1306::DisplayRam));
+            conways_hashlife.render(conwaysRamSet, &ram, OLED_WIDTH, OLED_HEIGHT);
+        }
+    } else {
+        LOG_WARN("HashLife stopped after %llu generations of %s\n", conways_hashlife.generation(),
+                 conways_rules[rule].notation);
+    }
+
+    conways_stats.advanceGenerations = (error == 0) ? generations : 0;
+    conways_stats.advanceUs = (uint32_t)(time_us_64() - start);
+    conways_stats.advanceFailed = (error != 0);
+    conways_stats.hashlifeNodes = conways_hashlife.nodesUsed();
+    conways_stats.hashlifeCollections = conways_hashlife.collections();
+
+    return (error == 0) ? generations : 0;
+}
+
+void conwaysSetEngine(ConwaysEngine engine)
+{
+    if(engine < CONWAYS_ENGINE_MAX) {
+        conways_engine = engine;
+    }
+}
+
+ConwaysEngine conwaysGetEngine()
+{
+    return conways_engine;
+}
+
+/**
+ * @brief Sets how many cores share the work of each generation. Two cores
+ * are only available once the worker has been started on core0.
+ * @param cores Number of cores, 1 or 2
+ * @return 0 on success, -1 if the core count is not available
+ */
+int32_t conwaysSetCores(uint32_t cores)
+{
+    int32_t error = -1;
+    if((cores == 1) || (cores == CONWAYS_MAX_CORES && conways_worker_ready)) {
+        conways_cores = cores;
+        error = 0;
+    }
+    return error;
+}
+
+uint32_t conwaysGetCores()
+{
+    return conways_cores;
+}
+
+void conwaysSetTracking(bool enable)
+{
+    conways_tracking = enable;
+}
+
+bool conwaysGetTracking()
+{
+    return conways_tracking;
+}
+
+void conwaysSetPartial(bool enable)
+{
+    conways_partial = enable;
+}
+
+bool conwaysGetPartial()
+{
+    return conways_partial;
+}
+
+/**
+ * @brief Sends frames to the display through DMA, so the bus runs while the
+ * next generation is computed
+ * @return 0 on success, -1 if the display cannot do DMA transfers
+ */
+int32_t conwaysSetDma(bool enable)
+{
+    int32_t error = 0;
+    if(enable && ((conways_display == nullptr) || !conways_display->dma_ready())) {
+        error = -1;
+    } else {
+        conways_dma = enable;
+    }
+    return error;
+}
+
+bool conwaysGetDma()
+{
+    return conways_dma && (conways_display != nullptr) && conways_display->dma_ready();
+}
+
+/**
+ * @brief Services generation work sent from core1. Runs in the FIFO interrupt
+ * on core0, so the console loop is only interrupted for the duration of the
+ * job and never has to poll for it.
+ */
+static void conwaysWorkerIrq()
+{
+    while(multicore_fifo_rvalid()) {
+        if(multicore_fifo_pop_blocking() == conways_job_start) {
+            uint64_t start = time_us_64();
+            if(conways_job.world) {
+                conwaysWorldStep(*conways_job.world, *conways_job.newWorld, conways_job.wrap, conways_job.rule,
+                                 conways_job.pageStart, conways_job.pageEnd);
+            } else {
+                conways_job.kernel(*conways_job.ram, *conways_job.newRam, false,
+                                   conways_job.pageStart, conways_job.pageEnd, conways_job.tiles);
+            }
+            conways_job.kernelUs = (uint32_t)(time_us_64() - start);
+            multicore_fifo_push_blocking(conways_job_done);
+        }
+    }
+    multicore_fifo_clear_irq();
+}
+
+/**
+ * @brief Starts the generation worker. Must be called from core0 once core1
+ * has been launched, since launching core1 makes use of the FIFO as well.
+ */
+void conwaysStartWorker()
+{
+    irq_set_exclusive_handler(SIO_IRQ_PROC0, conwaysWorkerIrq);
+    irq_set_enabled(SIO_IRQ_PROC0, true);
+    conways_worker_ready = true;
+}
+
+/**
+ * @brief Hands a range of pages of the next generation to core0
+ */
+static void conwaysJobStart(ConwaysKernel kernel, SSD1306::DisplayRam &ram, SSD1306::DisplayRam &newRam,
+                            int32_t pageStart, int32_t pageEnd, ConwaysTiles *tiles)
+{
+    conways_job.kernel = kernel;
+    conways_job.ram = &ram;
+    conways_job.newRam = &newRam;
+    conways_job.world = nullptr;
+    conways_job.newWorld = nullptr;
+    conways_job.pageStart = pageStart;
+    conways_job.pageEnd = pageEnd;
+    conways_job.tiles = tiles;
+    multicore_fifo_push_blocking(conways_job_start);
+}
+
+/**
+ * @brief Hands a range of bands of the next world generation to core0
+ */
+static void conwaysWorldJobStart(ConwaysWorld &world, ConwaysWorld &newWorld, bool wrap, ConwaysRule rule,
+                                 int32_t bandStart, int32_t bandEnd)
+{
+    conways_job.world = &world;
+    conways_job.newWorld = &newWorld;
+    conways_job.wrap = wrap;
+    conways_job.rule = rule;
+    conways_job.pageStart = bandStart;
+    conways_job.pageEnd = bandEnd;
+    multicore_fifo_push_blocking(conways_job_start);
+}
+
+/**
+ * @brief Waits for core0 to finish the job handed to it
+ * @return Time core0 spent in the kernel
+ */
+static uint32_t conwaysJobWait()
+{
+    while(multicore_fifo_pop_blocking() != conways_job_done) {
+    }
+    return conways_job.kernelUs;
+}
+
+/**
+ * @brief Raised by the alarm pool at every frame deadline. Wakes core1 should
+ * it be waiting for the deadline.
+ */
+static bool conwaysFrameTimer(repeating_timer_t *timer)
+{
+    conways_frame_ticks++;
+    __sev();
+    return true;
+}
+
+/**
+ * @brief Simulates one generation, splitting the pages between both cores
+ * when enabled. Core0 takes the lower half of the pages while core1 works on
+ * the upper half, the FIFO acting as the barrier at the end of the generation.
+ */
+static void conwaysGeneration(ConwaysKernel kernel, SSD1306::DisplayRam &ram, SSD1306::DisplayRam &newRam,
+                              uint32_t cores, ConwaysTiles *tiles)
+{
+    if(cores == CONWAYS_MAX_CORES) {
+        int32_t split = OLED_PAGE_HEIGHT / 2;
+        conwaysJobStart(kernel, ram, newRam, split, OLED_PAGE_HEIGHT, tiles);
+
+        kernel(ram, newRam, false, 0, split, tiles);
+
+        // Wait for core0 to finish its half
+        conwaysJobWait();
+    } else {
+        kernel(ram, newRam, false, 0, OLED_PAGE_HEIGHT, tiles);
+    }
+}
+
+const char *conwaysEngineName(ConwaysEngine engine)
+{
+    const char *name = nullptr;
+    if(engine < CONWAYS_ENGINE_MAX) {
+        name = conways_engine_names[engine];
+    }
+    return name;
+}
+
+void conwaysGetStats(ConwaysStats *stats)
+{
+    *stats = conways_stats;
+}
+
+/**
+ * @brief Runs every engine over the same random board and reports the
+ * generation rate of each. The boards are compared afterwards to make sure
+ * the engines agree.
+ *
+ * @param generations Number of generations to simulate per engine
+ */
+void conwaysBenchmark(uint32_t generations)
+{
+    uint32_t rates[CONWAYS_ENGINE_MAX] = {};
+    SSD1306::DisplayRam *result[CONWAYS_ENGINE_MAX] = {};
+
+    conways_display->fill_display_random(conways_benchmark_ram[0][0]);
+    for(uint32_t engine = 1; engine < CONWAYS_ENGINE_MAX; engine++) {
+        memcpy(conways_benchmark_ram[engine][0], conways_benchmark_ram[0][0], sizeof(SSD1306::DisplayRam));
+    }
+
+    for(uint32_t engine = 0; engine < CONWAYS_ENGINE_MAX; engine++) {
+        SSD1306::DisplayRam *cur = &conways_benchmark_ram[engine][0];
+        SSD1306::DisplayRam *nxt = &conways_benchmark_ram[engine][1];
+
+        uint64_t start = time_us_64();
+        for(uint32_t gen = 0; gen < generations; gen++) {
+            conwaysGetKernel((ConwaysEngine)engine, CONWAYS_RULE_LIFE)(*cur, *nxt, false, 0, OLED_PAGE_HEIGHT, nullptr);
+            SSD1306::DisplayRam *temp = cur;
+            cur = nxt;
+            nxt = temp;
+        }
+        uint64_t elapsed = time_us_64() - start;
+
+        rates[engine] = (elapsed > 0) ? (uint32_t)((generations * 1000000ULL) / elapsed) : 0;
+        result[engine] = cur;
+        LOG_INFO("%s: %d generations in %llu us, %d gen/s\n", conways_engine_names[engine],
+                 generations, elapsed, rates[engine]);
+    }
+
+    bool match = true;
+    for(uint32_t engine = 1; engine < CONWAYS_ENGINE_MAX; engine++) {
+        if(memcmp(*result[0], *result[engine], sizeof(SSD1306::DisplayRam)) != 0) {
+            LOG_WARN("%s does not match %s\n", conways_engine_names[engine], conways_engine_names[0]);
+            match = false;
+        }
+    }
+
+    conways_stats.benchmarkGenerations = generations;
+    conways_stats.benchmarkCellGenerationsPerSecond = rates[CONWAYS_ENGINE_CELL];
+    conways_stats.benchmarkSwarGenerationsPerSecond = rates[CONWAYS_ENGINE_SWAR];
+    conways_stats.benchmarkMatch = match;
+}
+
+/**
+ * @brief Times full frames and single pages over the display bus at each
+ * clock and transfer strategy, and prints the results. The game waits for
+ * the display meanwhile and redraws it in full afterwards.
+ *
+ * @param repeats Transfers timed for each measurement
+ */
+void conwaysBusBenchmark(uint32_t repeats)
+{
+    if(conways_display == nullptr) {
+        return;
+    }
+
+    ssd1306_benchmark_result results[CONWAYS_BUS_CLOCKS * SSD1306_BENCHMARK_STRATEGIES];
+    uint32_t count = ssd1306_benchmark_run(conways_display, conways_bus_clocks, CONWAYS_BUS_CLOCKS,
+                                           conways_bus_hz, repeats, results,
+                                           sizeof(results) / sizeof(results[0]));
+    conways_redraw = true;
+    ssd1306_benchmark_print(results, count);
+}
+
+/**
+ * @brief Simulates one generation of the world, splitting the bands between
+ * both cores when enabled
+ */
+static void conwaysWorldGeneration(ConwaysWorld &world, ConwaysWorld &newWorld, bool wrap, ConwaysRule rule,
+                                   uint32_t cores)
+{
+    if(cores == CONWAYS_MAX_CORES) {
+        int32_t split = CONWAYS_WORLD_BANDS / 2;
+        conwaysWorldJobStart(world, newWorld, wrap, rule, split, CONWAYS_WORLD_BANDS);
+        conwaysWorldStep(world, newWorld, wrap, rule, 0, split);
+        conwaysJobWait();
+    } else {
+        conwaysWorldStep(world, newWorld, wrap, rule);
+    }
+}
+
+/**
+ * @brief Game loop, runs on core1. Each frame presents the generation computed
+ * in the previous frame and then computes the next one from it, which lets
+ * core0 take the computation while core1 is busy sending the frame. When a
+ * frame rate is set, frames start on the deadlines raised by the frame timer
+ * so the rate does not depend on how busy the board or the bus is.
+ */
 void conwaysRun()
 {
-    SSD1306::DisplayRamWrite ram[2];
-    conways_display->fill_display_random(ram[0].ram);
-    conways_display->write_buffer(ram[0]);
+    SSD1306::DisplayRamWrite *ram = conways_ram;
+    bool fullFlush = true;
 
     uint32_t gen = 0;
+    // Generation waiting to be displayed
     SSD1306::DisplayRamWrite *cur = &ram[0];
+    // Generation on the display, the next generation is computed into it
     SSD1306::DisplayRamWrite *nxt = &ram[1];
+    conways_display->fill_display_random(cur->ram);
 
-    do {
-        if(reset) {
-            conways_display->fill_display_random(ram[0].ram);
-            conways_display->write_buffer(ram[0]);
+    // Frame pacing
+    uint32_t timerFps = 0;
+    uint32_t ticksTaken = 0;
+    uint32_t missed = 0;
+
+    // Generation rate is measured over windows of roughly one second
+    uint64_t windowStart = time_us_64();
+    uint64_t windowKernelUs = 0;
+    uint32_t windowGenerations = 0;
+    uint32_t windowCores = conways_cores;
+    uint32_t windowFps = timerFps;
+    bool windowOverlap = conways_overlap;
+    bool windowWorld = false;
+    uint32_t windowTiles = 0;
+    uint32_t windowFlushBytes = 0;
+
+    // World shown through the viewport, used in place of the display board
+    bool worldMode = false;
+    ConwaysWorld *world = &conways_world[0];
+    ConwaysWorld *newWorld = &conways_world[1];
+
+    ConwaysRule lastRule = conways_rule;
+
+    // Cycle detection, the history only holds while nothing but the game
+    // itself changes the board
+    bool idle = false;
+    ConwaysRule cycleRule = lastRule;
+    bool cycleWrap = conways_wrap;
+    uint32_t cyclePeriod = conways_cycle_period;
+    int32_t cycleViewX = conways_view_x;
+    int32_t cycleViewY = conways_view_y;
+    conwaysCycleClear(&conways_cycle);
 
+    // Nothing is known about the previous generation yet
+    conwaysTilesMarkAll(&conways_tiles);
+
+    do {
+        bool wrap = conways_wrap;
+        if(reset || (conways_world_enabled != worldMode)) {
+            worldMode = conways_world_enabled;
             gen = 0;
             cur = &ram[0];
             nxt = &ram[1];
+            if(worldMode) {
+                conwaysWorldRandom(*world);
+                conwaysWorldView(*world, cur->ram, conways_view_x, conways_view_y, wrap);
+            } else {
+                conways_display->fill_display_random(cur->ram);
+            }
+            conwaysTilesMarkAll(&conways_tiles);
+            conwaysCycleClear(&conways_cycle);
+            idle = false;
+            fullFlush = true;
             reset = false;
         }
 
-        // Simulate the new generation
-        // printf("Generation: %d\n", gen++);
-        checkRamBoard(cur->ram, nxt->ram, false);
+        if(conways_redraw) {
+            // The display was drawn over, the frame on it is no longer known
+            fullFlush = true;
+            idle = false;
+            conways_redraw = false;
+        }
+
+        uint32_t advance = conways_advance;
+        if(advance > 0) {
+            conways_advance = 0;
+            gen += conwaysHashLifeAdvance(advance, cur->ram, worldMode ? world : nullptr, wrap);
+            if(worldMode) {
+                conwaysWorldView(*world, cur->ram, conways_view_x, conways_view_y, wrap);
+            }
+            conwaysTilesMarkAll(&conways_tiles);
+            conwaysCycleClear(&conways_cycle);
+            idle = false;
+        }
 
-        // Print the current generation and the board
-        conways_display->write_buffer(*nxt);
+        if(conways_pattern_pending) {
+            conwaysPatternPlace(cur->ram, worldMode ? world : nullptr, conways_view_x, conways_view_y);
+            if(conways_pattern.clear) {
+                gen = 0;
+            }
+            if(worldMode) {
+                conwaysWorldView(*world, cur->ram, conways_view_x, conways_view_y, wrap);
+            }
+            conwaysTilesMarkAll(&conways_tiles);
+            conwaysCycleClear(&conways_cycle);
+            idle = false;
+            conways_pattern_pending = false;
+        }
+
+        // A board that repeats under one rule need not under another
+        ConwaysRule rule = conways_rule;
+        uint32_t period = conways_cycle_period;
+        if((rule != cycleRule) || (wrap != cycleWrap) || (period != cyclePeriod)) {
+            conwaysCycleClear(&conways_cycle);
+            idle = false;
+            cycleRule = rule;
+            cycleWrap = wrap;
+            cyclePeriod = period;
+        }
+        if((conways_view_x != cycleViewX) || (conways_view_y != cycleViewY)) {
+            // The world is unchanged, a frame is only needed to show the new
+            // viewport before the repeat is found again
+            idle = false;
+            cycleViewX = conways_view_x;
+            cycleViewY = conways_view_y;
+        }
+
+        uint32_t fps = conways_fps;
+        if(fps != timerFps) {
+            if(timerFps > 0) {
+                cancel_repeating_timer(&conways_frame_timer);
+            }
+            if(fps > 0) {
+                // A negative delay keeps the period from start to start
+                add_repeating_timer_us(-(int64_t)(1000000 / fps), conwaysFrameTimer, nullptr,
+                                       &conways_frame_timer);
+            }
+            ticksTaken = conways_frame_ticks;
+            timerFps = fps;
+        }
+
+        if(idle) {
+            // The board repeats, so there is nothing to compute or send until
+            // it is changed from the console
+            conways_stats.idle = true;
+            if(conways_cycle_action == CONWAYS_CYCLE_RESEED) {
+                reset = true;
+            } else {
+                sleep_ms(CONWAYS_IDLE_POLL_MS);
+            }
+            // Deadlines passed while idle are not missed frames
+            ticksTaken = conways_frame_ticks;
+            continue;
+        }
+        conways_stats.idle = false;
+
+        if(timerFps > 0) {
+            // Sleep until the next deadline. Deadlines that passed while the
+            // last frame was still being worked on are dropped and counted.
+            while(conways_frame_ticks == ticksTaken) {
+                __wfe();
+            }
+            uint32_t ticks = conways_frame_ticks;
+            missed += ticks - ticksTaken - 1;
+            ticksTaken = ticks;
+        }
+        uint64_t frameStart = time_us_64();
+
+        // Skipping a tile leaves the board from two generations ago in place,
+        // which only holds while the tiles are tracked every generation
+        bool tracking = conways_tracking;
+        if(!tracking) {
+            conwaysTilesMarkAll(&conways_tiles);
+        }
+
+        // Tiles that were stable under the last rule need not be under this one
+        if(rule != lastRule) {
+            conwaysTilesMarkAll(&conways_tiles);
+            lastRule = rule;
+        }
+
+        uint32_t cores = conways_cores;
+        bool overlap = conways_overlap;
+        if((cores != windowCores) || (timerFps != windowFps) || (overlap != windowOverlap) ||
+           (worldMode != windowWorld)) {
+            // Start a new measurement so the rates of each mode are kept apart
+            windowStart = time_us_64();
+            windowKernelUs = 0;
+            windowGenerations = 0;
+            windowTiles = 0;
+            windowFlushBytes = 0;
+            windowCores = cores;
+            windowFps = timerFps;
+            windowOverlap = overlap;
+            windowWorld = worldMode;
+        }
+
+        // The board on its way to the display is looked up among the last
+        // generations. What to do about a repeat is left to the next frame,
+        // so the final board is still shown.
+        uint32_t population = 0;
+        uint64_t hash = worldMode ? conwaysWorldHash(*world, &population) : conwaysRamHash(cur->ram, &population);
+        if(period > 0) {
+            uint32_t found = (population == 0) ? 1 : conwaysCycleCheck(&conways_cycle, hash, period);
+            if(found > 0) {
+                conways_stats.cyclePeriod = found;
+                conways_stats.cycleGeneration = gen;
+                conways_stats.cycles++;
+                if(population == 0) {
+                    conways_stats.extinctions++;
+                }
+                if(conways_cycle_action == CONWAYS_CYCLE_RESEED) {
+                    reset = true;
+                } else {
+                    idle = true;
+                }
+            }
+        }
+        conways_stats.population = population;
+
+        // Work out what changed on the display before the next generation is
+        // computed over the frame it currently shows
+        bool partial = conways_partial;
+        bool dma = conwaysGetDma();
+        SSD1306::FlushPlan plan;
+        conways_display->plan_flush(cur->ram, nxt->ram, partial && !fullFlush, &plan);
+        fullFlush = false;
+
+        ConwaysKernel kernel = conwaysGetKernel(conways_engine, rule);
+        uint32_t kernelUs = 0;
+        uint32_t transferUs = 0;
+        uint32_t flushBytes = 0;
+        uint64_t transferStart = 0;
+        if(overlap) {
+            // Core0 computes the next generation while the current one is sent
+            if(worldMode) {
+                conwaysWorldJobStart(*world, *newWorld, wrap, rule, 0, CONWAYS_WORLD_BANDS);
+            } else {
+                conwaysJobStart(kernel, cur->ram, nxt->ram, 0, OLED_PAGE_HEIGHT, &conways_tiles);
+            }
+
+            transferStart = time_us_64();
+            flushBytes = conways_display->flush(*cur, plan, dma);
+            transferUs = (uint32_t)(time_us_64() - transferStart);
+
+            kernelUs = conwaysJobWait();
+        } else {
+            transferStart = time_us_64();
+            flushBytes = conways_display->flush(*cur, plan, dma);
+            transferUs = (uint32_t)(time_us_64() - transferStart);
+
+            uint64_t kernelStart = time_us_64();
+            if(worldMode) {
+                conwaysWorldGeneration(*world, *newWorld, wrap, rule, cores);
+            } else {
+                conwaysGeneration(kernel, cur->ram, nxt->ram, cores, &conways_tiles);
+            }
+            kernelUs = (uint32_t)(time_us_64() - kernelStart);
+        }
+
+        uint32_t tilesActive = CONWAYS_TILES;
+        if(worldMode) {
+            // The frame on display has been sent, the viewport of the new
+            // generation takes its place
+            ConwaysWorld *temp = world;
+            world = newWorld;
+            newWorld = temp;
+            conwaysWorldView(*world, nxt->ram, conways_view_x, conways_view_y, wrap);
+        } else {
+            tilesActive = conwaysTilesUpdate(&conways_tiles);
+        }
         // printRamBoard(nxt->ram);
 
         // Next board becomes the current and the current becomes the container for
-        // our next generation
+        // our next generation. Every kernel writes the whole board, so there is
+        // no need to clear it first.
         SSD1306::DisplayRamWrite *temp = cur;
         cur = nxt;
         nxt = temp;
-        conways_display->fill_display(nxt->ram);
 
-        // Sleep so the results are easily viewable
-        sleep_us(speed);
+        gen++;
+        windowGenerations++;
+        windowKernelUs += kernelUs;
+        windowTiles += tilesActive;
+        windowFlushBytes += flushBytes;
+        conways_stats.generation = gen;
+        conways_stats.kernelUs = kernelUs;
+        conways_stats.transferUs = transferUs;
+        conways_stats.frameUs = (uint32_t)(time_us_64() - frameStart);
+        conways_stats.fps = timerFps;
+        conways_stats.overlap = overlap;
+        conways_stats.missedFrames = missed;
+        conways_stats.cores = cores;
+        conways_stats.tracking = tracking;
+        conways_stats.tilesActive = tilesActive;
+        conways_stats.partial = partial;
+        conways_stats.flushBytes = flushBytes;
+        conways_stats.flushPages = plan.pages;
+        conways_stats.dma = dma;
+        conways_stats.busUs = conways_display->transfer_us();
+        conways_stats.transferAborts = conways_display->transfer_aborts();
+        SSD1306::LockStats lockStats;
+        conways_display->get_lock_stats(&lockStats);
+        conways_stats.lockContentions = lockStats.contentions;
+        conways_stats.lockWaitUs = lockStats.wait_us;
+        conways_stats.rule = rule;
+        conways_stats.world = worldMode;
+        conways_stats.wrap = wrap;
+        conways_stats.viewX = conways_view_x;
+        conways_stats.viewY = conways_view_y;
+
+        uint64_t now = time_us_64();
+        if((now - windowStart) >= 1000000) {
+            conways_stats.generationsPerSecond = (uint32_t)((windowGenerations * 1000000ULL) / (now - windowStart));
+            conways_stats.kernelGenerationsPerSecond = (windowKernelUs > 0) ?
+                (uint32_t)((windowGenerations * 1000000ULL) / windowKernelUs) : 0;
+            // Overlapped generations are computed by core0 alone
+            if(!worldMode) {
+                conways_stats.coreGenerationsPerSecond[overlap ? 0 : (cores - 1)] =
+                    conways_stats.kernelGenerationsPerSecond;
+            }
+            conways_stats.tileSkipPercent = 100 - ((windowTiles * 100) / (windowGenerations * CONWAYS_TILES));
+            conways_stats.flushBytesPerFrame = windowFlushBytes / windowGenerations;
+            windowStart = now;
+            windowKernelUs = 0;
+            windowGenerations = 0;
+            windowTiles = 0;
+            windowFlushBytes = 0;
+        }
     } while(true);
+}
 
+/**
+ * @brief Construct a new Conways control object
+ */
+Conways::Conways()
+{
 
 }
 
-void printRamBoard(SSD1306::DisplayRam &ram)
+/**
+ * @brief Selects the engine used to simulate each generation
+ * @param name Name of the desired engine
+ * @return 0 on success, -1 if the engine does not exist
+ */
+int32_t Conways::setEngine(const char *name)
 {
-    for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
-        for(uint32_t shift = 0; shift < 8; shift++) {
-            uint32_t bit = 1 << shift;
-            for(uint32_t column = 0; column < OLED_WIDTH; column++) {
-                if((ram[page][column] & bit) == 0) {
-                    printf("  ");
-                } else {
-                    // printf("%01X ", ram[page][column] & 0xF);
-                    printf("o ");
-                }
-            }
-            printf("\n");
+    int32_t error = -1;
+    for(uint32_t engine = 0; engine < CONWAYS_ENGINE_MAX; engine++) {
+        if(strcmp(name, conways_engine_names[engine]) == 0) {
+            conwaysSetEngine((ConwaysEngine)engine);
+            error = 0;
         }
     }
+    return error;
 }
 
-void checkRamBoardNew(SSD1306::DisplayRam &ram, SSD1306::DisplayRam &newRam, bool debug)
+const char *Conways::engine()
 {
-    for(int32_t page = 0; page < OLED_NUM_PAGES; page++) {
-        for(int32_t shift = 0; shift < OLED_PAGE_HEIGHT; shift++) {
-            for(int32_t column = 0; column < OLED_WIDTH; column++) {
-            }
-        }
-    }
+    return conwaysEngineName(conwaysGetEngine());
 }
 
-void checkRamBoard(SSD1306::DisplayRam &ram, SSD1306::DisplayRam &newRam, bool debug)
+int32_t Conways::setCores(uint32_t cores)
 {
-    int32_t column_bits = 8;
-    for(int32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
-        for(int32_t shift = 0; shift < column_bits; shift++) {
-            uint8_t bit = 1 << shift;
-            for(int32_t column = 0; column < OLED_WIDTH; column++) {
-                int32_t neighbors = 0;
-                bool leftValid = false;
-                bool rightValid = false;
-                bool upValid = false;
-                bool upperPage = false;
-                bool downValid = false;
-                bool lowerPage = false;
+    return conwaysSetCores(cores);
+}
 
-                if((column - 1) >= 0) {
-                    // Check left
-                    neighbors += ((ram[page][column - 1] & bit) > 0);
-                    leftValid = true;
-                }
+uint32_t Conways::cores()
+{
+    return conwaysGetCores();
+}
 
-                if((column + 1) < OLED_WIDTH) {
-                    // Check right
-                    neighbors += ((ram[page][column + 1] & bit) > 0);
-                    rightValid = true;
-                }
+void Conways::setTracking(bool enable)
+{
+    conwaysSetTracking(enable);
+}
 
-                if((shift - 1) >= 0) {
-                    // Check up
-                    neighbors += ((ram[page][column] & (1 << (shift - 1))) > 0);
-                    upValid = true;
-                } else if((page - 1) >= 0) {
-                    // If there is another page before this one, check the last
-                    // bit in that column
-                    neighbors += ((ram[page - 1][column] & (1 << (column_bits - 1))) > 0);
-                    upValid = true;
-                    upperPage = true;
-                }
+bool Conways::tracking()
+{
+    return conwaysGetTracking();
+}
 
-                if((shift + 1) < column_bits) {
-                    // Check down
-                    neighbors += ((ram[page][column] & (1 << (shift + 1))) > 0);
-                    downValid = true;
-                } else if((page + 1) < OLED_PAGE_HEIGHT) {
-                    // If there is another page after this one, check the first
-                    // bit in that column
-                    neighbors += ((ram[page + 1][column] & (1 << 0)) > 0);
-                    downValid = true;
-                    lowerPage = true;
-                }
+int32_t Conways::setDma(bool enable)
+{
+    return conwaysSetDma(enable);
+}
 
-                if(leftValid && upValid) {
-                    if(upperPage) {
-                        neighbors += ((ram[page - 1][column - 1] & (1 << (column_bits - 1))) > 0);
-                    } else {
-                        neighbors += ((ram[page][column - 1] & (1 << (shift - 1))) > 0);
-                    }
-                }
+bool Conways::dma()
+{
+    return conwaysGetDma();
+}
 
-                if(rightValid && upValid) {
-                    if(upperPage) {
-                        neighbors += ((ram[page - 1][column + 1] & (1 << (column_bits - 1))) > 0);
-                    } else {
-                        neighbors += ((ram[page][column + 1] & (1 << (shift - 1))) > 0);
-                    }
-                }
+void Conways::setPartial(bool enable)
+{
+    conwaysSetPartial(enable);
+}
 
-                if(rightValid && downValid) {
-                    if(lowerPage) {
-                        neighbors += ((ram[page + 1][column + 1] & (1 << 0)) > 0);
-                    } else {
-                        neighbors += ((ram[page][column + 1] & (1 << (shift + 1))) > 0);
-                    }
-                }
+bool Conways::partial()
+{
+    return conwaysGetPartial();
+}
 
-                if(leftValid && downValid) {
-                    if(lowerPage) {
-                        neighbors += ((ram[page + 1][column - 1] & (1 << 0)) > 0);
-                    } else {
-                        neighbors += ((ram[page][column - 1] & (1 << (shift + 1))) > 0);
-                    }
-                }
+int32_t Conways::setFps(uint32_t fps)
+{
+    return conwaysSetFps(fps);
+}
 
-                if(debug){ printf("%d", neighbors); }
-                if(neighbors == 2) {
-                    // Cell survives
-                    newRam[page][column] |= (ram[page][column] & bit);
-                } else if(neighbors == 3) {
-                    // Cell survives / becomes living
-                    newRam[page][column] |= bit;
-                } else {
-                    // Cell dies
-                    newRam[page][column] &= ~bit;
-                }
-                if(debug){ printf("."); }
-            }
-            if(debug){ printf("\n"); }
+uint32_t Conways::fps()
+{
+    return conwaysGetFps();
+}
+
+/**
+ * @brief Selects the rule the cells follow
+ * @param name Name of the rule or its B/S notation
+ * @return 0 on success, -1 if the rule does not exist
+ */
+int32_t Conways::setRule(const char *name)
+{
+    int32_t error = -1;
+    for(uint32_t rule = 0; rule < CONWAYS_RULE_MAX; rule++) {
+        if((strcmp(name, conways_rules[rule].name) == 0) || (strcmp(name, conways_rules[rule].notation) == 0)) {
+            conwaysSetRule((ConwaysRule)rule);
+            error = 0;
         }
     }
+    return error;
+}
+
+const char *Conways::rule()
+{
+    return conways_rules[conwaysGetRule()].name;
+}
+
+int32_t Conways::setCyclePeriod(uint32_t period)
+{
+    return conwaysSetCyclePeriod(period);
+}
+
+uint32_t Conways::cyclePeriod()
+{
+    return conwaysGetCyclePeriod();
+}
+
+/**
+ * @brief Selects what the game does once the board repeats
+ * @param name Name of the action
+ * @return 0 on success, -1 if the action does not exist
+ */
+int32_t Conways::setCycleAction(const char *name)
+{
+    int32_t error = -1;
+    for(uint32_t action = 0; action < CONWAYS_CYCLE_ACTION_MAX; action++) {
+        if(strcmp(name, conways_cycle_action_names[action]) == 0) {
+            conwaysSetCycleAction((ConwaysCycleAction)action);
+            error = 0;
+        }
+    }
+    return error;
+}
+
+const char *Conways::cycleAction()
+{
+    return conways_cycle_action_names[conwaysGetCycleAction()];
+}
+
+void Conways::advance(uint32_t generations)
+{
+    conwaysAdvance(generations);
+}
+
+int32_t Conways::placePattern(const char *name, int32_t x, int32_t y, bool clear)
+{
+    return conwaysPlacePattern(name, x, y, clear);
+}
+
+int32_t Conways::pattern(uint32_t index, ConwaysPattern *pattern)
+{
+    return conwaysGetPattern(index, pattern);
+}
+
+void Conways::setWorld(bool enable)
+{
+    conwaysSetWorld(enable);
+}
+
+bool Conways::world()
+{
+    return conwaysGetWorld();
+}
+
+void Conways::setWrap(bool enable)
+{
+    conwaysSetWrap(enable);
+}
+
+bool Conways::wrap()
+{
+    return conwaysGetWrap();
+}
+
+void Conways::setView(int32_t viewX, int32_t viewY)
+{
+    conwaysSetView(viewX, viewY);
+}
+
+void Conways::view(int32_t *viewX, int32_t *viewY)
+{
+    conwaysGetView(viewX, viewY);
+}
+
+int32_t Conways::setOverlap(bool enable)
+{
+    return conwaysSetOverlap(enable);
+}
+
+bool Conways::overlap()
+{
+    return conwaysGetOverlap();
+}
+
+void Conways::stats(ConwaysStats *stats)
+{
+    conwaysGetStats(stats);
+}
+
+void Conways::benchmark(uint32_t generations)
+{
+    conwaysBenchmark(generations);
+}
+
+void Conways::busBenchmark(uint32_t repeats)
+{
+    conwaysBusBenchmark(repeats);
 }
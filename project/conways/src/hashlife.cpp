@@ -0,0 +1,823 @@
+#include "project/hashlife.h"
+
+// Marks a result that has not been computed yet
+static const uint8_t hashlife_no_step = 0xFF;
+
+HashLife::HashLife(Node *nodes, uint32_t capacity, uint32_t *buckets, uint32_t bucketCount, uint32_t maxLevel)
+    : mNodes(nodes)
+    , mBuckets(buckets)
+    , mCapacity(capacity)
+    , mBucketCount(bucketCount)
+    , mMaxLevel(maxLevel > HASHLIFE_MAX_LEVEL ? HASHLIFE_MAX_LEVEL : maxLevel)
+    , mFree(HASHLIFE_NONE)
+    , mUsed(0)
+    , mCollections(0)
+    , mExhausted(false)
+    , mRoot(HASHLIFE_NONE)
+    , mGeneration(0)
+    , mWidth(0)
+    , mHeight(0)
+    , mBounded(false)
+    , mBirth(1 << 3)
+    , mSurvive((1 << 3) | (1 << 4))
+{
+    reset();
+}
+
+/**
+ * @brief Sets the rule of a Life-like automaton, the engine starts out with
+ * B3/S23. Clears the board, since its cached futures follow the old rule.
+ *
+ * @param birth Bit n set if a dead cell with n neighbors comes to life
+ * @param survive Bit n set if a live cell with n neighbors stays alive
+ * @return 0 on success, -1 for rules where empty space comes to life, which
+ * an unbounded board cannot hold
+ */
+int32_t HashLife::setRule(uint16_t birth, uint16_t survive)
+{
+    int32_t error = -1;
+    if((birth & 1) == 0) {
+        reset();
+        mBirth = birth;
+        // Block sums count the cell itself
+        mSurvive = survive << 1;
+        error = 0;
+    }
+    return error;
+}
+
+/**
+ * @brief Returns every node to the free list
+ */
+void HashLife::reset()
+{
+    mFree = HASHLIFE_NONE;
+    for(uint32_t index = mCapacity; index > 0; index--) {
+        mNodes[index - 1].mark = 0;
+        mNodes[index - 1].next = mFree;
+        mFree = index - 1;
+    }
+    for(uint32_t bucket = 0; bucket < mBucketCount; bucket++) {
+        mBuckets[bucket] = HASHLIFE_NONE;
+    }
+    for(uint32_t level = 0; level <= HASHLIFE_MAX_LEVEL; level++) {
+        mEmpty[level] = HASHLIFE_NONE;
+    }
+    mUsed = 0;
+    mExhausted = false;
+    mRoot = HASHLIFE_NONE;
+    mGeneration = 0;
+}
+
+uint32_t HashLife::allocate()
+{
+    uint32_t index = mFree;
+    if(index != HASHLIFE_NONE) {
+        mFree = mNodes[index].next;
+        mUsed++;
+    }
+    return index;
+}
+
+/**
+ * @brief Bucket of a node. The bucket count has to be a power of two.
+ */
+uint32_t HashLife::hash(uint32_t level, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+    uint32_t h = (level * 0x9E3779B1) ^ (nw * 0x85EBCA77) ^ (ne * 0xC2B2AE3D) ^ (sw * 0x27D4EB2F) ^ (se * 0x165667B1);
+    h ^= h >> 15;
+    h *= 0x2C1B3C6D;
+    h ^= h >> 13;
+    return h & (mBucketCount - 1);
+}
+
+/**
+ * @brief Finds or creates the leaf holding the given 4x4 cells
+ * @return Index of the leaf, HASHLIFE_NONE if the pool is exhausted
+ */
+uint32_t HashLife::leaf(uint32_t cells)
+{
+    uint32_t bucket = hash(HASHLIFE_LEAF_LEVEL, cells, 0, 0, 0);
+    for(uint32_t index = mBuckets[bucket]; index != HASHLIFE_NONE; index = mNodes[index].next) {
+        if((mNodes[index].level == HASHLIFE_LEAF_LEVEL) && (mNodes[index].child[0] == cells)) {
+            return index;
+        }
+    }
+
+    uint32_t index = allocate();
+    if(index != HASHLIFE_NONE) {
+        Node &n = mNodes[index];
+        n.child[0] = cells;
+        n.child[1] = 0;
+        n.child[2] = 0;
+        n.child[3] = 0;
+        n.result = HASHLIFE_NONE;
+        n.population = __builtin_popcount(cells);
+        n.level = HASHLIFE_LEAF_LEVEL;
+        n.step = hashlife_no_step;
+        n.mark = 0;
+        n.next = mBuckets[bucket];
+        mBuckets[bucket] = index;
+    }
+    return index;
+}
+
+/**
+ * @brief Finds or creates the node made of the given quadrants
+ * @return Index of the node, HASHLIFE_NONE if the pool is exhausted or any of
+ * the quadrants is missing
+ */
+uint32_t HashLife::node(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+    if((nw == HASHLIFE_NONE) || (ne == HASHLIFE_NONE) || (sw == HASHLIFE_NONE) || (se == HASHLIFE_NONE)) {
+        return HASHLIFE_NONE;
+    }
+
+    uint32_t level = mNodes[nw].level + 1;
+    uint32_t bucket = hash(level, nw, ne, sw, se);
+    for(uint32_t index = mBuckets[bucket]; index != HASHLIFE_NONE; index = mNodes[index].next) {
+        Node &n = mNodes[index];
+        if((n.level == level) && (n.child[0] == nw) && (n.child[1] == ne) &&
+           (n.child[2] == sw) && (n.child[3] == se)) {
+            return index;
+        }
+    }
+
+    uint32_t index = allocate();
+    if(index != HASHLIFE_NONE) {
+        Node &n = mNodes[index];
+        n.child[0] = nw;
+        n.child[1] = ne;
+        n.child[2] = sw;
+        n.child[3] = se;
+        n.result = HASHLIFE_NONE;
+        n.population = mNodes[nw].population + mNodes[ne].population +
+                       mNodes[sw].population + mNodes[se].population;
+        n.level = level;
+        n.step = hashlife_no_step;
+        n.mark = 0;
+        n.next = mBuckets[bucket];
+        mBuckets[bucket] = index;
+    }
+    return index;
+}
+
+uint32_t HashLife::empty(uint32_t level)
+{
+    if(mEmpty[level] == HASHLIFE_NONE) {
+        if(level == HASHLIFE_LEAF_LEVEL) {
+            mEmpty[level] = leaf(0);
+        } else {
+            uint32_t e = empty(level - 1);
+            mEmpty[level] = node(e, e, e, e);
+        }
+    }
+    return mEmpty[level];
+}
+
+/**
+ * @brief Center square of a node, one level down. The node has to be at least
+ * two levels above the leaves.
+ */
+uint32_t HashLife::center(uint32_t index)
+{
+    Node &n = mNodes[index];
+    return node(mNodes[n.child[0]].child[3], mNodes[n.child[1]].child[2],
+                mNodes[n.child[2]].child[1], mNodes[n.child[3]].child[0]);
+}
+
+/**
+ * @brief Surrounds a node with empty space, keeping it centered one level up
+ */
+uint32_t HashLife::expand(uint32_t index)
+{
+    uint32_t level = mNodes[index].level;
+    uint32_t e = empty(level - 1);
+    if(e == HASHLIFE_NONE) {
+        return HASHLIFE_NONE;
+    }
+
+    Node &n = mNodes[index];
+    uint32_t nw = n.child[0];
+    uint32_t ne = n.child[1];
+    uint32_t sw = n.child[2];
+    uint32_t se = n.child[3];
+    return node(node(e, e, e, nw), node(e, e, ne, e), node(e, sw, e, e), node(se, e, e, e));
+}
+
+/**
+ * @brief Advances the center of a 16x16 node by up to four generations with
+ * the rows held as bit masks. Cells outside of the square are taken as dead,
+ * which the center does not see within four generations. Working on the rows
+ * directly keeps the smallest and most numerous squares out of the pool.
+ */
+uint32_t HashLife::stepBase(uint32_t index, uint32_t step)
+{
+    uint32_t rows[16] = {};
+    for(uint32_t quadrant = 0; quadrant < 4; quadrant++) {
+        Node &q = mNodes[mNodes[index].child[quadrant]];
+        for(uint32_t part = 0; part < 4; part++) {
+            uint32_t cells = mNodes[q.child[part]].child[0];
+            uint32_t x = ((quadrant & 1) * 8) + ((part & 1) * 4);
+            uint32_t y = ((quadrant >> 1) * 8) + ((part >> 1) * 4);
+            for(uint32_t row = 0; row < 4; row++) {
+                rows[y + row] |= ((cells >> (row * 4)) & 0x0F) << x;
+            }
+        }
+    }
+
+    for(uint32_t gen = 0; gen < (1u << step); gen++) {
+        uint32_t next[16];
+        for(int32_t y = 0; y < 16; y++) {
+            uint32_t up   = (y > 0) ? rows[y - 1] : 0;
+            uint32_t mid  = rows[y];
+            uint32_t down = (y < 15) ? rows[y + 1] : 0;
+
+            // Column sums, then the sums of the columns either side
+            uint32_t c0 = up ^ mid ^ down;
+            uint32_t c1 = (up & mid) | (down & (up ^ mid));
+            uint32_t l0 = c0 << 1;
+            uint32_t l1 = c1 << 1;
+            uint32_t r0 = c0 >> 1;
+            uint32_t r1 = c1 >> 1;
+
+            uint32_t s0 = l0 ^ c0 ^ r0;
+            uint32_t k0 = (l0 & c0) | (r0 & (l0 ^ c0));
+            uint32_t u  = l1 ^ c1 ^ r1;
+            uint32_t k1 = (l1 & c1) | (r1 & (l1 ^ c1));
+            uint32_t s1 = u ^ k0;
+            uint32_t k2 = u & k0;
+            uint32_t s2 = k1 ^ k2;
+            uint32_t s3 = k1 & k2;
+
+            // A live cell counts itself in its block sum
+            uint32_t born = 0;
+            uint32_t kept = 0;
+            for(uint32_t sum = 0; sum <= 9; sum++) {
+                uint32_t match = ((sum & 8) ? s3 : ~s3) & ((sum & 4) ? s2 : ~s2) &
+                                 ((sum & 2) ? s1 : ~s1) & ((sum & 1) ? s0 : ~s0);
+                born |= ((mBirth >> sum) & 1) ? match : 0;
+                kept |= ((mSurvive >> sum) & 1) ? match : 0;
+            }
+            next[y] = ((born & ~mid) | (kept & mid)) & 0xFFFF;
+        }
+        for(int32_t y = 0; y < 16; y++) {
+            rows[y] = next[y];
+        }
+    }
+
+    uint32_t quadrants[4];
+    for(uint32_t quadrant = 0; quadrant < 4; quadrant++) {
+        uint32_t x = 4 + ((quadrant & 1) * 4);
+        uint32_t y = 4 + ((quadrant >> 1) * 4);
+        uint32_t cells = 0;
+        for(uint32_t row = 0; row < 4; row++) {
+            cells |= ((rows[y + row] >> x) & 0x0F) << (row * 4);
+        }
+        quadrants[quadrant] = leaf(cells);
+    }
+    return node(quadrants[0], quadrants[1], quadrants[2], quadrants[3]);
+}
+
+/**
+ * @brief Advances the center of a node by 2^step generations. The step can be
+ * at most two less than the level of the node.
+ * @return Center of the node, one level down, HASHLIFE_NONE if the pool ran out
+ */
+uint32_t HashLife::step(uint32_t index, uint32_t step)
+{
+    uint32_t level = mNodes[index].level;
+    if(mNodes[index].population == 0) {
+        return empty(level - 1);
+    }
+    if((mNodes[index].step == step) && (mNodes[index].result != HASHLIFE_NONE)) {
+        return mNodes[index].result;
+    }
+
+    uint32_t result = HASHLIFE_NONE;
+    if(level == (HASHLIFE_LEAF_LEVEL + 2)) {
+        result = stepBase(index, step);
+    } else {
+        uint32_t nw = mNodes[index].child[0];
+        uint32_t ne = mNodes[index].child[1];
+        uint32_t sw = mNodes[index].child[2];
+        uint32_t se = mNodes[index].child[3];
+
+        // Nine overlapping squares one level down, covering the node in a
+        // three by three grid
+        uint32_t sub[9] = {
+            nw,
+            node(mNodes[nw].child[1], mNodes[ne].child[0], mNodes[nw].child[3], mNodes[ne].child[2]),
+            ne,
+            node(mNodes[nw].child[2], mNodes[nw].child[3], mNodes[sw].child[0], mNodes[sw].child[1]),
+            node(mNodes[nw].child[3], mNodes[ne].child[2], mNodes[sw].child[1], mNodes[se].child[0]),
+            node(mNodes[ne].child[2], mNodes[ne].child[3], mNodes[se].child[0], mNodes[se].child[1]),
+            sw,
+            node(mNodes[sw].child[1], mNodes[se].child[0], mNodes[sw].child[3], mNodes[se].child[2]),
+            se
+        };
+
+        // A full step spends half of the generations on each pass, shorter
+        // steps only advance in the second pass
+        bool full = (step == (level - 2));
+        uint32_t passStep = full ? (step - 1) : step;
+        for(uint32_t i = 0; i < 9; i++) {
+            if(sub[i] == HASHLIFE_NONE) {
+                return HASHLIFE_NONE;
+            }
+            sub[i] = full ? this->step(sub[i], passStep) : center(sub[i]);
+        }
+
+        uint32_t quad[4] = {
+            node(sub[0], sub[1], sub[3], sub[4]),
+            node(sub[1], sub[2], sub[4], sub[5]),
+            node(sub[3], sub[4], sub[6], sub[7]),
+            node(sub[4], sub[5], sub[7], sub[8])
+        };
+        for(uint32_t i = 0; i < 4; i++) {
+            if(quad[i] == HASHLIFE_NONE) {
+                return HASHLIFE_NONE;
+            }
+            quad[i] = this->step(quad[i], passStep);
+        }
+
+        result = node(quad[0], quad[1], quad[2], quad[3]);
+    }
+
+    if(result != HASHLIFE_NONE) {
+        mNodes[index].result = result;
+        mNodes[index].step = step;
+    }
+    return result;
+}
+
+/**
+ * @brief True when every live cell of a node sits within its center quarter,
+ * so nothing can escape the center half within a full step
+ */
+bool HashLife::padded(uint32_t index)
+{
+    Node &n = mNodes[index];
+    if(n.level < HASHLIFE_MIN_LEVEL) {
+        return false;
+    }
+
+    uint32_t inner = mNodes[mNodes[n.child[0]].child[3]].child[3];
+    uint32_t population = mNodes[inner].population;
+    inner = mNodes[mNodes[n.child[1]].child[2]].child[2];
+    population += mNodes[inner].population;
+    inner = mNodes[mNodes[n.child[2]].child[1]].child[1];
+    population += mNodes[inner].population;
+    inner = mNodes[mNodes[n.child[3]].child[0]].child[0];
+    population += mNodes[inner].population;
+    return population == n.population;
+}
+
+uint32_t HashLife::build(CellGetter get, void *context, uint32_t level, int32_t x, int32_t y)
+{
+    int32_t size = 1 << level;
+    if((x >= mWidth) || (y >= mHeight) || ((x + size) <= 0) || ((y + size) <= 0)) {
+        return empty(level);
+    }
+
+    if(level == HASHLIFE_LEAF_LEVEL) {
+        uint32_t cells = 0;
+        for(int32_t row = 0; row < 4; row++) {
+            for(int32_t column = 0; column < 4; column++) {
+                int32_t cx = x + column;
+                int32_t cy = y + row;
+                if((cx >= 0) && (cx < mWidth) && (cy >= 0) && (cy < mHeight) && get(context, cx, cy)) {
+                    cells |= 1 << ((row * 4) + column);
+                }
+            }
+        }
+        return leaf(cells);
+    }
+
+    int32_t half = size / 2;
+    return node(build(get, context, level - 1, x, y), build(get, context, level - 1, x + half, y),
+                build(get, context, level - 1, x, y + half), build(get, context, level - 1, x + half, y + half));
+}
+
+/**
+ * @brief Replaces the board with the one read through the getter. The board is
+ * centered on the quadtree, render uses the same placement.
+ *
+ * @param get Reads a cell of the board
+ * @param context Passed to the getter
+ * @param width Width of the board
+ * @param height Height of the board
+ * @param bounded Keep every cell off the board dead, as the bounded kernels
+ * do, rather than let the board grow into an unbounded plane
+ * @return 0 on success, -1 if the pool is too small for the board
+ */
+int32_t HashLife::load(CellGetter get, void *context, int32_t width, int32_t height, bool bounded)
+{
+    reset();
+    mWidth = width;
+    mHeight = height;
+    mBounded = bounded;
+
+    uint32_t level = HASHLIFE_MIN_LEVEL;
+    while(((1 << level) < width) || ((1 << level) < height)) {
+        level++;
+    }
+    if(level > mMaxLevel) {
+        mExhausted = true;
+        return -1;
+    }
+
+    // The board is built in its own coordinates with the quadtree square
+    // shifted so the board sits in the middle
+    int32_t x = (width / 2) - (1 << (level - 1));
+    int32_t y = (height / 2) - (1 << (level - 1));
+    mRoot = build(get, context, level, x, y);
+    if(mRoot == HASHLIFE_NONE) {
+        mExhausted = true;
+        return -1;
+    }
+    return 0;
+}
+
+void HashLife::draw(CellSetter set, void *context, uint32_t index, int32_t x, int32_t y)
+{
+    Node &n = mNodes[index];
+    // Squares larger than the board are positioned relative to its center,
+    // which keeps the coordinates within range for any level
+    int64_t size = (int64_t)1 << n.level;
+    if((n.population == 0) || (x >= mWidth) || (y >= mHeight) || ((x + size) <= 0) || ((y + size) <= 0)) {
+        return;
+    }
+
+    if(n.level == HASHLIFE_LEAF_LEVEL) {
+        for(int32_t row = 0; row < 4; row++) {
+            for(int32_t column = 0; column < 4; column++) {
+                int32_t cx = x + column;
+                int32_t cy = y + row;
+                if(((n.child[0] >> ((row * 4) + column)) & 1) &&
+                   (cx >= 0) && (cx < mWidth) && (cy >= 0) && (cy < mHeight)) {
+                    set(context, cx, cy);
+                }
+            }
+        }
+        return;
+    }
+
+    int32_t half = (int32_t)(size / 2);
+    draw(set, context, n.child[0], x, y);
+    draw(set, context, n.child[1], x + half, y);
+    draw(set, context, n.child[2], x, y + half);
+    draw(set, context, n.child[3], x + half, y + half);
+}
+
+/**
+ * @brief Writes the live cells of the board loaded to the setter. Only cells
+ * that are live get written, the board has to be cleared beforehand. Cells
+ * that wandered off the board are kept but not rendered.
+ *
+ * @param set Sets a cell of the board
+ * @param context Passed to the setter
+ * @param width Width of the board
+ * @param height Height of the board
+ */
+void HashLife::render(CellSetter set, void *context, int32_t width, int32_t height)
+{
+    if(mRoot == HASHLIFE_NONE) {
+        return;
+    }
+
+    mWidth = width;
+    mHeight = height;
+
+    // Walk down to the smallest square that still covers the board, so the
+    // coordinates of larger squares never have to be formed
+    uint32_t index = mRoot;
+    uint32_t level = mNodes[index].level;
+    int32_t x = (width / 2);
+    int32_t y = (height / 2);
+    while((level > HASHLIFE_MIN_LEVEL) && ((1 << (level - 2)) >= ((width / 2) + 1)) &&
+          ((1 << (level - 2)) >= ((height / 2) + 1))) {
+        // The center square of the node covers the board
+        index = center(index);
+        if(index == HASHLIFE_NONE) {
+            mExhausted = true;
+            return;
+        }
+        level--;
+    }
+    int32_t half = 1 << (level - 1);
+    draw(set, context, index, x - half, y - half);
+}
+
+void HashLife::mark(uint32_t index)
+{
+    Node &n = mNodes[index];
+    if(n.mark) {
+        return;
+    }
+    n.mark = 1;
+    if(n.level > HASHLIFE_LEAF_LEVEL) {
+        for(uint32_t i = 0; i < 4; i++) {
+            mark(n.child[i]);
+        }
+    }
+}
+
+/**
+ * @brief Reclaims every node the board no longer uses. Cached results are
+ * dropped since they may point at reclaimed nodes.
+ */
+void HashLife::collect()
+{
+    if(mRoot != HASHLIFE_NONE) {
+        mark(mRoot);
+    }
+
+    for(uint32_t bucket = 0; bucket < mBucketCount; bucket++) {
+        mBuckets[bucket] = HASHLIFE_NONE;
+    }
+    for(uint32_t level = 0; level <= HASHLIFE_MAX_LEVEL; level++) {
+        mEmpty[level] = HASHLIFE_NONE;
+    }
+
+    mFree = HASHLIFE_NONE;
+    mUsed = 0;
+    for(uint32_t index = mCapacity; index > 0; index--) {
+        Node &n = mNodes[index - 1];
+        if(n.mark) {
+            uint32_t bucket = hash(n.level, n.child[0], n.level == HASHLIFE_LEAF_LEVEL ? 0 : n.child[1],
+                                   n.child[2], n.child[3]);
+            n.mark = 0;
+            n.result = HASHLIFE_NONE;
+            n.step = hashlife_no_step;
+            n.next = mBuckets[bucket];
+            mBuckets[bucket] = index - 1;
+            mUsed++;
+        } else {
+            n.next = mFree;
+            mFree = index - 1;
+        }
+    }
+
+    mCollections++;
+}
+
+/**
+ * @brief Advances the board by 2^step generations. A step that runs out of
+ * nodes is retried on a collected pool, and failing that is split into two
+ * steps half the size, which need far fewer nodes at once.
+ * @return 0 on success, -1 if the pool is exhausted or the board outgrew the
+ * largest level
+ */
+int32_t HashLife::advanceStep(uint32_t step)
+{
+    uint32_t result = HASHLIFE_NONE;
+    for(uint32_t attempt = 0; (attempt < 2) && (result == HASHLIFE_NONE); attempt++) {
+        if(attempt > 0) {
+            collect();
+        }
+
+        uint32_t root = mRoot;
+        while((root != HASHLIFE_NONE) && ((mNodes[root].level < (step + 3)) || !padded(root))) {
+            if(mNodes[root].level >= mMaxLevel) {
+                mExhausted = true;
+                return -1;
+            }
+            root = expand(root);
+        }
+        if(root != HASHLIFE_NONE) {
+            result = this->step(root, step);
+        }
+    }
+
+    if(result == HASHLIFE_NONE) {
+        if(step == 0) {
+            mExhausted = true;
+            return -1;
+        }
+        int32_t error = advanceStep(step - 1);
+        if(error == 0) {
+            error = advanceStep(step - 1);
+        }
+        return error;
+    }
+
+    mRoot = result;
+    mGeneration += (uint64_t)1 << step;
+
+    // Keep room for the next step
+    if(mUsed > ((mCapacity / 4) * 3)) {
+        collect();
+    }
+    return 0;
+}
+
+/**
+ * @brief Grows a bounding box, minimum x and y then maximum x and y, by the
+ * live cells of a node with its top left corner at x,y of the board. Squares
+ * already inside the box are skipped.
+ */
+void HashLife::bounds(uint32_t index, int64_t x, int64_t y, int64_t box[4])
+{
+    Node &n = mNodes[index];
+    int64_t size = (int64_t)1 << n.level;
+    if((n.population == 0) ||
+       ((x >= box[0]) && (y >= box[1]) && ((x + size - 1) <= box[2]) && ((y + size - 1) <= box[3]))) {
+        return;
+    }
+
+    if(n.level == HASHLIFE_LEAF_LEVEL) {
+        for(int32_t cell = 0; cell < 16; cell++) {
+            if((n.child[0] >> cell) & 1) {
+                int64_t cx = x + (cell % 4);
+                int64_t cy = y + (cell / 4);
+                box[0] = (cx < box[0]) ? cx : box[0];
+                box[1] = (cy < box[1]) ? cy : box[1];
+                box[2] = (cx > box[2]) ? cx : box[2];
+                box[3] = (cy > box[3]) ? cy : box[3];
+            }
+        }
+        return;
+    }
+
+    int64_t half = size / 2;
+    bounds(n.child[0], x, y, box);
+    bounds(n.child[1], x + half, y, box);
+    bounds(n.child[2], x, y + half, box);
+    bounds(n.child[3], x + half, y + half, box);
+}
+
+/**
+ * @brief Distance from the live cells to the nearest cell off the board. Life
+ * spreads one cell per generation at most, so the board evolves as if bounded
+ * for that many generations, the cells born off it only count from the next.
+ * The board has to be clipped and not empty.
+ */
+uint64_t HashLife::margin()
+{
+    int64_t box[4] = {INT64_MAX, INT64_MAX, INT64_MIN, INT64_MIN};
+    int64_t half = (int64_t)1 << (mNodes[mRoot].level - 1);
+    bounds(mRoot, (mWidth / 2) - half, (mHeight / 2) - half, box);
+
+    int64_t distance = box[0] + 1;
+    distance = ((box[1] + 1) < distance) ? (box[1] + 1) : distance;
+    distance = ((mWidth - box[2]) < distance) ? (mWidth - box[2]) : distance;
+    distance = ((mHeight - box[3]) < distance) ? (mHeight - box[3]) : distance;
+    return (distance > 0) ? distance : 1;
+}
+
+/**
+ * @brief Clears the cells of a node that lie off the board, the node has its
+ * top left corner at x,y of the board
+ * @return Clipped node, HASHLIFE_NONE if the pool ran out
+ */
+uint32_t HashLife::clip(uint32_t index, int64_t x, int64_t y)
+{
+    Node &n = mNodes[index];
+    int64_t size = (int64_t)1 << n.level;
+    if((n.population == 0) || ((x >= 0) && (y >= 0) && ((x + size) <= mWidth) && ((y + size) <= mHeight))) {
+        return index;
+    }
+    if((x >= mWidth) || (y >= mHeight) || ((x + size) <= 0) || ((y + size) <= 0)) {
+        return empty(n.level);
+    }
+
+    if(n.level == HASHLIFE_LEAF_LEVEL) {
+        uint32_t cells = n.child[0];
+        for(int32_t cell = 0; cell < 16; cell++) {
+            int64_t cx = x + (cell % 4);
+            int64_t cy = y + (cell / 4);
+            if((cx < 0) || (cx >= mWidth) || (cy < 0) || (cy >= mHeight)) {
+                cells &= ~(1u << cell);
+            }
+        }
+        return leaf(cells);
+    }
+
+    int64_t half = size / 2;
+    uint32_t nw = n.child[0];
+    uint32_t ne = n.child[1];
+    uint32_t sw = n.child[2];
+    uint32_t se = n.child[3];
+    return node(clip(nw, x, y), clip(ne, x + half, y), clip(sw, x, y + half), clip(se, x + half, y + half));
+}
+
+/**
+ * @brief Clears every cell off the board, retried on a collected pool
+ * @return 0 on success, -1 if the pool is exhausted
+ */
+int32_t HashLife::clipRoot()
+{
+    int64_t half = (int64_t)1 << (mNodes[mRoot].level - 1);
+    uint32_t root = clip(mRoot, (mWidth / 2) - half, (mHeight / 2) - half);
+    if(root == HASHLIFE_NONE) {
+        collect();
+        root = clip(mRoot, (mWidth / 2) - half, (mHeight / 2) - half);
+    }
+    if(root == HASHLIFE_NONE) {
+        mExhausted = true;
+        return -1;
+    }
+    mRoot = root;
+    return 0;
+}
+
+/**
+ * @brief Advances the board by any number of generations. A bounded board is
+ * advanced in runs no longer than the distance of its live cells to the edge,
+ * with the cells that left the board cleared after each, which gives the same
+ * board as the bounded kernels. Runs shrink to a single generation while a
+ * pattern touches an edge.
+ *
+ * @param generations Number of generations to advance
+ * @return 0 on success, -1 if the pool is exhausted or the board outgrew the
+ * largest level. Generations done before the failure are kept.
+ */
+int32_t HashLife::advance(uint64_t generations)
+{
+    if(mRoot == HASHLIFE_NONE) {
+        return -1;
+    }
+    if(!mBounded) {
+        return advanceUnbounded(generations);
+    }
+
+    int32_t error = 0;
+    while((generations > 0) && (error == 0) && (population() > 0)) {
+        uint64_t run = margin();
+        run = (run < generations) ? run : generations;
+        error = advanceUnbounded(run);
+        if(error == 0) {
+            error = clipRoot();
+        }
+        generations -= run;
+    }
+
+    // An empty board stays empty, whatever the rule
+    if(error == 0) {
+        mGeneration += generations;
+    }
+    return error;
+}
+
+/**
+ * @brief Advances the board by any number of generations on an unbounded
+ * plane, one power of two at a time
+ */
+int32_t HashLife::advanceUnbounded(uint64_t generations)
+{
+
+    // Larger steps need a deeper tree than allowed, those are done as
+    // repeats of the largest step
+    uint32_t maxStep = mMaxLevel - 3;
+
+    int32_t error = 0;
+    for(uint32_t bit = 0; (bit < 64) && (error == 0); bit++) {
+        if(((generations >> bit) & 1) == 0) {
+            continue;
+        }
+
+        uint32_t step = (bit > maxStep) ? maxStep : bit;
+        uint64_t repeats = (uint64_t)1 << (bit - step);
+        for(uint64_t repeat = 0; (repeat < repeats) && (error == 0); repeat++) {
+            error = advanceStep(step);
+        }
+    }
+
+    return error;
+}
+
+uint64_t HashLife::generation()
+{
+    return mGeneration;
+}
+
+uint32_t HashLife::population()
+{
+    return (mRoot == HASHLIFE_NONE) ? 0 : mNodes[mRoot].population;
+}
+
+uint32_t HashLife::level()
+{
+    return (mRoot == HASHLIFE_NONE) ? 0 : mNodes[mRoot].level;
+}
+
+uint32_t HashLife::nodesUsed()
+{
+    return mUsed;
+}
+
+uint32_t HashLife::capacity()
+{
+    return mCapacity;
+}
+
+uint32_t HashLife::collections()
+{
+    return mCollections;
+}
+
+bool HashLife::exhausted()
+{
+    return mExhausted;
+}
@@ -0,0 +1,332 @@
+#include <stdio.h>
+
+#include "project/kernel.h"
+#include "project/rule.h"
+
+template< uint32_t Rule >
+static void checkRamBoardRule(ConwaysBoard &ram, ConwaysBoard &newRam, bool debug,
+                              int32_t pageStart, int32_t pageEnd, ConwaysTiles *tiles);
+template< uint32_t Rule >
+static void checkRamBoardSwarRule(ConwaysBoard &ram, ConwaysBoard &newRam, bool debug,
+                                  int32_t pageStart, int32_t pageEnd, ConwaysTiles *tiles);
+
+// Every engine is built once per rule, so the rule costs nothing per cell
+static const ConwaysKernel conways_kernels[CONWAYS_ENGINE_MAX][CONWAYS_RULE_MAX] = {
+    {
+        checkRamBoardRule< CONWAYS_RULE_LIFE >,
+        checkRamBoardRule< CONWAYS_RULE_HIGHLIFE >,
+        checkRamBoardRule< CONWAYS_RULE_SEEDS >,
+        checkRamBoardRule< CONWAYS_RULE_DAY_NIGHT >,
+        checkRamBoardRule< CONWAYS_RULE_REPLICATOR >,
+        checkRamBoardRule< CONWAYS_RULE_MAZE >
+    },
+    {
+        checkRamBoardSwarRule< CONWAYS_RULE_LIFE >,
+        checkRamBoardSwarRule< CONWAYS_RULE_HIGHLIFE >,
+        checkRamBoardSwarRule< CONWAYS_RULE_SEEDS >,
+        checkRamBoardSwarRule< CONWAYS_RULE_DAY_NIGHT >,
+        checkRamBoardSwarRule< CONWAYS_RULE_REPLICATOR >,
+        checkRamBoardSwarRule< CONWAYS_RULE_MAZE >
+    }
+};
+
+/**
+ * @brief Looks up the kernel of an engine built for a rule
+ */
+ConwaysKernel conwaysGetKernel(ConwaysEngine engine, ConwaysRule rule)
+{
+    return conways_kernels[engine][rule];
+}
+
+void printRamBoard(ConwaysBoard &ram)
+{
+    for(uint32_t page = 0; page < CONWAYS_BOARD_PAGES; page++) {
+        for(uint32_t shift = 0; shift < 8; shift++) {
+            uint32_t bit = 1 << shift;
+            for(uint32_t column = 0; column < CONWAYS_BOARD_WIDTH; column++) {
+                if((ram[page][column] & bit) == 0) {
+                    printf("  ");
+                } else {
+                    // printf("%01X ", ram[page][column] & 0xF);
+                    printf("o ");
+                }
+            }
+            printf("\n");
+        }
+    }
+}
+
+/**
+ * @brief Builds the bit parallel window for a page column. The eight cells of
+ * the column sit in bits 1-8, the bottom cell of the page above in bit 0 and
+ * the top cell of the page below in bit 9. Cells off the board are dead.
+ */
+static inline uint32_t swarWindow(ConwaysBoard &ram, int32_t page, int32_t column)
+{
+    uint32_t window = (uint32_t)ram[page][column] << 1;
+    if(page > 0) {
+        window |= (ram[page - 1][column] >> 7);
+    }
+    if((page + 1) < CONWAYS_BOARD_PAGES) {
+        window |= (uint32_t)(ram[page + 1][column] & 0x01) << 9;
+    }
+    return window;
+}
+
+/**
+ * @brief Sums each cell of a column window with the cells above and below it.
+ * Lane n of the result holds the sum for cell n of the page as a two bit
+ * number split across the ones and twos words.
+ */
+static inline void swarColumnSum(uint32_t window, uint32_t &ones, uint32_t &twos)
+{
+    uint32_t up   = window;
+    uint32_t mid  = window >> 1;
+    uint32_t down = window >> 2;
+    ones = up ^ mid ^ down;
+    twos = (up & mid) | (down & (up ^ mid));
+}
+
+/**
+ * @brief Computes the next state of a run of columns within a page. Column sums
+ * are rolled along the run so every column is only summed once.
+ * @return Mask of the tiles within the run that changed
+ */
+template< uint32_t Rule >
+static uint16_t swarColumns(ConwaysBoard &ram, ConwaysBoard &newRam, int32_t page,
+                            int32_t columnStart, int32_t columnEnd)
+{
+    uint16_t changed = 0;
+    uint32_t l0 = 0;
+    uint32_t l1 = 0;
+    uint32_t c0 = 0;
+    uint32_t c1 = 0;
+    if(columnStart > 0) {
+        swarColumnSum(swarWindow(ram, page, columnStart - 1), l0, l1);
+    }
+    uint32_t center = swarWindow(ram, page, columnStart);
+    swarColumnSum(center, c0, c1);
+
+    for(int32_t column = columnStart; column < columnEnd; column++) {
+        uint32_t r0 = 0;
+        uint32_t r1 = 0;
+        uint32_t right = 0;
+        if((column + 1) < CONWAYS_BOARD_WIDTH) {
+            right = swarWindow(ram, page, column + 1);
+            swarColumnSum(right, r0, r1);
+        }
+
+        // Add the three column sums, giving the 3x3 block sum (including
+        // the cell itself) as a four bit number in s3..s0
+        uint32_t s0 = l0 ^ c0 ^ r0;
+        uint32_t k0 = (l0 & c0) | (r0 & (l0 ^ c0));
+        uint32_t u  = l1 ^ c1 ^ r1;
+        uint32_t k1 = (l1 & c1) | (r1 & (l1 ^ c1));
+        uint32_t s1 = u ^ k0;
+        uint32_t k2 = u & k0;
+        uint32_t s2 = k1 ^ k2;
+        uint32_t s3 = k1 & k2;
+
+        uint8_t next = (uint8_t)conwaysRuleLanes< Rule >(s3, s2, s1, s0, center >> 1);
+        if(next != ram[page][column]) {
+            changed |= (1 << (column / CONWAYS_TILE_WIDTH));
+        }
+        newRam[page][column] = next;
+
+        l0 = c0;
+        l1 = c1;
+        c0 = r0;
+        c1 = r1;
+        center = right;
+    }
+
+    return changed;
+}
+
+template< uint32_t Rule >
+static void checkRamBoardSwarRule(ConwaysBoard &ram, ConwaysBoard &newRam, bool debug,
+                                  int32_t pageStart, int32_t pageEnd, ConwaysTiles *tiles)
+{
+    (void)debug;
+    for(int32_t page = pageStart; page < pageEnd; page++) {
+        uint16_t active = tiles ? tiles->active[page] : CONWAYS_TILES_ALL;
+        uint16_t changed = 0;
+
+        // Work through each run of consecutive active tiles. Inactive tiles
+        // are left alone, the board from two generations ago already holds
+        // their contents.
+        int32_t tile = 0;
+        while(tile < CONWAYS_TILES_PER_PAGE) {
+            if((active & (1 << tile)) == 0) {
+                tile++;
+                continue;
+            }
+
+            int32_t runStart = tile;
+            while((tile < CONWAYS_TILES_PER_PAGE) && (active & (1 << tile))) {
+                tile++;
+            }
+            changed |= swarColumns< Rule >(ram, newRam, page, runStart * CONWAYS_TILE_WIDTH, tile * CONWAYS_TILE_WIDTH);
+        }
+
+        if(tiles) {
+            tiles->changed[page] = changed;
+        }
+    }
+}
+
+/**
+ * @brief Marks every tile as active, forcing the next generation to compute
+ * the whole board
+ */
+void conwaysTilesMarkAll(ConwaysTiles *tiles)
+{
+    for(uint32_t page = 0; page < CONWAYS_BOARD_PAGES; page++) {
+        tiles->active[page] = CONWAYS_TILES_ALL;
+        tiles->changed[page] = CONWAYS_TILES_ALL;
+    }
+}
+
+/**
+ * @brief Carries the tiles changed in this generation over to the next one. A
+ * tile is active next generation if it or any of its eight neighbors changed.
+ * @return Number of tiles that were active in this generation
+ */
+uint32_t conwaysTilesUpdate(ConwaysTiles *tiles)
+{
+    uint32_t computed = 0;
+    for(int32_t page = 0; page < CONWAYS_BOARD_PAGES; page++) {
+        computed += __builtin_popcount(tiles->active[page]);
+    }
+
+    for(int32_t page = 0; page < CONWAYS_BOARD_PAGES; page++) {
+        uint32_t rows = tiles->changed[page];
+        if(page > 0) {
+            rows |= tiles->changed[page - 1];
+        }
+        if((page + 1) < CONWAYS_BOARD_PAGES) {
+            rows |= tiles->changed[page + 1];
+        }
+        tiles->active[page] = (uint16_t)(rows | (rows << 1) | (rows >> 1));
+    }
+
+    return computed;
+}
+
+void checkRamBoardSwar(ConwaysBoard &ram, ConwaysBoard &newRam, bool debug,
+                       int32_t pageStart, int32_t pageEnd, ConwaysTiles *tiles)
+{
+    checkRamBoardSwarRule< CONWAYS_RULE_LIFE >(ram, newRam, debug, pageStart, pageEnd, tiles);
+}
+
+template< uint32_t Rule >
+static void checkRamBoardRule(ConwaysBoard &ram, ConwaysBoard &newRam, bool debug,
+                              int32_t pageStart, int32_t pageEnd, ConwaysTiles *tiles)
+{
+    int32_t column_bits = 8;
+    for(int32_t page = pageStart; page < pageEnd; page++) {
+        if(tiles) {
+            // Every tile is computed, so treat every tile as changed
+            tiles->active[page] = CONWAYS_TILES_ALL;
+            tiles->changed[page] = CONWAYS_TILES_ALL;
+        }
+
+        for(int32_t shift = 0; shift < column_bits; shift++) {
+            uint8_t bit = 1 << shift;
+            for(int32_t column = 0; column < CONWAYS_BOARD_WIDTH; column++) {
+                int32_t neighbors = 0;
+                bool leftValid = false;
+                bool rightValid = false;
+                bool upValid = false;
+                bool upperPage = false;
+                bool downValid = false;
+                bool lowerPage = false;
+
+                if((column - 1) >= 0) {
+                    // Check left
+                    neighbors += ((ram[page][column - 1] & bit) > 0);
+                    leftValid = true;
+                }
+
+                if((column + 1) < CONWAYS_BOARD_WIDTH) {
+                    // Check right
+                    neighbors += ((ram[page][column + 1] & bit) > 0);
+                    rightValid = true;
+                }
+
+                if((shift - 1) >= 0) {
+                    // Check up
+                    neighbors += ((ram[page][column] & (1 << (shift - 1))) > 0);
+                    upValid = true;
+                } else if((page - 1) >= 0) {
+                    // If there is another page before this one, check the last
+                    // bit in that column
+                    neighbors += ((ram[page - 1][column] & (1 << (column_bits - 1))) > 0);
+                    upValid = true;
+                    upperPage = true;
+                }
+
+                if((shift + 1) < column_bits) {
+                    // Check down
+                    neighbors += ((ram[page][column] & (1 << (shift + 1))) > 0);
+                    downValid = true;
+                } else if((page + 1) < CONWAYS_BOARD_PAGES) {
+                    // If there is another page after this one, check the first
+                    // bit in that column
+                    neighbors += ((ram[page + 1][column] & (1 << 0)) > 0);
+                    downValid = true;
+                    lowerPage = true;
+                }
+
+                if(leftValid && upValid) {
+                    if(upperPage) {
+                        neighbors += ((ram[page - 1][column - 1] & (1 << (column_bits - 1))) > 0);
+                    } else {
+                        neighbors += ((ram[page][column - 1] & (1 << (shift - 1))) > 0);
+                    }
+                }
+
+                if(rightValid && upValid) {
+                    if(upperPage) {
+                        neighbors += ((ram[page - 1][column + 1] & (1 << (column_bits - 1))) > 0);
+                    } else {
+                        neighbors += ((ram[page][column + 1] & (1 << (shift - 1))) > 0);
+                    }
+                }
+
+                if(rightValid && downValid) {
+                    if(lowerPage) {
+                        neighbors += ((ram[page + 1][column + 1] & (1 << 0)) > 0);
+                    } else {
+                        neighbors += ((ram[page][column + 1] & (1 << (shift + 1))) > 0);
+                    }
+                }
+
+                if(leftValid && downValid) {
+                    if(lowerPage) {
+                        neighbors += ((ram[page + 1][column - 1] & (1 << 0)) > 0);
+                    } else {
+                        neighbors += ((ram[page][column - 1] & (1 << (shift + 1))) > 0);
+                    }
+                }
+
+                if(debug){ printf("%d", neighbors); }
+                if(conwaysRuleCell< Rule >(neighbors, ram[page][column] & bit)) {
+                    // Cell survives / becomes living
+                    newRam[page][column] |= bit;
+                } else {
+                    // Cell dies
+                    newRam[page][column] &= ~bit;
+                }
+                if(debug){ printf("."); }
+            }
+            if(debug){ printf("\n"); }
+        }
+    }
+}
+
+void checkRamBoard(ConwaysBoard &ram, ConwaysBoard &newRam, bool debug,
+                   int32_t pageStart, int32_t pageEnd, ConwaysTiles *tiles)
+{
+    checkRamBoardRule< CONWAYS_RULE_LIFE >(ram, newRam, debug, pageStart, pageEnd, tiles);
+}
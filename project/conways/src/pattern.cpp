@@ -0,0 +1,308 @@
+#include <string.h>
+
+#include "project/pattern.h"
+
+static const char *patternLineEnd(const char *p, const char *end)
+{
+    while((p < end) && (*p != '\n')) {
+        p++;
+    }
+    return p;
+}
+
+static const char *patternNextLine(const char *p, const char *end)
+{
+    p = patternLineEnd(p, end);
+    return (p < end) ? p + 1 : end;
+}
+
+static bool patternIsName(const char *p, const char *end)
+{
+    return ((end - p) >= 2) && (p[0] == '#') && (p[1] == 'N');
+}
+
+static bool patternIsSpace(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+/**
+ * @brief Reads a decimal number, skipping any blanks in front of it
+ * @return True if a number was read
+ */
+static bool patternNumber(const char *&p, const char *end, int32_t *value)
+{
+    while((p < end) && ((*p == ' ') || (*p == '\t'))) {
+        p++;
+    }
+
+    bool negative = (p < end) && (*p == '-');
+    if(negative) {
+        p++;
+    }
+
+    const char *start = p;
+    int32_t number = 0;
+    while((p < end) && (*p >= '0') && (*p <= '9')) {
+        number = (number * 10) + (*p - '0');
+        p++;
+    }
+
+    *value = negative ? -number : number;
+    return p != start;
+}
+
+/**
+ * @brief Reads one dimension of an RLE header, "x = 3"
+ */
+static int32_t patternHeaderValue(const char *p, const char *end, char key)
+{
+    int32_t value = 0;
+    for(; p < end; p++) {
+        if((*p == key) && ((p + 1) < end) && ((p[1] == ' ') || (p[1] == '='))) {
+            p++;
+            while((p < end) && (*p != '=')) {
+                p++;
+            }
+            if(p < end) {
+                p++;
+                patternNumber(p, end, &value);
+            }
+            break;
+        }
+    }
+    return value;
+}
+
+/**
+ * @brief Works out the format and size of a pattern from its body
+ */
+static void patternScan(ConwaysPattern *pattern)
+{
+    const char *end = pattern->end;
+
+    pattern->format = CONWAYS_PATTERN_RLE;
+    pattern->width = 0;
+    pattern->height = 0;
+    pattern->originX = 0;
+    pattern->originY = 0;
+
+    // Comment lines come first, one of them may name the format
+    const char *p = pattern->body;
+    while((p < end) && (*p == '#')) {
+        if(((end - p) >= 10) && (strncmp(p, "#Life 1.06", 10) == 0)) {
+            pattern->format = CONWAYS_PATTERN_LIFE_106;
+        }
+        p = patternNextLine(p, end);
+    }
+
+    if(pattern->format == CONWAYS_PATTERN_RLE) {
+        const char *lineEnd = patternLineEnd(p, end);
+        pattern->width = patternHeaderValue(p, lineEnd, 'x');
+        pattern->height = patternHeaderValue(p, lineEnd, 'y');
+    } else {
+        // Cells are given relative to an arbitrary origin, so the bounding
+        // box takes a pass over them
+        int32_t minX = INT32_MAX;
+        int32_t minY = INT32_MAX;
+        int32_t maxX = INT32_MIN;
+        int32_t maxY = INT32_MIN;
+        for(; p < end; p = patternNextLine(p, end)) {
+            int32_t cellX = 0;
+            int32_t cellY = 0;
+            if((*p != '#') && patternNumber(p, end, &cellX) && patternNumber(p, end, &cellY)) {
+                minX = (cellX < minX) ? cellX : minX;
+                minY = (cellY < minY) ? cellY : minY;
+                maxX = (cellX > maxX) ? cellX : maxX;
+                maxY = (cellY > maxY) ? cellY : maxY;
+            }
+        }
+        if(minX <= maxX) {
+            pattern->width = maxX - minX + 1;
+            pattern->height = maxY - minY + 1;
+            pattern->originX = minX;
+            pattern->originY = minY;
+        }
+    }
+}
+
+/**
+ * @brief Steps to the pattern that starts at p
+ */
+static void patternEntry(const char *p, const char *end, ConwaysPattern *pattern)
+{
+    const char *lineEnd = patternLineEnd(p, end);
+
+    // Name, trimmed of the blanks around it
+    const char *name = p + 2;
+    while((name < lineEnd) && patternIsSpace(*name)) {
+        name++;
+    }
+    const char *nameEnd = lineEnd;
+    while((nameEnd > name) && patternIsSpace(nameEnd[-1])) {
+        nameEnd--;
+    }
+    pattern->name = name;
+    pattern->nameLength = nameEnd - name;
+    pattern->body = patternNextLine(p, end);
+
+    const char *next = pattern->body;
+    while((next < end) && !patternIsName(next, end)) {
+        next = patternNextLine(next, end);
+    }
+    pattern->end = next;
+
+    patternScan(pattern);
+}
+
+/**
+ * @brief Looks up a pattern by name
+ * @param library Pattern library to search
+ * @param size Size, in bytes, of the library
+ * @param name Name of the pattern
+ * @param pattern Pattern found
+ * @return 0 on success, -1 if the library has no such pattern
+ */
+int32_t conwaysPatternFind(const char *library, uint32_t size, const char *name, ConwaysPattern *pattern)
+{
+    int32_t error = -1;
+    const char *end = library + size;
+    uint32_t nameLength = strlen(name);
+
+    for(const char *p = library; (p < end) && (error != 0); p = patternNextLine(p, end)) {
+        if(patternIsName(p, end)) {
+            patternEntry(p, end, pattern);
+            if((pattern->nameLength == nameLength) && (strncmp(pattern->name, name, nameLength) == 0)) {
+                error = 0;
+            }
+        }
+    }
+
+    return error;
+}
+
+/**
+ * @brief Looks up a pattern by its place in the library, used to list them
+ * @return 0 on success, -1 if the library holds fewer patterns
+ */
+int32_t conwaysPatternAt(const char *library, uint32_t size, uint32_t index, ConwaysPattern *pattern)
+{
+    int32_t error = -1;
+    const char *end = library + size;
+
+    for(const char *p = library; (p < end) && (error != 0); p = patternNextLine(p, end)) {
+        if(patternIsName(p, end)) {
+            if(index == 0) {
+                patternEntry(p, end, pattern);
+                error = 0;
+            }
+            index--;
+        }
+    }
+
+    return error;
+}
+
+/**
+ * @brief Hands a run of live cells to the board, clipped to its bounds
+ * @return Number of cells set
+ */
+static uint32_t patternRun(ConwaysPatternRun run, void *context, int32_t x, int32_t y, int32_t length,
+                           int32_t width, int32_t height)
+{
+    uint32_t cells = 0;
+    if(x < 0) {
+        length += x;
+        x = 0;
+    }
+    if((x + length) > width) {
+        length = width - x;
+    }
+    if((y >= 0) && (y < height) && (length > 0)) {
+        run(context, x, y, length);
+        cells = length;
+    }
+    return cells;
+}
+
+/**
+ * @brief Decodes a pattern onto a board. Live cells are handed over as runs
+ * straight from the encoded text, nothing is buffered along the way. Cells
+ * already on the board are left alone.
+ *
+ * @param pattern Pattern to decode
+ * @param run Sets a run of live cells on the board
+ * @param context Board handed to the run callback
+ * @param x Column of the top left corner of the pattern
+ * @param y Row of the top left corner of the pattern
+ * @param width Width of the board, cells beyond it are dropped
+ * @param height Height of the board, cells beyond it are dropped
+ * @return Number of live cells placed on the board
+ */
+uint32_t conwaysPatternDecode(const ConwaysPattern *pattern, ConwaysPatternRun run, void *context,
+                              int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    uint32_t cells = 0;
+    const char *p = pattern->body;
+    const char *end = pattern->end;
+
+    while((p < end) && (*p == '#')) {
+        p = patternNextLine(p, end);
+    }
+
+    if(pattern->format == CONWAYS_PATTERN_RLE) {
+        // Skip the header line
+        p = patternNextLine(p, end);
+
+        int32_t column = 0;
+        int32_t row = 0;
+        int32_t count = 0;
+        for(; (p < end) && (*p != '!'); p++) {
+            char c = *p;
+            if((c >= '0') && (c <= '9')) {
+                count = (count * 10) + (c - '0');
+            } else if(!patternIsSpace(c)) {
+                int32_t length = (count > 0) ? count : 1;
+                count = 0;
+                if(c == '$') {
+                    row += length;
+                    column = 0;
+                } else if((c == 'b') || (c == '.')) {
+                    column += length;
+                } else {
+                    // Any other cell state counts as alive
+                    cells += patternRun(run, context, x + column, y + row, length, width, height);
+                    column += length;
+                }
+            }
+        }
+    } else {
+        // Cells along a row are gathered into runs as they come
+        int32_t runX = 0;
+        int32_t runY = 0;
+        int32_t length = 0;
+        for(; p < end; p = patternNextLine(p, end)) {
+            int32_t cellX = 0;
+            int32_t cellY = 0;
+            if((*p != '#') && patternNumber(p, end, &cellX) && patternNumber(p, end, &cellY)) {
+                cellX += x - pattern->originX;
+                cellY += y - pattern->originY;
+                if((length > 0) && (cellY == runY) && (cellX == (runX + length))) {
+                    length++;
+                } else {
+                    if(length > 0) {
+                        cells += patternRun(run, context, runX, runY, length, width, height);
+                    }
+                    runX = cellX;
+                    runY = cellY;
+                    length = 1;
+                }
+            }
+        }
+        if(length > 0) {
+            cells += patternRun(run, context, runX, runY, length, width, height);
+        }
+    }
+
+    return cells;
+}
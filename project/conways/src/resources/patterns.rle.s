@@ -0,0 +1,12 @@
+    .section .rodata
+    .global patterns_rle
+    .type   patterns_rle, %object
+    .align  4
+patterns_rle:
+    .incbin "patterns.rle"
+patterns_rle_end:
+    .global patterns_rle_size
+    .type   patterns_rle_size, %object
+    .align  4
+patterns_rle_size:
+    .int    patterns_rle_end - patterns_rle
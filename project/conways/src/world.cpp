@@ -0,0 +1,171 @@
+#include <stdlib.h>
+
+#include "project/world.h"
+
+void conwaysWorldRandom(ConwaysWorld &world)
+{
+    for(uint32_t band = 0; band < CONWAYS_WORLD_BANDS; band++) {
+        for(uint32_t column = 0; column < CONWAYS_WORLD_WIDTH; column++) {
+            world[band][column] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+        }
+    }
+}
+
+/**
+ * @brief Sums each cell of a band column with the cells above and below it.
+ * Lane n of the result holds the sum for row n of the band as a two bit
+ * number split across the ones and twos words.
+ *
+ * @param above Column of the band above, only its bottom row is used
+ * @param center Column to sum
+ * @param below Column of the band below, only its top row is used
+ */
+static inline void worldColumnSum(uint32_t above, uint32_t center, uint32_t below, uint32_t &ones, uint32_t &twos)
+{
+    uint32_t up   = (center << 1) | (above >> (CONWAYS_WORLD_BAND_HEIGHT - 1));
+    uint32_t down = (center >> 1) | (below << (CONWAYS_WORLD_BAND_HEIGHT - 1));
+    ones = up ^ center ^ down;
+    twos = (up & center) | (down & (up ^ center));
+}
+
+/**
+ * @brief Computes the next generation of a range of bands. Every column is
+ * summed once and the sums are rolled along the band, so each word of the
+ * world is read once per generation and the working set stays in registers.
+ */
+template< uint32_t Rule >
+static void worldStep(ConwaysWorld &world, ConwaysWorld &newWorld, bool wrap, int32_t bandStart, int32_t bandEnd)
+{
+    for(int32_t band = bandStart; band < bandEnd; band++) {
+        // Neighboring bands, masked out at the edges of a bounded world
+        int32_t bandAbove = (band + CONWAYS_WORLD_BANDS - 1) % CONWAYS_WORLD_BANDS;
+        int32_t bandBelow = (band + 1) % CONWAYS_WORLD_BANDS;
+        uint32_t maskAbove = (wrap || (band > 0)) ? 0xFFFFFFFF : 0;
+        uint32_t maskBelow = (wrap || ((band + 1) < CONWAYS_WORLD_BANDS)) ? 0xFFFFFFFF : 0;
+        uint32_t *above = world[bandAbove];
+        uint32_t *row = world[band];
+        uint32_t *below = world[bandBelow];
+
+        uint32_t l0 = 0;
+        uint32_t l1 = 0;
+        uint32_t c0 = 0;
+        uint32_t c1 = 0;
+        if(wrap) {
+            int32_t last = CONWAYS_WORLD_WIDTH - 1;
+            worldColumnSum(above[last] & maskAbove, row[last], below[last] & maskBelow, l0, l1);
+        }
+        uint32_t center = row[0];
+        worldColumnSum(above[0] & maskAbove, center, below[0] & maskBelow, c0, c1);
+
+        for(int32_t column = 0; column < CONWAYS_WORLD_WIDTH; column++) {
+            uint32_t r0 = 0;
+            uint32_t r1 = 0;
+            uint32_t right = 0;
+            int32_t next = column + 1;
+            if(next == CONWAYS_WORLD_WIDTH) {
+                next = wrap ? 0 : -1;
+            }
+            if(next >= 0) {
+                right = row[next];
+                worldColumnSum(above[next] & maskAbove, right, below[next] & maskBelow, r0, r1);
+            }
+
+            // Add the three column sums, giving the 3x3 block sum (including
+            // the cell itself) as a four bit number in s3..s0
+            uint32_t s0 = l0 ^ c0 ^ r0;
+            uint32_t k0 = (l0 & c0) | (r0 & (l0 ^ c0));
+            uint32_t u  = l1 ^ c1 ^ r1;
+            uint32_t k1 = (l1 & c1) | (r1 & (l1 ^ c1));
+            uint32_t s1 = u ^ k0;
+            uint32_t k2 = u & k0;
+            uint32_t s2 = k1 ^ k2;
+            uint32_t s3 = k1 & k2;
+
+            newWorld[band][column] = conwaysRuleLanes< Rule >(s3, s2, s1, s0, center);
+
+            l0 = c0;
+            l1 = c1;
+            c0 = r0;
+            c1 = r1;
+            center = right;
+        }
+    }
+}
+
+using ConwaysWorldKernel = void (*)(ConwaysWorld &world, ConwaysWorld &newWorld, bool wrap,
+                                    int32_t bandStart, int32_t bandEnd);
+
+// The kernel is built once per rule, so the rule costs nothing per cell
+static const ConwaysWorldKernel conways_world_kernels[CONWAYS_RULE_MAX] = {
+    worldStep< CONWAYS_RULE_LIFE >,
+    worldStep< CONWAYS_RULE_HIGHLIFE >,
+    worldStep< CONWAYS_RULE_SEEDS >,
+    worldStep< CONWAYS_RULE_DAY_NIGHT >,
+    worldStep< CONWAYS_RULE_REPLICATOR >,
+    worldStep< CONWAYS_RULE_MAZE >
+};
+
+/**
+ * @brief Computes the next generation of a range of bands
+ *
+ * @param world Current generation
+ * @param newWorld Receives the next generation
+ * @param wrap True to wrap the edges around, false to treat cells past the
+ * edges as dead
+ * @param rule Rule the cells follow
+ * @param bandStart First band to compute
+ * @param bandEnd One past the last band to compute
+ */
+void conwaysWorldStep(ConwaysWorld &world, ConwaysWorld &newWorld, bool wrap, ConwaysRule rule,
+                      int32_t bandStart, int32_t bandEnd)
+{
+    conways_world_kernels[rule](world, newWorld, wrap, bandStart, bandEnd);
+}
+
+/**
+ * @brief Brings a viewport position back within the world. A wrapping world
+ * lets the viewport straddle the edges, a bounded one keeps it inside.
+ */
+void conwaysWorldClampView(int32_t *viewX, int32_t *viewY, bool wrap)
+{
+    if(wrap) {
+        *viewX = ((*viewX % CONWAYS_WORLD_WIDTH) + CONWAYS_WORLD_WIDTH) % CONWAYS_WORLD_WIDTH;
+        *viewY = ((*viewY % CONWAYS_WORLD_HEIGHT) + CONWAYS_WORLD_HEIGHT) % CONWAYS_WORLD_HEIGHT;
+    } else {
+        int32_t maxX = CONWAYS_WORLD_WIDTH - CONWAYS_BOARD_WIDTH;
+        int32_t maxY = CONWAYS_WORLD_HEIGHT - CONWAYS_BOARD_HEIGHT;
+        *viewX = (*viewX < 0) ? 0 : ((*viewX > maxX) ? maxX : *viewX);
+        *viewY = (*viewY < 0) ? 0 : ((*viewY > maxY) ? maxY : *viewY);
+    }
+}
+
+/**
+ * @brief Copies the part of the world under the viewport into display RAM
+ *
+ * @param world World to show
+ * @param ram Receives the viewport
+ * @param viewX Column of the world shown in the leftmost display column
+ * @param viewY Row of the world shown in the top display row
+ * @param wrap True if the world wraps around its edges
+ */
+void conwaysWorldView(ConwaysWorld &world, ConwaysBoard &ram, int32_t viewX, int32_t viewY, bool wrap)
+{
+    conwaysWorldClampView(&viewX, &viewY, wrap);
+
+    for(int32_t page = 0; page < CONWAYS_BOARD_PAGES; page++) {
+        // A page may straddle two bands
+        int32_t y = (viewY + (page * 8)) % CONWAYS_WORLD_HEIGHT;
+        int32_t band = y / CONWAYS_WORLD_BAND_HEIGHT;
+        int32_t shift = y % CONWAYS_WORLD_BAND_HEIGHT;
+        int32_t bandNext = (band + 1) % CONWAYS_WORLD_BANDS;
+
+        for(int32_t column = 0; column < CONWAYS_BOARD_WIDTH; column++) {
+            int32_t x = (viewX + column) % CONWAYS_WORLD_WIDTH;
+            uint32_t bits = world[band][x] >> shift;
+            if(shift > (CONWAYS_WORLD_BAND_HEIGHT - 8)) {
+                bits |= world[bandNext][x] << (CONWAYS_WORLD_BAND_HEIGHT - shift);
+            }
+            ram[page][column] = (uint8_t)bits;
+        }
+    }
+}
@@ -62,6 +62,8 @@ public:
 
 private:
     UBYTE *mImage;
+    // When the last fact went up, for putting an idle display to sleep
+    uint32_t mLastDrawMs;
 
     DrvEPaper mEPaper;
     WS2812 mNeopixel;
@@ -17,6 +17,8 @@ static bool draw_new_fact = false;
 static bool flag_clear_display = false;
 static uint32_t debounce_generate_fact = to_ms_since_boot(get_absolute_time());
 static const uint32_t debounce_delay_time = 1000;
+// Time a display in partial mode is left awake for the next fact
+static const uint32_t display_idle_sleep_ms = 60000;
 
 int32_t application_run()
 {
@@ -43,6 +45,7 @@ void generate_fact(uint gpio, uint32_t events)
 
 Application::Application() :
     mImage(nullptr),
+    mLastDrawMs(0),
     mEPaper(
         spi0,
         pin_spi0_cs,
@@ -125,6 +128,14 @@ void Application::initialize()
     LOG_INFO("Initializing display...\n");
 
     mEPaper.initialize();
+    LOG_DEBUG("Display reset in %u us, initialized in %u us\n", mEPaper.phaseUs(DrvEPaper::PHASE_RESET),
+              mEPaper.phaseUs(DrvEPaper::PHASE_INIT));
+    if(!mEPaper.asyncInit()) {
+        LOG_WARN("Display DMA unavailable, images will be sent blocking\n");
+    }
+    if(!mEPaper.shadowInit()) {
+        LOG_WARN("Display shadow unavailable, images will be sent whole\n");
+    }
     // LOG_INFO("Black out display...\n");
     // mEPaper.fillScreen(0x00);
     LOG_INFO("White out display...\n");
@@ -160,27 +171,33 @@ void Application::drawFact()
     char title[18] = {};
     snprintf(title, 18, "Snapple Fact #%03d", fact);
 
+    // The image is free once uploaded, the last refresh carries on meanwhile
+    mEPaper.waitUpload();
     Paint_NewImage(mImage, EPD_1IN54_V2_WIDTH, EPD_1IN54_V2_HEIGHT, 270, WHITE);
     Paint_Clear(WHITE);
     Paint_DrawString_EN(0, 0, title, &Font16, WHITE, BLACK);
     Paint_DrawLine(0, 16, 200, 16, BLACK, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
     Paint_DrawString_EN(0, 18, Snapple::facts[fact], &Font16, WHITE, BLACK);
     
-    // Draw and then put display to sleep
-    mEPaper.reset();
-    mEPaper.display(mImage);
-    mEPaper.sleep();
+    // Facts follow each other with a partial refresh, which skips the
+    // flashing. The driver brings in a full refresh now and then against
+    // ghosting, and after the display was cleared.
+    uint32_t written = mEPaper.bytesWritten();
+    mEPaper.displayPartial(mImage);
+    mLastDrawMs = to_ms_since_boot(get_absolute_time());
+    LOG_DEBUG("Sent %u bytes, refresh took %u us, %u timeouts\n", mEPaper.bytesWritten() - written,
+              mEPaper.refreshUs(), mEPaper.timeouts());
 }
 
 void Application::clearDisplay()
 {
+    mEPaper.waitUpload();
     Paint_NewImage(mImage, EPD_1IN54_V2_WIDTH, EPD_1IN54_V2_HEIGHT, 270, WHITE);
     Paint_Clear(WHITE);
     
-    // Draw and then put display to sleep
-    mEPaper.reset();
-    mEPaper.display(mImage);
-    mEPaper.sleep();
+    // Draw and then put display to sleep, without waiting for the refresh. The
+    // driver wakes the panel with a reset and init first if it is asleep.
+    mEPaper.displayAsync(mImage, true);
 }
 
 int32_t Application::run()
@@ -203,6 +220,15 @@ int32_t Application::run()
             clearDisplay();
             flag_clear_display = false;
         }
+
+        // Partial mode keeps the panel out of deep sleep between facts, so an
+        // idle one is put to sleep. The partial waveform goes with it and the
+        // next fact comes in with a full refresh.
+        if(mEPaper.partialMode() &&
+           ((to_ms_since_boot(get_absolute_time()) - mLastDrawMs) > display_idle_sleep_ms)) {
+            LOG_INFO("Placing idle display in sleep mode...\n");
+            mEPaper.sleep();
+        }
     }
 
     return 0;
@@ -3,8 +3,10 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
 
 #ifndef OLED_VERSION
 #define OLED_VERSION "Not Found"
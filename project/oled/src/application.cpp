@@ -1,6 +1,8 @@
 #include "common/draw/bmpspritesheet.h"
 #include "common/draw/canvas.h"
 #include "common/drivers/ssd1306.h"
+#include "common/drivers/ssd1306_frame_queue.h"
+#include "common/drivers/ssd1306_grayscale.h"
 #include "common/logger.h"
 
 #include "project/application.h"
@@ -28,11 +30,20 @@
 #define SPRITE_WIDTH    56
 #define SPRITE_HEIGHT   56
 
+// Bit planes making up the grayscale image, and how often per second all of
+// them are shown
+#define GRAYSCALE_PLANES        2
+#define GRAYSCALE_REFRESH_HZ    50
+
 static uint32_t debounce_generate_fact = to_ms_since_boot(get_absolute_time());
 static const uint32_t debounce_delay_time = 250;
 static int32_t dex_number = 1;
 static int8_t trigger_update = 0;
 
+// Sends the planes from the other core when the grayscale presenter is
+// unavailable
+static SSD1306FrameQueue *plane_queue = nullptr;
+
 void generate_fact(uint gpio, uint32_t events)
 {
     uint32_t currentTime = to_ms_since_boot(get_absolute_time());
@@ -64,6 +75,11 @@ void generate_fact(uint gpio, uint32_t events)
 }
 
 
+void present_planes()
+{
+    plane_queue->run();
+}
+
 void index_to_sprite(uint32_t index, BmpSpriteSheet *ss, bmp_sprite_view *sprite)
 {
     // Calculate the x, y coordinates of our pokemon sprite
@@ -140,17 +156,20 @@ int32_t application_run()
     // Initialize SPI
     initialize_spi(spi0);
 
-    ssd1306_spi_device display;
-    display.bus   = spi0;
-    display.cs    = PIN_DISPLAY_CS;
-    display.dc    = PIN_DISPLAY_DC;
-    display.reset = PIN_DISPLAY_RES;
+    SSD1306SpiTransport bus(spi0, PIN_DISPLAY_CS, PIN_DISPLAY_DC, PIN_DISPLAY_RES);
+    SSD1306 display(&bus);
 
     LOG_INFO("Initializing Display...\n");
-    ssd1306_initialize_device(&display);
-    // ssd1306_ignore_ram(&display, true);
+    bus.reset();
+    display.initialize();
+    // Lower contrast, the SPI panel is bright enough
+    display.set_contrast(0x01);
+    if(!bus.dma_init()) {
+        LOG_WARN("Display DMA unavailable, planes will be sent blocking\n");
+    }
+    // display.ignore_ram(true);
     // sleep_ms(500);
-    // ssd1306_ignore_ram(&display, false);
+    // display.ignore_ram(false);
 
     // Initialize our sprite sheets
     BmpSpriteSheet ss;
@@ -192,40 +211,36 @@ int32_t application_run()
     // canvas.width  = OLED_HEIGHT;
     // canvas.image = buffer;
     // canvas_fill(&canvas, 0x0F);
-    ssd1306_reset_cursor(&display);
-    // ssd1306_display(&display, canvas.image, buffer_length);
-    ssd1306_set_addressing(&display, SSD1306_ADDRESSING_VERTICAL);
+    display.reset_cursor();
+    // display.write_buffer(canvas.image, buffer_length);
+    // Configure vertical addressing so that canvas scheme makes sense with how
+    // it's drawn to the screen
+    display.set_addressing_mode(SSD1306::AddressingMode::VERTICAL);
 
     // return 0;
 
 
-    // SSD1306Dev dev = {i2c1, SSD1306_DISPLAY_ADDR};
-    // ssd1306_initialize_device(&dev);
-    // // Lower contrast to save power
-    // ssd1306_set_contrast(&dev, 0x01);
-    // // Configure vertical addressing so that canvas scheme makes sense with how
-    // // it's drawn to the screen
-    // ssd1306_set_addressing(&dev, SSD1306_ADDRESSING_VERTICAL);
-
-
+    // Planes are double buffered. A new sprite is rendered into the back set
+    // while the presenter cycles through the front set.
     uint32_t gs_buffer_length = (image_height_bytes * image_width_bytes);
-    uint8_t *gs_buffer[3] = {NULL, NULL, NULL};
-    Canvas framebuffer[3];
-
-    for(uint32_t i = 0; i < 3; i++) {
-        gs_buffer[i] = (uint8_t*)malloc(gs_buffer_length);
-        framebuffer[i].mirror = CANVAS_MIRROR_NONE;
-        framebuffer[i].rotate = CANVAS_ROTATE_0;
-        framebuffer[i].height = OLED_WIDTH;
-        framebuffer[i].width  = OLED_HEIGHT;
-        framebuffer[i].image = gs_buffer[i];
-        canvas_fill(&framebuffer[i], 0x00);
-        // canvas_draw_grayscale_bmp_sprite(&framebuffer[i], &(ss_grayscale.bitmap), &sprite, i, offset_x, offset_y);
+    uint8_t *gs_buffer[2][GRAYSCALE_PLANES] = {};
+    Canvas framebuffer[2][GRAYSCALE_PLANES];
+
+    for(uint32_t set = 0; set < 2; set++) {
+        for(uint32_t i = 0; i < GRAYSCALE_PLANES; i++) {
+            gs_buffer[set][i] = (uint8_t*)malloc(gs_buffer_length);
+            framebuffer[set][i].mirror = CANVAS_MIRROR_NONE;
+            framebuffer[set][i].rotate = CANVAS_ROTATE_0;
+            framebuffer[set][i].height = OLED_WIDTH;
+            framebuffer[set][i].width  = OLED_HEIGHT;
+            framebuffer[set][i].image = gs_buffer[set][i];
+            canvas_fill(&framebuffer[set][i], 0x00);
+        }
     }
 
     // Reset the cursor and clear the screen so we start with a blank slate
-    ssd1306_reset_cursor(&display);
-    // ssd1306_fill_screen(&dev, 0x00);
+    display.reset_cursor();
+    // display.fill_screen(0x00);
 
     // Print version info to screen, 
     LOG_INFO("   OLED Version: %s\n", OLED_VERSION);
@@ -234,45 +249,83 @@ int32_t application_run()
     // Calculate the ecenter of the screen, to draw the image
     uint32_t offset_y = ((OLED_WIDTH - (SPRITE_WIDTH * sprite.magnify)) / 2);
     uint32_t offset_x = ((OLED_HEIGHT - (SPRITE_WIDTH * sprite.magnify)) / 2);
-    
+
+    // Binary weighted bit planes, the second plane stays on screen twice as
+    // long as the first, which makes four levels out of two planes
+    static const uint8_t plane_weights[GRAYSCALE_PLANES] = {1, 2};
+    ssd1306_grayscale grayscale;
+    bool presenting = ssd1306_grayscale_init(&grayscale, &display, plane_weights, GRAYSCALE_PLANES,
+                                             GRAYSCALE_REFRESH_HZ) &&
+                      ssd1306_grayscale_start(&grayscale, framebuffer[0]);
+    if(!presenting) {
+        LOG_WARN("Grayscale presenter unavailable, planes will be sent from core 1\n");
+        plane_queue = new SSD1306FrameQueue(&display, 2, SSD1306FrameQueue::BLOCK);
+        multicore_launch_core1(present_planes);
+    }
+
     uint32_t dexNumber = 1;
-    uint32_t framestart = 0;
+    uint32_t back = 1;
+    uint32_t framestart = to_ms_since_boot(get_absolute_time());
     uint32_t frameend = 0;
-    uint32_t frames = 0;
     trigger_update = 1;
     do {
-        if(trigger_update) {
+        // The back set is free once the presenter has moved on to the planes
+        // handed over last
+        if(trigger_update && !ssd1306_grayscale_swap_pending(&grayscale)) {
             // Select the pokemon sprite
             index_to_sprite(dex_number, &ss, &sprite);
             // index_to_sprite(1, &ss_font, &font_sprite);
 
-            for(uint32_t layer = 0; layer < 3; layer++) {
-                canvas_draw_grayscale_bmp_sprite(&framebuffer[layer], &(ss_grayscale.bitmap),
-                                                &sprite, layer, offset_x, offset_y);
+            for(uint32_t plane = 0; plane < GRAYSCALE_PLANES; plane++) {
+                canvas_draw_grayscale_bmp_bitplane(&framebuffer[back][plane], &(ss_grayscale.bitmap),
+                                                   &sprite, plane, offset_x, offset_y);
             }
+            ssd1306_grayscale_present(&grayscale, framebuffer[back]);
+            back ^= 1;
             trigger_update = 0;
         }
 
-        // frames = 0;
-        // framestart = to_ms_since_boot(get_absolute_time());
-        // frameend = framestart;
-        // while((frameend - framestart) < 1000) {
-        for(uint32_t i = 0; i < 3; i++) {
-            // We shouldn't have to reset the cursor if the entire screen is
-            // being written, the display will automaatically wraparound
-            ssd1306_display(&display, gs_buffer[i], gs_buffer_length);
+        if(presenting) {
+            sleep_ms(10);
+        } else {
+            // Planes are repeated to approximate their weights. Queueing one
+            // blocks while core 1 is still sending the one before.
+            for(uint32_t plane = 0; plane < GRAYSCALE_PLANES; plane++) {
+                for(uint32_t i = 0; i < plane_weights[plane]; i++) {
+                    SSD1306::DisplayRamWrite *frame = plane_queue->acquire();
+                    memcpy(frame->ram, gs_buffer[back ^ 1][plane], gs_buffer_length);
+                    plane_queue->submit(frame);
+                }
+            }
+        }
+
+        frameend = to_ms_since_boot(get_absolute_time());
+        if((frameend - framestart) >= 1000) {
+            if(presenting) {
+                ssd1306_grayscale_stats stats;
+                ssd1306_grayscale_get_stats(&grayscale, &stats);
+                LOG_INFO("%u Hz, planes %u/%u us, slot %u us, bus %u us, %u overruns\n", stats.refresh_hz,
+                         stats.plane_us[0], stats.plane_us[1], stats.slot_us, stats.transfer_us, stats.overruns);
+            } else {
+                SSD1306FrameQueue::Stats stats;
+                plane_queue->get_stats(&stats);
+                plane_queue->reset_stats();
+                LOG_INFO("%u planes, bus %u us, latency %u us, %u waits\n", stats.presented, stats.present_us,
+                         stats.latency_avg_us, stats.producer_waits);
+            }
+            framestart = frameend;
         }
-        //     frames += 1;
-        //     frameend = to_ms_since_boot(get_absolute_time());
-        // }
     } while(true);
 
     // Cleanup
     // free(buffer);
+    ssd1306_grayscale_stop(&grayscale);
 
-    for(uint i = 0; i < 3; i++) {
-        free(gs_buffer[i]);
-        gs_buffer[i] = NULL;
+    for(uint set = 0; set < 2; set++) {
+        for(uint i = 0; i < GRAYSCALE_PLANES; i++) {
+            free(gs_buffer[set][i]);
+            gs_buffer[set][i] = NULL;
+        }
     }
 
     return success;
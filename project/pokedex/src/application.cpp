@@ -153,6 +153,12 @@ int32_t application_run()
     // Initialize epaper driver and a blank image buffer
     DrvEPaper paper(spi0, PIN_SPI0_CS, PIN_DISPLAY_CD, PIN_DISPLAY_BUSY, PIN_DISPLAY_RESET);
     paper.initialize();
+    if(!paper.asyncInit()) {
+        printf("Display DMA unavailable, images will be sent blocking\n");
+    }
+    if(!paper.shadowInit()) {
+        printf("Display shadow unavailable, images will be sent whole\n");
+    }
     paper.fillScreen(0xFF);
 
     // Initialize the sprite sheet we will be using to draw bitmaps
@@ -175,7 +181,6 @@ int32_t application_run()
     // canvas_draw_point(&canvas, 20, 20, CanvasColor::BLACK, CanvasPointSize::PIXEL_4X4);
     printf("Black out the screen\n");
     paper.display(canvas.image);
-    paper.sleep();
 
     // sleep_ms(5000);
 
@@ -234,10 +239,17 @@ int32_t application_run()
             canvas_draw_bmp_sprite(&canvas, &(ss_font.bitmap), &sprite, char_offset_x, char_offset_y);
         }
 
-        paper.reset();
-        paper.display(canvas.image);
-        paper.sleep();
-
+        // The panel is kept awake between entries, leaving deep sleep takes a
+        // reset that loses the RAM and would send each entry whole. Awake,
+        // only the rows that differ from the last entry go out, and each
+        // refresh powers the analog side down once done.
+        uint32_t written = paper.bytesWritten();
+        paper.displayAsync(canvas.image);
+
+        // The canvas is free again once uploaded, the refresh carries on
+        // from the panel RAM
+        paper.waitUpload();
+        printf("Sent %u bytes\n", paper.bytesWritten() - written);
         canvas_fill(&canvas, 0xFF);
         sleep_ms(5000);
     }
@@ -0,0 +1,519 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <vector>
+
+#include "project/kernel.h"
+#include "project/world.h"
+#include "project/hashlife.h"
+#include "project/pattern.h"
+#include "project/rule.h"
+
+#define HOST_NODES          (1 << 20)
+#define HOST_BUCKETS        (1 << 19)
+#define HOST_MAX_LEVEL      40
+#define HOST_GENERATIONS    2000
+
+/**
+ * @brief Kernel as run by the game loop, with or without tile tracking
+ */
+struct Engine {
+    const char *name;
+    ConwaysEngine engine;
+    bool tracking;
+};
+
+static const Engine host_engines[] = {
+    {"cell", CONWAYS_ENGINE_CELL, false},
+    {"swar", CONWAYS_ENGINE_SWAR, false},
+    {"swar+tiles", CONWAYS_ENGINE_SWAR, true},
+};
+static const uint32_t host_engine_count = sizeof(host_engines) / sizeof(host_engines[0]);
+
+static std::vector<char> host_library;
+
+/**
+ * @brief Pair of boards stepped back and forth like the game loop does. The
+ * current generation is in board[generation & 1].
+ */
+struct Game {
+    ConwaysBoard board[2];
+    ConwaysTiles tiles;
+    uint32_t generation;
+};
+
+static double seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + (now.tv_nsec / 1e9);
+}
+
+static int32_t libraryRead(const char *file)
+{
+    FILE *fp = fopen(file, "rb");
+    if(fp == NULL) {
+        printf("Failed to open %s\n", file);
+        return -1;
+    }
+
+    char buffer[4096];
+    size_t length = 0;
+    while((length = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        host_library.insert(host_library.end(), buffer, buffer + length);
+    }
+    fclose(fp);
+    return 0;
+}
+
+static void boardRun(void *context, int32_t x, int32_t y, int32_t length)
+{
+    ConwaysBoard &board = *static_cast<ConwaysBoard*>(context);
+    for(int32_t i = 0; i < length; i++) {
+        board[y / 8][x + i] |= (1 << (y % 8));
+    }
+}
+
+static bool boardGet(ConwaysBoard &board, int32_t x, int32_t y)
+{
+    return (board[y / 8][x] >> (y % 8)) & 0x01;
+}
+
+static uint32_t boardPopulation(ConwaysBoard &board)
+{
+    uint32_t population = 0;
+    for(uint32_t page = 0; page < CONWAYS_BOARD_PAGES; page++) {
+        for(uint32_t column = 0; column < CONWAYS_BOARD_WIDTH; column++) {
+            population += __builtin_popcount(board[page][column]);
+        }
+    }
+    return population;
+}
+
+static int32_t boardPlace(ConwaysBoard &board, const char *name, int32_t x, int32_t y)
+{
+    ConwaysPattern pattern;
+    if(conwaysPatternFind(host_library.data(), host_library.size(), name, &pattern) != 0) {
+        printf("No pattern named %s\n", name);
+        return -1;
+    }
+    conwaysPatternDecode(&pattern, boardRun, &board, x, y, CONWAYS_BOARD_WIDTH, CONWAYS_BOARD_HEIGHT);
+    return 0;
+}
+
+static void gameStart(Game *game, const char *name, int32_t x, int32_t y)
+{
+    memset(game, 0, sizeof(Game));
+    conwaysTilesMarkAll(&game->tiles);
+    if(name) {
+        boardPlace(game->board[0], name, x, y);
+    }
+}
+
+static void gameSoup(Game *game, uint32_t seed)
+{
+    gameStart(game, nullptr, 0, 0);
+    srand(seed);
+    for(uint32_t page = 0; page < CONWAYS_BOARD_PAGES; page++) {
+        for(uint32_t column = 0; column < CONWAYS_BOARD_WIDTH; column++) {
+            game->board[0][page][column] = rand();
+        }
+    }
+}
+
+static ConwaysBoard &gameBoard(Game *game)
+{
+    return game->board[game->generation & 1];
+}
+
+static void gameStep(Game *game, const Engine *engine, ConwaysRule rule, uint32_t generations)
+{
+    ConwaysKernel kernel = conwaysGetKernel(engine->engine, rule);
+    for(uint32_t i = 0; i < generations; i++) {
+        if(!engine->tracking) {
+            conwaysTilesMarkAll(&game->tiles);
+        }
+        ConwaysBoard &cur = game->board[game->generation & 1];
+        ConwaysBoard &nxt = game->board[(game->generation + 1) & 1];
+        kernel(cur, nxt, false, 0, CONWAYS_BOARD_PAGES, &game->tiles);
+        conwaysTilesUpdate(&game->tiles);
+        game->generation++;
+    }
+}
+
+/**
+ * @brief Plain cell by cell reference the kernels are checked against
+ */
+static void referenceStep(ConwaysBoard &board, ConwaysRule rule)
+{
+    ConwaysBoard next = {};
+    for(int32_t y = 0; y < CONWAYS_BOARD_HEIGHT; y++) {
+        for(int32_t x = 0; x < CONWAYS_BOARD_WIDTH; x++) {
+            int32_t neighbors = 0;
+            for(int32_t dy = -1; dy <= 1; dy++) {
+                for(int32_t dx = -1; dx <= 1; dx++) {
+                    int32_t nx = x + dx;
+                    int32_t ny = y + dy;
+                    if(((dx != 0) || (dy != 0)) && (nx >= 0) && (nx < CONWAYS_BOARD_WIDTH) &&
+                       (ny >= 0) && (ny < CONWAYS_BOARD_HEIGHT)) {
+                        neighbors += boardGet(board, nx, ny);
+                    }
+                }
+            }
+            uint16_t mask = boardGet(board, x, y) ? conways_rules[rule].survive : conways_rules[rule].birth;
+            if((mask >> neighbors) & 1) {
+                next[y / 8][x] |= (1 << (y % 8));
+            }
+        }
+    }
+    memcpy(board, next, sizeof(ConwaysBoard));
+}
+
+static int32_t check(bool pass, const char *test, const Engine *engine, const char *detail)
+{
+    if(!pass) {
+        printf("FAIL %s (%s): %s\n", test, engine ? engine->name : "-", detail);
+    }
+    return pass ? 0 : -1;
+}
+
+/**
+ * @brief A glider moves one cell down and to the right every four generations
+ */
+static int32_t testGlider(const Engine *engine)
+{
+    Game game;
+    gameStart(&game, "glider", 10, 10);
+    gameStep(&game, engine, CONWAYS_RULE_LIFE, 40);
+
+    ConwaysBoard expected = {};
+    boardPlace(expected, "glider", 20, 20);
+    return check(memcmp(gameBoard(&game), expected, sizeof(ConwaysBoard)) == 0, "glider", engine,
+                 "not moved by 10 cells in 40 generations");
+}
+
+static int32_t testBlinker(const Engine *engine)
+{
+    Game game;
+    gameStart(&game, "blinker", 60, 30);
+    ConwaysBoard start;
+    memcpy(start, gameBoard(&game), sizeof(ConwaysBoard));
+
+    gameStep(&game, engine, CONWAYS_RULE_LIFE, 1);
+    int32_t error = check(memcmp(gameBoard(&game), start, sizeof(ConwaysBoard)) != 0, "blinker", engine,
+                          "did not change phase");
+    error |= check(boardGet(gameBoard(&game), 61, 29) && boardGet(gameBoard(&game), 61, 31) &&
+                   (boardPopulation(gameBoard(&game)) == 3), "blinker", engine, "not vertical after one generation");
+
+    gameStep(&game, engine, CONWAYS_RULE_LIFE, 1);
+    error |= check(memcmp(gameBoard(&game), start, sizeof(ConwaysBoard)) == 0, "blinker", engine,
+                   "period is not 2");
+    return error;
+}
+
+/**
+ * @brief The gun keeps its shape and adds a five cell glider every 30
+ * generations
+ */
+static int32_t testGun(const Engine *engine)
+{
+    Game game;
+    gameStart(&game, "gosperglidergun", 1, 1);
+    int32_t error = 0;
+    for(uint32_t period = 1; period <= 3; period++) {
+        gameStep(&game, engine, CONWAYS_RULE_LIFE, 30);
+        error |= check(boardPopulation(gameBoard(&game)) == (36 + (5 * period)), "gun", engine,
+                       "wrong population after a period");
+    }
+    return error;
+}
+
+/**
+ * @brief The R-pentomino against the reference, long enough for its debris
+ * to run into the edges of the board
+ */
+static int32_t testRPentomino(const Engine *engine)
+{
+    Game game;
+    gameStart(&game, "rpentomino", 62, 30);
+    ConwaysBoard reference;
+    memcpy(reference, gameBoard(&game), sizeof(ConwaysBoard));
+
+    int32_t error = 0;
+    for(uint32_t generation = 0; (generation < 1200) && (error == 0); generation++) {
+        gameStep(&game, engine, CONWAYS_RULE_LIFE, 1);
+        referenceStep(reference, CONWAYS_RULE_LIFE);
+        error = check(memcmp(gameBoard(&game), reference, sizeof(ConwaysBoard)) == 0, "rpentomino", engine,
+                      "differs from the reference");
+    }
+    return error;
+}
+
+/**
+ * @brief Every rule against the reference, starting from a random soup
+ */
+static int32_t testRules(const Engine *engine)
+{
+    int32_t error = 0;
+    for(uint32_t rule = 0; (rule < CONWAYS_RULE_MAX) && (error == 0); rule++) {
+        Game game;
+        gameSoup(&game, rule);
+        ConwaysBoard reference;
+        memcpy(reference, gameBoard(&game), sizeof(ConwaysBoard));
+
+        for(uint32_t generation = 0; (generation < 100) && (error == 0); generation++) {
+            gameStep(&game, engine, (ConwaysRule)rule, 1);
+            referenceStep(reference, (ConwaysRule)rule);
+            error = check(memcmp(gameBoard(&game), reference, sizeof(ConwaysBoard)) == 0, "rules", engine,
+                          conways_rules[rule].notation);
+        }
+    }
+    return error;
+}
+
+/**
+ * @brief The world kernel and HashLife against the board kernel. A pattern
+ * that keeps clear of the edges evolves the same on any of them.
+ */
+static int32_t testEngines()
+{
+    static ConwaysWorld world[2];
+    static ConwaysBoard board;
+    const uint32_t generations = 100;
+
+    Game game;
+    gameStart(&game, "rpentomino", 62, 30);
+    gameStep(&game, &host_engines[1], CONWAYS_RULE_LIFE, generations);
+
+    // The same pattern in the world, with the board in its top left corner
+    memset(world, 0, sizeof(world));
+    ConwaysPattern pattern;
+    conwaysPatternFind(host_library.data(), host_library.size(), "rpentomino", &pattern);
+    conwaysPatternDecode(&pattern, [](void *context, int32_t x, int32_t y, int32_t length) {
+        ConwaysWorld &world = *static_cast<ConwaysWorld*>(context);
+        for(int32_t i = 0; i < length; i++) {
+            world[y / CONWAYS_WORLD_BAND_HEIGHT][x + i] |= (1 << (y % CONWAYS_WORLD_BAND_HEIGHT));
+        }
+    }, &world[0], 62, 30, CONWAYS_WORLD_WIDTH, CONWAYS_WORLD_HEIGHT);
+    for(uint32_t generation = 0; generation < generations; generation++) {
+        conwaysWorldStep(world[generation & 1], world[(generation + 1) & 1], false);
+    }
+    conwaysWorldView(world[generations & 1], board, 0, 0, false);
+    int32_t error = check(memcmp(board, gameBoard(&game), sizeof(ConwaysBoard)) == 0, "world", nullptr,
+                          "differs from the board kernel");
+
+    std::vector<HashLife::Node> nodes(HOST_NODES);
+    std::vector<uint32_t> buckets(HOST_BUCKETS);
+    HashLife life(nodes.data(), nodes.size(), buckets.data(), buckets.size(), HOST_MAX_LEVEL);
+
+    ConwaysBoard start = {};
+    boardPlace(start, "rpentomino", 62, 30);
+    life.load([](void *context, int32_t x, int32_t y) {
+        return boardGet(*static_cast<ConwaysBoard*>(context), x, y);
+    }, &start, CONWAYS_BOARD_WIDTH, CONWAYS_BOARD_HEIGHT);
+    life.advance(generations);
+    memset(board, 0, sizeof(board));
+    life.render([](void *context, int32_t x, int32_t y) {
+        boardRun(context, x, y, 1);
+    }, &board, CONWAYS_BOARD_WIDTH, CONWAYS_BOARD_HEIGHT);
+    error |= check(memcmp(board, gameBoard(&game), sizeof(ConwaysBoard)) == 0, "hashlife", nullptr,
+                   "differs from the board kernel");
+
+    // Left to itself on an unbounded plane the R-pentomino settles at 116 cells
+    life.load([](void *context, int32_t x, int32_t y) {
+        return boardGet(*static_cast<ConwaysBoard*>(context), x, y);
+    }, &start, CONWAYS_BOARD_WIDTH, CONWAYS_BOARD_HEIGHT);
+    life.advance(1103);
+    error |= check(life.population() == 116, "hashlife", nullptr, "R-pentomino does not settle at 116 cells");
+
+    return error;
+}
+
+static bool hashLifeBoardGet(void *context, int32_t x, int32_t y)
+{
+    return boardGet(*static_cast<ConwaysBoard*>(context), x, y);
+}
+
+static void hashLifeBoardSet(void *context, int32_t x, int32_t y)
+{
+    boardRun(context, x, y, 1);
+}
+
+/**
+ * @brief Runs a board through bounded HashLife and checks it against the
+ * board kernel. The same run on an unbounded plane has to come out different,
+ * or the pattern never reached an edge.
+ */
+static int32_t testHashLifeBoard(HashLife &life, Game *game, uint32_t generations, const char *detail)
+{
+    static ConwaysBoard start;
+    static ConwaysBoard board;
+    memcpy(start, gameBoard(game), sizeof(ConwaysBoard));
+    gameStep(game, &host_engines[1], CONWAYS_RULE_LIFE, generations);
+
+    life.load(hashLifeBoardGet, &start, CONWAYS_BOARD_WIDTH, CONWAYS_BOARD_HEIGHT, true);
+    int32_t error = check(life.advance(generations) == 0, "edges", nullptr, "ran out of nodes");
+    memset(board, 0, sizeof(board));
+    life.render(hashLifeBoardSet, &board, CONWAYS_BOARD_WIDTH, CONWAYS_BOARD_HEIGHT);
+    error |= check(memcmp(board, gameBoard(game), sizeof(ConwaysBoard)) == 0, "edges", nullptr, detail);
+
+    life.load(hashLifeBoardGet, &start, CONWAYS_BOARD_WIDTH, CONWAYS_BOARD_HEIGHT);
+    life.advance(generations);
+    memset(board, 0, sizeof(board));
+    life.render(hashLifeBoardSet, &board, CONWAYS_BOARD_WIDTH, CONWAYS_BOARD_HEIGHT);
+    error |= check(memcmp(board, gameBoard(game), sizeof(ConwaysBoard)) != 0, "edges", nullptr,
+                   "pattern never reached an edge");
+    return error;
+}
+
+/**
+ * @brief Bounded HashLife against the board and world kernels, with patterns
+ * that run into the edges
+ */
+static int32_t testHashLifeEdges()
+{
+    static ConwaysWorld world[2];
+    const uint32_t generations = 300;
+
+    std::vector<HashLife::Node> nodes(HOST_NODES);
+    std::vector<uint32_t> buckets(HOST_BUCKETS);
+    HashLife life(nodes.data(), nodes.size(), buckets.data(), buckets.size(), HOST_MAX_LEVEL);
+
+    // The R-pentomino spreads to every edge of the board long before it dies
+    // down, a soup starts out touching all of them
+    Game game;
+    gameStart(&game, "rpentomino", 62, 30);
+    int32_t error = testHashLifeBoard(life, &game, 1000, "R-pentomino differs from the board kernel");
+    gameSoup(&game, 7);
+    error |= testHashLifeBoard(life, &game, generations, "soup differs from the board kernel");
+
+    // The R-pentomino in a corner of the world, which it runs into at once
+    memset(world, 0, sizeof(world));
+    ConwaysPattern pattern;
+    conwaysPatternFind(host_library.data(), host_library.size(), "rpentomino", &pattern);
+    conwaysPatternDecode(&pattern, [](void *context, int32_t x, int32_t y, int32_t length) {
+        ConwaysWorld &world = *static_cast<ConwaysWorld*>(context);
+        for(int32_t i = 0; i < length; i++) {
+            world[y / CONWAYS_WORLD_BAND_HEIGHT][x + i] |= (1 << (y % CONWAYS_WORLD_BAND_HEIGHT));
+        }
+    }, &world[0], 1, 1, CONWAYS_WORLD_WIDTH, CONWAYS_WORLD_HEIGHT);
+
+    auto worldGet = [](void *context, int32_t x, int32_t y) {
+        ConwaysWorld &world = *static_cast<ConwaysWorld*>(context);
+        return ((world[y / CONWAYS_WORLD_BAND_HEIGHT][x] >> (y % CONWAYS_WORLD_BAND_HEIGHT)) & 1) != 0;
+    };
+    life.load(worldGet, &world[0], CONWAYS_WORLD_WIDTH, CONWAYS_WORLD_HEIGHT, true);
+    error |= check(life.advance(generations) == 0, "edges", nullptr, "ran out of nodes in the world");
+
+    // An even number of generations leaves the kernel result in world[0]
+    for(uint32_t generation = 0; generation < generations; generation++) {
+        conwaysWorldStep(world[generation & 1], world[(generation + 1) & 1], false);
+    }
+    memset(world[1], 0, sizeof(ConwaysWorld));
+    life.render([](void *context, int32_t x, int32_t y) {
+        ConwaysWorld &world = *static_cast<ConwaysWorld*>(context);
+        world[y / CONWAYS_WORLD_BAND_HEIGHT][x] |= (1 << (y % CONWAYS_WORLD_BAND_HEIGHT));
+    }, &world[1], CONWAYS_WORLD_WIDTH, CONWAYS_WORLD_HEIGHT);
+    error |= check(memcmp(world[0], world[1], sizeof(ConwaysWorld)) == 0, "edges", nullptr,
+                   "world corner differs from the world kernel");
+    return error;
+}
+
+static int32_t runTests()
+{
+    using Test = int32_t (*)(const Engine *engine);
+    static const struct {
+        const char *name;
+        Test test;
+    } tests[] = {
+        {"glider", testGlider},
+        {"blinker", testBlinker},
+        {"gun", testGun},
+        {"rpentomino", testRPentomino},
+        {"rules", testRules},
+    };
+
+    int32_t failures = 0;
+    for(const auto &test : tests) {
+        for(uint32_t engine = 0; engine < host_engine_count; engine++) {
+            int32_t error = test.test(&host_engines[engine]);
+            printf("%s %s (%s)\n", error ? "FAIL" : "pass", test.name, host_engines[engine].name);
+            failures += (error != 0);
+        }
+    }
+    int32_t error = testEngines();
+    printf("%s engines\n", error ? "FAIL" : "pass");
+    failures += (error != 0);
+    error = testHashLifeEdges();
+    printf("%s edges\n", error ? "FAIL" : "pass");
+    failures += (error != 0);
+
+    printf("%d failures\n", failures);
+    return failures;
+}
+
+/**
+ * @brief Generation rate of every engine under every rule on a random soup,
+ * and on the gun, where tile tracking gets to skip most of the board
+ */
+static void runBenchmark(uint32_t generations)
+{
+    printf("%-12s %-14s %12s\n", "engine", "rule", "gen/s");
+    for(uint32_t engine = 0; engine < host_engine_count; engine++) {
+        for(uint32_t rule = 0; rule < CONWAYS_RULE_MAX; rule++) {
+            Game game;
+            gameSoup(&game, 1);
+            double start = seconds();
+            gameStep(&game, &host_engines[engine], (ConwaysRule)rule, generations);
+            double elapsed = seconds() - start;
+            printf("%-12s %-14s %12.0f\n", host_engines[engine].name, conways_rules[rule].notation,
+                   generations / elapsed);
+        }
+    }
+
+    for(uint32_t engine = 0; engine < host_engine_count; engine++) {
+        Game game;
+        gameStart(&game, "gosperglidergun", 1, 1);
+        double start = seconds();
+        gameStep(&game, &host_engines[engine], CONWAYS_RULE_LIFE, generations);
+        double elapsed = seconds() - start;
+        printf("%-12s %-14s %12.0f\n", host_engines[engine].name, "gun", generations / elapsed);
+    }
+
+    static ConwaysWorld world[2];
+    conwaysWorldRandom(world[0]);
+    uint32_t worldGenerations = generations / 10;
+    double start = seconds();
+    for(uint32_t generation = 0; generation < worldGenerations; generation++) {
+        conwaysWorldStep(world[generation & 1], world[(generation + 1) & 1], true);
+    }
+    double elapsed = seconds() - start;
+    printf("%-12s %-14s %12.0f\n", "world", conways_rules[CONWAYS_RULE_LIFE].notation, worldGenerations / elapsed);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *mode = (argc > 1) ? argv[1] : "all";
+    uint32_t generations = (argc > 2) ? strtoul(argv[2], NULL, 0) : HOST_GENERATIONS;
+    if((strcmp(mode, "test") != 0) && (strcmp(mode, "bench") != 0) && (strcmp(mode, "all") != 0)) {
+        printf("Usage: %s [test|bench|all] [generations]\n", argv[0]);
+        return 1;
+    }
+
+    if(libraryRead(CONWAYS_PATTERNS) != 0) {
+        return 1;
+    }
+
+    int32_t failures = 0;
+    if(strcmp(mode, "bench") != 0) {
+        failures = runTests();
+    }
+    if(strcmp(mode, "test") != 0) {
+        runBenchmark(generations);
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+#ifndef HOST_HARDWARE_DMA_H
+#define HOST_HARDWARE_DMA_H
+
+#include "pico/types.h"
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0
+};
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+// No channel is ever free, so updates take the blocking path
+inline int dma_claim_unused_channel(bool)
+{
+    return -1;
+}
+
+inline dma_channel_config dma_channel_get_default_config(uint)
+{
+    return {0};
+}
+
+inline void channel_config_set_transfer_data_size(dma_channel_config *, enum dma_channel_transfer_size)
+{
+}
+
+inline void channel_config_set_read_increment(dma_channel_config *, bool)
+{
+}
+
+inline void channel_config_set_write_increment(dma_channel_config *, bool)
+{
+}
+
+inline void channel_config_set_dreq(dma_channel_config *, uint)
+{
+}
+
+inline void dma_channel_configure(uint, const dma_channel_config *, volatile void *, const volatile void *, uint,
+                                  bool)
+{
+}
+
+inline void dma_channel_transfer_from_buffer_now(uint, const volatile void *, uint32_t)
+{
+}
+
+inline void dma_channel_set_irq0_enabled(uint, bool)
+{
+}
+
+inline bool dma_channel_get_irq0_status(uint)
+{
+    return false;
+}
+
+inline void dma_channel_acknowledge_irq0(uint)
+{
+}
+
+inline void dma_channel_abort(uint)
+{
+}
+
+#endif // HOST_HARDWARE_DMA_H
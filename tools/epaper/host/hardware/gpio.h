@@ -0,0 +1,39 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include "pico/types.h"
+#include "hardware/irq.h"
+
+#define GPIO_IN     0
+#define GPIO_OUT    1
+
+enum gpio_irq_level {
+    GPIO_IRQ_EDGE_FALL = 0x4u
+};
+
+// Defined by the harness, which follows the pins the panel listens to
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+
+inline void gpio_set_dir(uint, bool)
+{
+}
+
+inline void gpio_set_irq_enabled(uint, uint32_t, bool)
+{
+}
+
+inline void gpio_add_raw_irq_handler(uint, irq_handler_t)
+{
+}
+
+inline uint32_t gpio_get_irq_event_mask(uint)
+{
+    return 0;
+}
+
+inline void gpio_acknowledge_irq(uint, uint32_t)
+{
+}
+
+#endif // HOST_HARDWARE_GPIO_H
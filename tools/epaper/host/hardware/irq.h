@@ -0,0 +1,21 @@
+#ifndef HOST_HARDWARE_IRQ_H
+#define HOST_HARDWARE_IRQ_H
+
+#include "pico/types.h"
+
+#define IO_IRQ_BANK0    13
+#define DMA_IRQ_0       11
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+typedef void (*irq_handler_t)(void);
+
+// Interrupts never fire on the host
+inline void irq_set_enabled(uint, bool)
+{
+}
+
+inline void irq_add_shared_handler(uint, irq_handler_t, uint8_t)
+{
+}
+
+#endif // HOST_HARDWARE_IRQ_H
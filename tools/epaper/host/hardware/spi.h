@@ -0,0 +1,31 @@
+#ifndef HOST_HARDWARE_SPI_H
+#define HOST_HARDWARE_SPI_H
+
+#include "pico/types.h"
+
+typedef struct spi_inst spi_inst_t;
+
+typedef struct {
+    uint32_t dr;
+} spi_hw_t;
+
+// Defined by the harness, which feeds the bytes to the panel
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+
+inline bool spi_is_busy(const spi_inst_t *)
+{
+    return false;
+}
+
+inline spi_hw_t *spi_get_hw(spi_inst_t *)
+{
+    static spi_hw_t hw;
+    return &hw;
+}
+
+inline uint spi_get_dreq(spi_inst_t *, bool)
+{
+    return 0;
+}
+
+#endif // HOST_HARDWARE_SPI_H
@@ -0,0 +1,16 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+inline void __wfe()
+{
+}
+
+inline void __sev()
+{
+}
+
+inline void tight_loop_contents()
+{
+}
+
+#endif // HOST_HARDWARE_SYNC_H
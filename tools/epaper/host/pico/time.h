@@ -0,0 +1,41 @@
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+#include "pico/types.h"
+
+typedef uint64_t absolute_time_t;
+
+// Defined by the harness
+absolute_time_t get_absolute_time();
+uint64_t to_us_since_boot(absolute_time_t t);
+
+inline absolute_time_t from_us_since_boot(uint64_t us)
+{
+    return us;
+}
+
+inline absolute_time_t make_timeout_time_ms(uint32_t ms)
+{
+    return get_absolute_time() + (ms * 1000ULL);
+}
+
+inline bool time_reached(absolute_time_t t)
+{
+    return get_absolute_time() >= t;
+}
+
+inline bool best_effort_wfe_or_timeout(absolute_time_t t)
+{
+    return time_reached(t);
+}
+
+// The panel answers at once, there is nothing to wait for
+inline void sleep_ms(uint32_t)
+{
+}
+
+inline void sleep_us(uint64_t)
+{
+}
+
+#endif // HOST_PICO_TIME_H
@@ -0,0 +1,9 @@
+#ifndef HOST_PICO_TYPES_H
+#define HOST_PICO_TYPES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#endif // HOST_PICO_TYPES_H
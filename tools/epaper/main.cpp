@@ -0,0 +1,552 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <vector>
+
+#include "common/logger.h"
+#include "common/drivers/epaper.h"
+
+#define HOST_PIN_DC     8
+#define HOST_PIN_CS     9
+#define HOST_PIN_RESET  12
+#define HOST_PIN_BUSY   13
+
+// RAM rows the panel has, the image rows map onto them bottom up
+#define HOST_RAM_ROWS   EPD_1IN54_V2_HEIGHT
+
+absolute_time_t get_absolute_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * 1000000ULL) + (now.tv_nsec / 1000);
+}
+
+uint64_t to_us_since_boot(absolute_time_t t)
+{
+    return t;
+}
+
+uint64_t time_us_64()
+{
+    return get_absolute_time();
+}
+
+/**
+ * @brief Write to a RAM plane, with the window in image coordinates
+ */
+struct RamWrite {
+    uint8_t ram;
+    DrvEPaper::Window window;
+    uint32_t bytes;
+};
+
+/**
+ * @brief Controller RAM and address registers, rebuilt from the bytes on the
+ * bus. Covers the commands that address the RAM, X first only, the rest are
+ * taken and ignored.
+ */
+struct Panel {
+    uint8_t bw[HOST_RAM_ROWS][EPD_1IN54_V2_WIDTH_BYTES];
+    uint8_t red[HOST_RAM_ROWS][EPD_1IN54_V2_WIDTH_BYTES];
+    uint8_t entryMode;
+    uint8_t xStart, xEnd, x;
+    uint16_t yStart, yEnd, y;
+    uint8_t command;
+    uint8_t args[4];
+    uint32_t argCount;
+    bool dataCommand;
+    bool outside;
+    std::vector<RamWrite> writes;
+};
+
+static Panel host_panel;
+
+/**
+ * @brief Puts the registers back to their power-on values. The RAM is not
+ * known to survive, so it is scrambled to catch an update that relies on it.
+ */
+static void panelReset(Panel *panel, bool ram)
+{
+    if(ram) {
+        memset(panel->bw, 0xA5, sizeof(panel->bw));
+        memset(panel->red, 0x5A, sizeof(panel->red));
+    }
+    panel->entryMode = 0x03;
+    panel->xStart = panel->x = 0;
+    panel->xEnd = EPD_1IN54_V2_WIDTH_BYTES - 1;
+    panel->yStart = panel->y = 0;
+    panel->yEnd = HOST_RAM_ROWS - 1;
+    panel->command = 0;
+    panel->argCount = 0;
+}
+
+static void panelInit(Panel *panel)
+{
+    panelReset(panel, true);
+    panel->dataCommand = true;
+    panel->outside = false;
+    panel->writes.clear();
+}
+
+static void panelCommand(Panel *panel, uint8_t command)
+{
+    panel->command = command;
+    panel->argCount = 0;
+    if(command == DrvEPaper::SW_RESET) {
+        panelReset(panel, false);
+    } else if((command == DrvEPaper::WRITE_RAM_BW) || (command == DrvEPaper::WRITE_RAM_RED)) {
+        uint32_t top = (HOST_RAM_ROWS - 1) - panel->yStart;
+        uint32_t bottom = (HOST_RAM_ROWS - 1) - panel->yEnd;
+        panel->writes.push_back({ command, { panel->xStart, top, panel->xEnd, bottom }, 0 });
+    }
+}
+
+/**
+ * @brief Stores a byte at the address counters and moves them on, through the
+ * window in the directions set by the data entry mode
+ */
+static void panelRam(Panel *panel, uint8_t byte)
+{
+    if((panel->y >= HOST_RAM_ROWS) || (panel->x >= EPD_1IN54_V2_WIDTH_BYTES)) {
+        panel->outside = true;
+        return;
+    }
+    uint8_t (*plane)[EPD_1IN54_V2_WIDTH_BYTES] = (panel->command == DrvEPaper::WRITE_RAM_BW) ? panel->bw : panel->red;
+    plane[panel->y][panel->x] = byte;
+    panel->writes.back().bytes++;
+
+    if(panel->x != panel->xEnd) {
+        panel->x += (panel->entryMode & 0x01) ? 1 : -1;
+        return;
+    }
+    panel->x = panel->xStart;
+    if(panel->y != panel->yEnd) {
+        panel->y += (panel->entryMode & 0x02) ? 1 : -1;
+    } else {
+        panel->y = panel->yStart;
+    }
+}
+
+static void panelData(Panel *panel, uint8_t byte)
+{
+    uint32_t arg = panel->argCount++;
+    if(arg < sizeof(panel->args)) {
+        panel->args[arg] = byte;
+    }
+
+    switch(panel->command) {
+        case DrvEPaper::DATA_ENTRY_MODE:
+            panel->entryMode = byte;
+            break;
+        case DrvEPaper::RAM_X_ADDR:
+            if(arg == 1) {
+                panel->xStart = panel->args[0];
+                panel->xEnd = panel->args[1];
+            }
+            break;
+        case DrvEPaper::RAM_Y_ADDR:
+            if(arg == 3) {
+                panel->yStart = panel->args[0] | (panel->args[1] << 8);
+                panel->yEnd = panel->args[2] | (panel->args[3] << 8);
+            }
+            break;
+        case DrvEPaper::RAM_X_COUNTER:
+            panel->x = byte;
+            break;
+        case DrvEPaper::RAM_Y_COUNTER:
+            if(arg == 1) {
+                panel->y = panel->args[0] | (panel->args[1] << 8);
+            }
+            break;
+        case DrvEPaper::WRITE_RAM_BW:
+        case DrvEPaper::WRITE_RAM_RED:
+            panelRam(panel, byte);
+            break;
+        default:
+            break;
+    }
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    if(gpio == HOST_PIN_DC) {
+        host_panel.dataCommand = value;
+    } else if((gpio == HOST_PIN_RESET) && !value) {
+        panelReset(&host_panel, true);
+    }
+}
+
+bool gpio_get(uint gpio)
+{
+    // The panel is never busy
+    (void)gpio;
+    return false;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len)
+{
+    (void)spi;
+    for(size_t i = 0; i < len; i++) {
+        if(host_panel.dataCommand) {
+            panelData(&host_panel, src[i]);
+        } else {
+            panelCommand(&host_panel, src[i]);
+        }
+    }
+    return (int)len;
+}
+
+static int32_t check(bool pass, const char *test, const char *detail)
+{
+    if(!pass) {
+        printf("FAIL %s: %s\n", test, detail);
+    }
+    return pass ? 0 : 1;
+}
+
+/**
+ * @brief Checks a RAM plane holds an image, with the image rows counting down
+ * from the top of the RAM
+ */
+static bool panelShows(const Panel *panel, uint8_t ram, const uint8_t *image)
+{
+    const uint8_t (*plane)[EPD_1IN54_V2_WIDTH_BYTES] = (ram == DrvEPaper::WRITE_RAM_BW) ? panel->bw : panel->red;
+    for(uint32_t y = 0; y < EPD_1IN54_V2_HEIGHT; y++) {
+        if(memcmp(plane[(HOST_RAM_ROWS - 1) - y], &image[y * EPD_1IN54_V2_WIDTH_BYTES],
+                  EPD_1IN54_V2_WIDTH_BYTES) != 0) {
+            return false;
+        }
+    }
+    return !panel->outside;
+}
+
+/**
+ * @brief Checks the writes to a RAM plane since the last check of it, in
+ * order, each filling its window once
+ */
+static bool panelWrote(Panel *panel, uint8_t ram, const DrvEPaper::Window *windows, uint32_t count)
+{
+    std::vector<RamWrite> writes;
+    std::vector<RamWrite> others;
+    for(const RamWrite &write : panel->writes) {
+        ((write.ram == ram) ? writes : others).push_back(write);
+    }
+    panel->writes = others;
+
+    bool pass = (writes.size() == count);
+    for(uint32_t i = 0; pass && (i < count); i++) {
+        const RamWrite &write = writes[i];
+        const DrvEPaper::Window &window = windows[i];
+        uint32_t bytes = ((window.xEnd - window.xStart) + 1) * ((window.yEnd - window.yStart) + 1);
+        pass = (write.window.xStart == window.xStart) && (write.window.yStart == window.yStart) &&
+               (write.window.xEnd == window.xEnd) && (write.window.yEnd == window.yEnd) &&
+               (write.bytes == bytes);
+    }
+    if(!pass) {
+        for(const RamWrite &write : writes) {
+            printf("Wrote 0x%02X {%u, %u, %u, %u} %u bytes\n", write.ram, write.window.xStart,
+                   write.window.yStart, write.window.xEnd, write.window.yEnd, write.bytes);
+        }
+    }
+    return pass;
+}
+
+/**
+ * @brief Image that differs from byte to byte, so a byte out of place shows
+ */
+static void imageNoise(uint8_t *image, uint32_t seed)
+{
+    for(uint32_t i = 0; i < EPD_1IN54_V2_BUF_LEN; i++) {
+        seed = (seed * 1103515245u) + 12345u;
+        image[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static void imageFlip(uint8_t *image, uint32_t x, uint32_t y)
+{
+    image[(y * EPD_1IN54_V2_WIDTH_BYTES) + x] ^= 0xFF;
+}
+
+/**
+ * @brief Panel with a shadow, initialized and showing an image in full
+ */
+static bool paperStart(DrvEPaper *paper, uint8_t *image)
+{
+    panelInit(&host_panel);
+    if(!paper->shadowInit()) {
+        return false;
+    }
+    imageNoise(image, 1);
+    paper->display(image);
+    host_panel.writes.clear();
+    return panelShows(&host_panel, DrvEPaper::WRITE_RAM_BW, image);
+}
+
+// Bytes the setup of a window and its write RAM command take
+#define HOST_WINDOW_BYTES   14
+// Bytes of the refresh that follows the upload
+#define HOST_WAKE_BYTES     3
+
+static const DrvEPaper::Window host_full_window = {
+    0, 0, EPD_1IN54_V2_WIDTH_BYTES - 1, EPD_1IN54_V2_HEIGHT - 1
+};
+
+static int32_t testFull()
+{
+    const char *test = "full";
+    DrvEPaper paper(nullptr, HOST_PIN_CS, HOST_PIN_DC, HOST_PIN_BUSY, HOST_PIN_RESET);
+    static uint8_t image[EPD_1IN54_V2_BUF_LEN];
+    panelInit(&host_panel);
+    paper.initialize();
+    if(!paper.shadowInit()) {
+        return check(false, test, "shadow not allocated");
+    }
+    host_panel.writes.clear();
+
+    // Nothing is known about the RAM yet, the whole image goes out
+    imageNoise(image, 1);
+    uint32_t written = paper.bytesWritten();
+    paper.display(image);
+    written = paper.bytesWritten() - written;
+
+    int32_t error = check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, &host_full_window, 1), test,
+                          "whole image not written");
+    error |= check(written == (HOST_WINDOW_BYTES + EPD_1IN54_V2_BUF_LEN + HOST_WAKE_BYTES), test,
+                   "wrong number of bytes");
+    error |= check(panelShows(&host_panel, DrvEPaper::WRITE_RAM_BW, image), test, "panel differs");
+    return error;
+}
+
+static int32_t testUnchanged()
+{
+    const char *test = "unchanged";
+    DrvEPaper paper(nullptr, HOST_PIN_CS, HOST_PIN_DC, HOST_PIN_BUSY, HOST_PIN_RESET);
+    static uint8_t image[EPD_1IN54_V2_BUF_LEN];
+    if(!paperStart(&paper, image)) {
+        return check(false, test, "first image not shown");
+    }
+
+    // Only the refresh goes out
+    uint32_t written = paper.bytesWritten();
+    paper.display(image);
+    written = paper.bytesWritten() - written;
+
+    int32_t error = check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, nullptr, 0), test, "RAM written");
+    error |= check(written == HOST_WAKE_BYTES, test, "wrong number of bytes");
+    return error;
+}
+
+static int32_t testBands()
+{
+    const char *test = "bands";
+    DrvEPaper paper(nullptr, HOST_PIN_CS, HOST_PIN_DC, HOST_PIN_BUSY, HOST_PIN_RESET);
+    static uint8_t image[EPD_1IN54_V2_BUF_LEN];
+    if(!paperStart(&paper, image)) {
+        return check(false, test, "first image not shown");
+    }
+
+    // Rows 3 and 5 share a band, rows 100 and 199 stand alone
+    imageFlip(image, 4, 3);
+    imageFlip(image, 10, 5);
+    imageFlip(image, 24, 100);
+    imageFlip(image, 0, 199);
+    uint32_t written = paper.bytesWritten();
+    paper.display(image);
+    written = paper.bytesWritten() - written;
+
+    const DrvEPaper::Window windows[] = {
+        { 4, 3, 10, 5 }, { 24, 100, 24, 100 }, { 0, 199, 0, 199 }
+    };
+    uint32_t data = (7 * 3) + 1 + 1;
+    int32_t error = check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, windows, 3), test, "wrong windows");
+    error |= check(written == ((3 * HOST_WINDOW_BYTES) + data + HOST_WAKE_BYTES), test, "wrong number of bytes");
+    error |= check(panelShows(&host_panel, DrvEPaper::WRITE_RAM_BW, image), test, "panel differs");
+    return error;
+}
+
+static int32_t testMerge()
+{
+    const char *test = "merge";
+    DrvEPaper paper(nullptr, HOST_PIN_CS, HOST_PIN_DC, HOST_PIN_BUSY, HOST_PIN_RESET);
+    static uint8_t image[EPD_1IN54_V2_BUF_LEN];
+    if(!paperStart(&paper, image)) {
+        return check(false, test, "first image not shown");
+    }
+
+    // EPD_DIFF_MERGE_ROWS unchanged rows are spanned, one more splits the band
+    imageFlip(image, 6, 10);
+    imageFlip(image, 6, 10 + EPD_DIFF_MERGE_ROWS + 1);
+    imageFlip(image, 6, 30);
+    imageFlip(image, 6, 30 + EPD_DIFF_MERGE_ROWS + 2);
+    paper.display(image);
+
+    const uint32_t split = 30 + EPD_DIFF_MERGE_ROWS + 2;
+    const DrvEPaper::Window windows[] = {
+        { 6, 10, 6, 10 + EPD_DIFF_MERGE_ROWS + 1 }, { 6, 30, 6, 30 }, { 6, split, 6, split }
+    };
+    int32_t error = check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, windows, 3), test, "wrong windows");
+    error |= check(panelShows(&host_panel, DrvEPaper::WRITE_RAM_BW, image), test, "panel differs");
+    return error;
+}
+
+static int32_t testEdges()
+{
+    const char *test = "edges";
+    DrvEPaper paper(nullptr, HOST_PIN_CS, HOST_PIN_DC, HOST_PIN_BUSY, HOST_PIN_RESET);
+    static uint8_t image[EPD_1IN54_V2_BUF_LEN];
+    if(!paperStart(&paper, image)) {
+        return check(false, test, "first image not shown");
+    }
+
+    // A window runs from the first changed byte to the last one of its rows.
+    // The second takes in whole rows, which go out in one piece.
+    imageFlip(image, 2, 50);
+    imageFlip(image, 20, 50);
+    imageFlip(image, 24, 52);
+    imageFlip(image, 0, 120);
+    imageFlip(image, EPD_1IN54_V2_WIDTH_BYTES - 1, 120);
+    imageFlip(image, 12, 121);
+    uint32_t written = paper.bytesWritten();
+    paper.display(image);
+    written = paper.bytesWritten() - written;
+
+    const DrvEPaper::Window windows[] = {
+        { 2, 50, 24, 52 }, { 0, 120, EPD_1IN54_V2_WIDTH_BYTES - 1, 121 }
+    };
+    uint32_t data = (23 * 3) + (EPD_1IN54_V2_WIDTH_BYTES * 2);
+    int32_t error = check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, windows, 2), test, "wrong windows");
+    error |= check(written == ((2 * HOST_WINDOW_BYTES) + data + HOST_WAKE_BYTES), test, "wrong number of bytes");
+    error |= check(panelShows(&host_panel, DrvEPaper::WRITE_RAM_BW, image), test, "panel differs");
+    return error;
+}
+
+static int32_t testOverflow()
+{
+    const char *test = "overflow";
+    DrvEPaper paper(nullptr, HOST_PIN_CS, HOST_PIN_DC, HOST_PIN_BUSY, HOST_PIN_RESET);
+    static uint8_t image[EPD_1IN54_V2_BUF_LEN];
+    if(!paperStart(&paper, image)) {
+        return check(false, test, "first image not shown");
+    }
+
+    // Twenty bands, once the windows run out the last one takes in the rest
+    for(uint32_t y = 0; y < EPD_1IN54_V2_HEIGHT; y += 10) {
+        imageFlip(image, 1, y);
+    }
+    uint32_t written = paper.bytesWritten();
+    paper.display(image);
+    written = paper.bytesWritten() - written;
+
+    DrvEPaper::Window windows[EPD_DIFF_WINDOWS_MAX];
+    for(uint32_t i = 0; i < EPD_DIFF_WINDOWS_MAX; i++) {
+        windows[i] = { 1, i * 10, 1, i * 10 };
+    }
+    windows[EPD_DIFF_WINDOWS_MAX - 1].yEnd = EPD_1IN54_V2_HEIGHT - 10;
+    uint32_t data = (EPD_DIFF_WINDOWS_MAX - 1) + (EPD_1IN54_V2_HEIGHT - 10 - ((EPD_DIFF_WINDOWS_MAX - 1) * 10)) + 1;
+    int32_t error = check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, windows, EPD_DIFF_WINDOWS_MAX), test,
+                          "wrong windows");
+    error |= check(written == ((EPD_DIFF_WINDOWS_MAX * HOST_WINDOW_BYTES) + data + HOST_WAKE_BYTES), test,
+                   "wrong number of bytes");
+    error |= check(panelShows(&host_panel, DrvEPaper::WRITE_RAM_BW, image), test, "panel differs");
+    return error;
+}
+
+static int32_t testShadow()
+{
+    const char *test = "shadow";
+    DrvEPaper paper(nullptr, HOST_PIN_CS, HOST_PIN_DC, HOST_PIN_BUSY, HOST_PIN_RESET);
+    static uint8_t image[EPD_1IN54_V2_BUF_LEN];
+    if(!paperStart(&paper, image)) {
+        return check(false, test, "first image not shown");
+    }
+
+    // A fill is taken in by the shadow like an image
+    paper.fillScreen(0xFF);
+    host_panel.writes.clear();
+    memset(image, 0xFF, sizeof(image));
+    paper.display(image);
+    int32_t error = check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, nullptr, 0), test,
+                          "RAM written after a fill");
+
+    // The RAM is not relied on through a reset, the init is redone with it
+    paper.reset();
+    paper.display(image);
+    error |= check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, &host_full_window, 1), test,
+                   "whole image not written after a reset");
+    error |= check(panelShows(&host_panel, DrvEPaper::WRITE_RAM_BW, image), test, "panel differs after a reset");
+
+    paper.invalidateShadow();
+    paper.display(image);
+    error |= check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, &host_full_window, 1), test,
+                   "whole image not written once invalidated");
+
+    // Waking from deep sleep takes a reset as well
+    paper.sleep();
+    paper.display(image);
+    error |= check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, &host_full_window, 1), test,
+                   "whole image not written after a sleep");
+    error |= check(panelShows(&host_panel, DrvEPaper::WRITE_RAM_BW, image), test, "panel differs after a sleep");
+    return error;
+}
+
+static int32_t testPartial()
+{
+    const char *test = "partial";
+    DrvEPaper paper(nullptr, HOST_PIN_CS, HOST_PIN_DC, HOST_PIN_BUSY, HOST_PIN_RESET);
+    static uint8_t image[EPD_1IN54_V2_BUF_LEN];
+    panelInit(&host_panel);
+    if(!paper.shadowInit()) {
+        return check(false, test, "shadow not allocated");
+    }
+
+    // The base goes to both planes, the red one holding what the panel shows
+    imageNoise(image, 2);
+    paper.displayBase(image);
+    int32_t error = check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, &host_full_window, 1), test,
+                          "base not written");
+    error |= check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_RED, &host_full_window, 1), test,
+                   "base not written to the red RAM");
+
+    // Only the changed window goes out, to the red RAM once refreshed
+    imageFlip(image, 3, 60);
+    imageFlip(image, 7, 62);
+    paper.displayPartial(image);
+    const DrvEPaper::Window window = { 3, 60, 7, 62 };
+    error |= check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_BW, &window, 1), test, "wrong window");
+    error |= check(panelWrote(&host_panel, DrvEPaper::WRITE_RAM_RED, &window, 1), test, "wrong red window");
+    error |= check(panelShows(&host_panel, DrvEPaper::WRITE_RAM_BW, image), test, "panel differs");
+    error |= check(panelShows(&host_panel, DrvEPaper::WRITE_RAM_RED, image), test, "red RAM differs");
+    return error;
+}
+
+int main()
+{
+    static const struct {
+        const char *name;
+        int32_t (*test)();
+    } tests[] = {
+        {"full", testFull},
+        {"unchanged", testUnchanged},
+        {"bands", testBands},
+        {"merge", testMerge},
+        {"edges", testEdges},
+        {"overflow", testOverflow},
+        {"shadow", testShadow},
+        {"partial", testPartial},
+    };
+
+    log_set_quiet(1);
+
+    int32_t failures = 0;
+    for(const auto &test : tests) {
+        int32_t error = test.test();
+        printf("%s %s\n", error ? "FAIL" : "pass", test.name);
+        failures += (error != 0);
+    }
+
+    printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <vector>
+
+#include "project/hashlife.h"
+
+// The host has memory to spare, both for the pool and for the depth of the tree
+#define HOST_NODES      (1 << 22)
+#define HOST_BUCKETS    (1 << 21)
+#define HOST_MAX_LEVEL  40
+
+/**
+ * @brief Board read from a plaintext pattern or filled with a random soup
+ */
+struct Board {
+    int32_t width;
+    int32_t height;
+    std::vector<uint8_t> cells;
+};
+
+static bool boardGet(void *context, int32_t x, int32_t y)
+{
+    Board *board = static_cast<Board*>(context);
+    return board->cells[(y * board->width) + x] != 0;
+}
+
+static void boardSet(void *context, int32_t x, int32_t y)
+{
+    Board *board = static_cast<Board*>(context);
+    board->cells[(y * board->width) + x] = 1;
+}
+
+/**
+ * @brief Reads a plaintext pattern, 'O' for live cells, lines starting with
+ * '!' are comments
+ */
+static int32_t boardRead(Board *board, const char *file)
+{
+    FILE *fp = fopen(file, "r");
+    if(fp == NULL) {
+        printf("Failed to open %s\n", file);
+        return -1;
+    }
+
+    std::vector<std::vector<uint8_t>> rows;
+    char line[4096];
+    int32_t width = 0;
+    while(fgets(line, sizeof(line), fp)) {
+        if(line[0] == '!') {
+            continue;
+        }
+        std::vector<uint8_t> row;
+        for(char *c = line; (*c != '\0') && (*c != '\n') && (*c != '\r'); c++) {
+            row.push_back(*c == 'O' ? 1 : 0);
+        }
+        if((int32_t)row.size() > width) {
+            width = row.size();
+        }
+        rows.push_back(row);
+    }
+    fclose(fp);
+
+    board->width = width;
+    board->height = rows.size();
+    board->cells.assign(board->width * board->height, 0);
+    for(int32_t y = 0; y < board->height; y++) {
+        for(size_t x = 0; x < rows[y].size(); x++) {
+            board->cells[(y * board->width) + x] = rows[y][x];
+        }
+    }
+    return 0;
+}
+
+static void boardPrint(Board *board)
+{
+    for(int32_t y = 0; y < board->height; y++) {
+        for(int32_t x = 0; x < board->width; x++) {
+            printf("%c", board->cells[(y * board->width) + x] ? 'O' : '.');
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 3) {
+        printf("Usage: %s <pattern.cells|size> <generations> [print]\n", argv[0]);
+        return 1;
+    }
+
+    Board board;
+    int32_t size = atoi(argv[1]);
+    if(size > 0) {
+        // A square random soup
+        board.width = size;
+        board.height = size;
+        board.cells.resize(size * size);
+        for(int32_t i = 0; i < (size * size); i++) {
+            board.cells[i] = (rand() % 2);
+        }
+    } else if(boardRead(&board, argv[1]) != 0) {
+        return 1;
+    }
+    uint64_t generations = strtoull(argv[2], NULL, 0);
+
+    std::vector<HashLife::Node> nodes(HOST_NODES);
+    std::vector<uint32_t> buckets(HOST_BUCKETS);
+    HashLife life(nodes.data(), nodes.size(), buckets.data(), buckets.size(), HOST_MAX_LEVEL);
+
+    if(life.load(boardGet, &board, board.width, board.height) != 0) {
+        printf("Pattern does not fit in %d nodes\n", HOST_NODES);
+        return 1;
+    }
+    printf("Loaded %dx%d, population %u\n", board.width, board.height, life.population());
+
+    clock_t start = clock();
+    int32_t error = life.advance(generations);
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("Generation %llu%s\n", (unsigned long long)life.generation(), error ? " (out of nodes or levels)" : "");
+    printf("Population %u, level %u\n", life.population(), life.level());
+    printf("Nodes %u of %u, %u collections\n", life.nodesUsed(), life.capacity(), life.collections());
+    printf("Elapsed %.3f s\n", elapsed);
+
+    if(argc > 3) {
+        board.cells.assign(board.width * board.height, 0);
+        life.render(boardSet, &board, board.width, board.height);
+        boardPrint(&board);
+    }
+
+    return error ? 1 : 0;
+}
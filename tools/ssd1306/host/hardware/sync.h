@@ -0,0 +1,16 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include <thread>
+
+// Waiting for an event is a yield, so the other thread gets to run
+inline void __wfe()
+{
+    std::this_thread::yield();
+}
+
+inline void __sev()
+{
+}
+
+#endif // HOST_HARDWARE_SYNC_H
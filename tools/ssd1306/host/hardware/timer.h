@@ -0,0 +1,9 @@
+#ifndef HOST_HARDWARE_TIMER_H
+#define HOST_HARDWARE_TIMER_H
+
+#include <stdint.h>
+
+// Defined by the harness
+uint64_t time_us_64();
+
+#endif // HOST_HARDWARE_TIMER_H
@@ -0,0 +1,31 @@
+#ifndef HOST_PICO_CRITICAL_SECTION_H
+#define HOST_PICO_CRITICAL_SECTION_H
+
+#include <mutex>
+
+// Threads stand in for the two cores, a mutex for the spin lock
+typedef struct {
+    std::mutex mutex;
+} critical_section_t;
+
+inline void critical_section_init(critical_section_t *crit_sec)
+{
+    (void)crit_sec;
+}
+
+inline void critical_section_deinit(critical_section_t *crit_sec)
+{
+    (void)crit_sec;
+}
+
+inline void critical_section_enter_blocking(critical_section_t *crit_sec)
+{
+    crit_sec->mutex.lock();
+}
+
+inline void critical_section_exit(critical_section_t *crit_sec)
+{
+    crit_sec->mutex.unlock();
+}
+
+#endif // HOST_PICO_CRITICAL_SECTION_H
@@ -0,0 +1,12 @@
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+#include <stdint.h>
+
+// Just what the logger takes from the SDK, defined by the harness
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time();
+uint64_t to_us_since_boot(absolute_time_t t);
+
+#endif // HOST_PICO_TIME_H
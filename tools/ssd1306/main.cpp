@@ -0,0 +1,710 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "common/logger.h"
+#include "common/drivers/ssd1306_core.h"
+#include "common/drivers/ssd1306_frame_queue.h"
+
+// Rows of the picture scrolled through in the scroll tests
+#define HOST_PICTURE_HEIGHT 160
+// Frames a producer thread pushes through the frame queue
+#define HOST_QUEUE_FRAMES 2000
+
+absolute_time_t get_absolute_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * 1000000ULL) + (now.tv_nsec / 1000);
+}
+
+uint64_t to_us_since_boot(absolute_time_t t)
+{
+    return t;
+}
+
+uint64_t time_us_64()
+{
+    return get_absolute_time();
+}
+
+/**
+ * @brief Lock that only checks calls nest, there is no other core to keep out
+ */
+class HostLock
+    : public SSD1306Lock
+{
+public:
+    HostLock() : depth(0), acquisitions(0), underflow(false) {}
+
+    void lock() override
+    {
+        depth++;
+        acquisitions++;
+    }
+
+    void unlock() override
+    {
+        if(depth == 0) {
+            underflow = true;
+        } else {
+            depth--;
+        }
+    }
+
+    void get_stats(SSD1306LockStats *stats) override
+    {
+        memset(stats, 0, sizeof(SSD1306LockStats));
+        stats->acquisitions = acquisitions;
+    }
+
+    uint32_t depth;
+    uint32_t acquisitions;
+    bool underflow;
+};
+
+/**
+ * @brief Display RAM as the controller keeps it, rebuilt from a recording.
+ * Covers the commands the core sends once initialized, horizontal addressing
+ * only.
+ */
+struct Panel {
+    SSD1306::DisplayRam ram;
+    uint8_t startLine;
+    uint8_t colStart, colEnd, col;
+    uint8_t pageStart, pageEnd, page;
+    bool scrolling;
+};
+
+/**
+ * @brief Transport keeping the tag of every frame presented, and whether the
+ * frame arrived whole. A frame is tagged in its first four bytes and filled
+ * with the low byte of the tag, so one drawn into while it was being sent
+ * shows up torn.
+ */
+class FrameLog
+    : public SSD1306Transport
+{
+public:
+    FrameLog() : torn(0) {}
+
+    void write_commands(const uint8_t *commands, uint32_t length) override
+    {
+        (void)commands;
+        (void)length;
+    }
+
+    void write_data(const uint8_t *data, uint32_t length) override
+    {
+        uint32_t tag;
+        memcpy(&tag, data, sizeof(tag));
+        for(uint32_t i = sizeof(tag); i < length; i++) {
+            if(data[i] != (uint8_t)tag) {
+                torn++;
+                break;
+            }
+        }
+        tags.push_back(tag);
+    }
+
+    std::vector<uint32_t> tags;
+    uint32_t torn;
+};
+
+static int32_t check(bool pass, const char *test, const char *detail)
+{
+    if(!pass) {
+        printf("FAIL %s: %s\n", test, detail);
+    }
+    return pass ? 0 : 1;
+}
+
+static void panelReset(Panel *panel)
+{
+    memset(panel, 0, sizeof(Panel));
+    panel->colEnd = OLED_WIDTH - 1;
+    panel->pageEnd = OLED_NUM_PAGES - 1;
+}
+
+static bool panelCommands(Panel *panel, const uint8_t *bytes, uint32_t length)
+{
+    uint32_t i = 0;
+    while(i < length) {
+        uint8_t command = bytes[i++];
+        if((command & 0xC0) == OLED_SET_DISP_START_LINE) {
+            panel->startLine = command & 0x3F;
+        } else if((command == OLED_SET_COL_ADDR) && ((i + 2) <= length)) {
+            panel->colStart = panel->col = bytes[i];
+            panel->colEnd = bytes[i + 1];
+            i += 2;
+        } else if((command == OLED_SET_PAGE_ADDR) && ((i + 2) <= length)) {
+            panel->pageStart = panel->page = bytes[i];
+            panel->pageEnd = bytes[i + 1];
+            i += 2;
+        } else if((command & 0xFE) == OLED_SET_SCROLL) {
+            panel->scrolling = (command & 0x01);
+        } else if(((command & 0xFE) == OLED_SET_HORIZ_SCROLL) && ((i + 6) <= length)) {
+            i += 6;
+        } else {
+            printf("Unexpected command 0x%02X\n", command);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool panelData(Panel *panel, const uint8_t *bytes, uint32_t length)
+{
+    if(panel->scrolling) {
+        printf("Display RAM written during a scroll\n");
+        return false;
+    }
+    for(uint32_t i = 0; i < length; i++) {
+        panel->ram[panel->page][panel->col] = bytes[i];
+        if(panel->col < panel->colEnd) {
+            panel->col++;
+        } else {
+            panel->col = panel->colStart;
+            panel->page = (panel->page < panel->pageEnd) ? (panel->page + 1) : panel->pageStart;
+        }
+    }
+    return true;
+}
+
+static bool panelPlay(Panel *panel, SSD1306RecordingTransport *recording)
+{
+    if(recording->overflow()) {
+        printf("Recording overflowed\n");
+        return false;
+    }
+    for(uint32_t i = 0; i < recording->transactions(); i++) {
+        const SSD1306RecordingTransport::Transaction *transaction = recording->transaction(i);
+        const uint8_t *bytes = &recording->bytes()[transaction->offset];
+        bool played = (transaction->kind == SSD1306RecordingTransport::COMMAND) ?
+            panelCommands(panel, bytes, transaction->length) : panelData(panel, bytes, transaction->length);
+        if(!played) {
+            return false;
+        }
+    }
+    recording->clear();
+    return true;
+}
+
+/**
+ * @brief Pixel of the screen, with the display RAM row it shows picked by the
+ * start line
+ */
+static bool panelPixel(const Panel *panel, uint32_t x, uint32_t y)
+{
+    uint32_t row = (y + panel->startLine) % OLED_HEIGHT;
+    return (panel->ram[row / OLED_PAGE_HEIGHT][x] >> (row % OLED_PAGE_HEIGHT)) & 0x01;
+}
+
+static bool framePixel(const SSD1306::DisplayRam &frame, uint32_t x, uint32_t y)
+{
+    return (frame[y / OLED_PAGE_HEIGHT][x] >> (y % OLED_PAGE_HEIGHT)) & 0x01;
+}
+
+static bool panelShows(const Panel *panel, const SSD1306::DisplayRam &frame)
+{
+    for(uint32_t y = 0; y < OLED_HEIGHT; y++) {
+        for(uint32_t x = 0; x < OLED_WIDTH; x++) {
+            if(panelPixel(panel, x, y) != framePixel(frame, x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool recorded(SSD1306RecordingTransport *recording, uint32_t index, SSD1306RecordingTransport::Kind kind,
+                     const uint8_t *bytes, uint32_t length)
+{
+    const SSD1306RecordingTransport::Transaction *transaction = recording->transaction(index);
+    return transaction && (transaction->kind == kind) && (transaction->length == length) &&
+           (memcmp(&recording->bytes()[transaction->offset], bytes, length) == 0);
+}
+
+/**
+ * @brief Screen showing the rows of a tall picture from a given row down.
+ * Every row is different from its neighbours, so a row out of place shows.
+ */
+static void pictureView(SSD1306::DisplayRam &frame, uint32_t top)
+{
+    memset(frame, 0, sizeof(SSD1306::DisplayRam));
+    for(uint32_t y = 0; y < OLED_HEIGHT; y++) {
+        uint32_t row = (top + y) % HOST_PICTURE_HEIGHT;
+        for(uint32_t x = 0; x < OLED_WIDTH; x++) {
+            if(((x * 7) + (row * 13) + (x * row)) % 5 < 2) {
+                frame[y / OLED_PAGE_HEIGHT][x] |= (1 << (y % OLED_PAGE_HEIGHT));
+            }
+        }
+    }
+}
+
+static int32_t testInit()
+{
+    static const uint8_t expected[] = {
+        0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x00, 0xA1, 0xC8, 0xDA, 0x12,
+        0x81, 0xCF, 0xD9, 0xF1, 0xDB, 0x40, 0xA4, 0xA6, 0x2E, 0x00, 0x10, 0x40, 0xAF
+    };
+
+    SSD1306RecordingTransport recording;
+    HostLock lock;
+    SSD1306 display(&recording, &lock);
+    display.initialize();
+
+    int32_t error = check(recording.transactions() == 1, "init", "sequence is not a single transaction");
+    error |= check(recorded(&recording, 0, SSD1306RecordingTransport::COMMAND, expected, sizeof(expected)),
+                   "init", "sequence differs");
+    error |= check((lock.depth == 0) && !lock.underflow && (lock.acquisitions > 0), "init",
+                   "lock not taken and released");
+    return error;
+}
+
+static int32_t testWindow()
+{
+    static const uint8_t expected[] = {0x21, 0x02, 0x64, 0x22, 0x01, 0x03};
+
+    SSD1306RecordingTransport recording;
+    SSD1306 display(&recording);
+    display.set_window(0x02, 0x64, 0x01, 0x03);
+
+    return check(recorded(&recording, 0, SSD1306RecordingTransport::COMMAND, expected, sizeof(expected)) &&
+                 (recording.transactions() == 1), "window", "window commands differ");
+}
+
+static int32_t testRender()
+{
+    static const uint8_t window[] = {0x21, 0x10, 0x2F, 0x22, 0x02, 0x03};
+
+    SSD1306RecordingTransport recording;
+    HostLock lock;
+    SSD1306 display(&recording, &lock);
+
+    uint8_t buffer[64];
+    for(uint32_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = i * 3;
+    }
+    SSD1306::RenderArea area = {0x10, 0x2F, 0x02, 0x03, 0};
+    SSD1306::calc_render_area_buflen(&area);
+    display.render(buffer, &area);
+
+    int32_t error = check(area.buflen == sizeof(buffer), "render", "wrong buffer length for the area");
+    error |= check(recording.transactions() == 2, "render", "window and data are not two transactions");
+    error |= check(recorded(&recording, 0, SSD1306RecordingTransport::COMMAND, window, sizeof(window)), "render",
+                   "window differs");
+    error |= check(recorded(&recording, 1, SSD1306RecordingTransport::DATA, buffer, sizeof(buffer)), "render",
+                   "data differs");
+    error |= check((lock.depth == 0) && !lock.underflow, "render", "lock left held");
+    return error;
+}
+
+/**
+ * @brief Scrolls through a tall picture a few rows at a time in both
+ * directions, and checks the screen after every step against the rows of the
+ * picture that should be on it
+ */
+static int32_t testScroll()
+{
+    static const int32_t steps[] = {1, 1, 3, 8, 13, -2, -9, 30, 64, -70, 5, -1};
+
+    SSD1306RecordingTransport recording;
+    HostLock lock;
+    SSD1306 display(&recording, &lock);
+    display.initialize();
+    recording.clear();
+
+    Panel panel;
+    panelReset(&panel);
+    SSD1306::DisplayRam frame;
+    int32_t top = 0;
+    pictureView(frame, top);
+    display.write_frame(frame);
+
+    int32_t error = check(panelPlay(&panel, &recording) && panelShows(&panel, frame), "scroll",
+                          "first frame not on screen");
+    for(int32_t step : steps) {
+        top = (top + step + HOST_PICTURE_HEIGHT) % HOST_PICTURE_HEIGHT;
+        pictureView(frame, top);
+        uint32_t before = display.bytes_written();
+        display.scroll_rows(step, frame);
+        uint32_t bytes = display.bytes_written() - before;
+
+        char detail[64];
+        snprintf(detail, sizeof(detail), "screen wrong after a step of %d", step);
+        error |= check(panelPlay(&panel, &recording) && panelShows(&panel, frame), "scroll", detail);
+        error |= check(panel.startLine == display.start_line(), "scroll", "start line out of step");
+
+        // One page more than the rows exposed, at most, plus the windows
+        uint32_t pages = ((abs(step) + OLED_PAGE_HEIGHT - 1) / OLED_PAGE_HEIGHT) + 1;
+        if(pages > OLED_NUM_PAGES) {
+            pages = OLED_NUM_PAGES;
+        }
+        snprintf(detail, sizeof(detail), "step of %d sent %u bytes", step, bytes);
+        error |= check(bytes <= ((pages * OLED_WIDTH) + 16), "scroll", detail);
+    }
+    error |= check((lock.depth == 0) && !lock.underflow, "scroll", "lock left held");
+    return error;
+}
+
+/**
+ * @brief Builds display RAM pages for a start line that straddles two pages,
+ * through a single step, and checks the exact window sent
+ */
+static int32_t testRamPages()
+{
+    static const uint8_t window[] = {0x43, 0x21, 0x00, 0x7F, 0x22, 0x00, 0x00};
+
+    SSD1306RecordingTransport recording;
+    SSD1306 display(&recording);
+    SSD1306::DisplayRam frame;
+    pictureView(frame, 3);
+    display.scroll_rows(3, frame);
+
+    int32_t error = check(recording.transactions() == 2, "rampages", "step is not a window and its data");
+    error |= check(recorded(&recording, 0, SSD1306RecordingTransport::COMMAND, window, sizeof(window)),
+                   "rampages", "start line and window differ");
+
+    // RAM rows 0 to 7 show screen rows 61 to 63 and then 0 to 4
+    uint8_t expected[OLED_WIDTH];
+    for(uint32_t x = 0; x < OLED_WIDTH; x++) {
+        expected[x] = 0;
+        for(uint32_t bit = 0; bit < OLED_PAGE_HEIGHT; bit++) {
+            if(framePixel(frame, x, (bit + OLED_HEIGHT - 3) % OLED_HEIGHT)) {
+                expected[x] |= (1 << bit);
+            }
+        }
+    }
+    error |= check(recorded(&recording, 1, SSD1306RecordingTransport::DATA, expected, sizeof(expected)),
+                   "rampages", "page data differs");
+    return error;
+}
+
+/**
+ * @brief Writes display RAM while a continuous scroll runs, which has to stop
+ * the scroll before the first data byte
+ */
+static int32_t testScrollWrite()
+{
+    SSD1306RecordingTransport recording;
+    HostLock lock;
+    SSD1306 display(&recording, &lock);
+    Panel panel;
+    panelReset(&panel);
+
+    uint8_t buffer[OLED_WIDTH];
+    memset(buffer, 0x5A, sizeof(buffer));
+    SSD1306::RenderArea area = {0x00, OLED_WIDTH - 1, 0x04, 0x04, 0};
+    SSD1306::calc_render_area_buflen(&area);
+    display.scroll_start(SSD1306::SCROLL_LEFT, 0x02, 0x05, SSD1306::SCROLL_FRAMES_5);
+    display.render(buffer, &area);
+    int32_t error = check(panelPlay(&panel, &recording) && !display.scrolling(), "scrollwrite",
+                          "render did not stop the scroll");
+
+    // The scroll moved the band, so a step has to rewrite all of it
+    SSD1306::DisplayRam frame;
+    pictureView(frame, 0);
+    display.write_frame(frame);
+    error |= check(panelPlay(&panel, &recording), "scrollwrite", "frame not played");
+    display.scroll_start(SSD1306::SCROLL_RIGHT, 0x00, 0x07, SSD1306::SCROLL_FRAMES_2);
+    pictureView(frame, 2);
+    display.scroll_rows(2, frame);
+    error |= check(panelPlay(&panel, &recording) && panelShows(&panel, frame), "scrollwrite",
+                   "screen wrong after a step from a scroll");
+    error |= check((lock.depth == 0) && !lock.underflow, "scrollwrite", "lock left held");
+    return error;
+}
+
+static int32_t testIgnoreRam()
+{
+    static const uint8_t ignore[] = {0xA5};
+    static const uint8_t follow[] = {0xA4};
+
+    SSD1306RecordingTransport recording;
+    SSD1306 display(&recording);
+    display.ignore_ram(true);
+    display.ignore_ram(false);
+
+    return check(recorded(&recording, 0, SSD1306RecordingTransport::COMMAND, ignore, sizeof(ignore)) &&
+                 recorded(&recording, 1, SSD1306RecordingTransport::COMMAND, follow, sizeof(follow)),
+                 "ignoreram", "entire display on/off commands differ");
+}
+
+/**
+ * @brief Recording of a bus that frames every transaction with an address and
+ * a control byte, as I2C does
+ */
+class FramedRecordingTransport
+    : public SSD1306RecordingTransport
+{
+public:
+    uint32_t framing_bytes() override
+    {
+        return 2;
+    }
+};
+
+/**
+ * @brief Flushes frames planned against the one on screen, partially when a
+ * few spans changed and whole when everything did
+ */
+static int32_t testFlush()
+{
+    SSD1306RecordingTransport recording;
+    HostLock lock;
+    SSD1306 display(&recording, &lock);
+    Panel panel;
+    panelReset(&panel);
+
+    static SSD1306::DisplayRamWrite shown;
+    static SSD1306::DisplayRamWrite next;
+    SSD1306::FlushPlan plan;
+    pictureView(shown.ram, 0);
+    display.plan_flush(shown.ram, shown.ram, false, &plan);
+    display.flush(shown, plan, false);
+    int32_t error = check(plan.full && panelPlay(&panel, &recording) && panelShows(&panel, shown.ram), "flush",
+                          "first frame not on screen");
+
+    // Two pages changed, the first between columns 10 and 20
+    memcpy(&next, &shown, sizeof(next));
+    next.ram[2][10] ^= 0xFF;
+    next.ram[2][20] ^= 0xFF;
+    next.ram[5][100] ^= 0xFF;
+    display.plan_flush(next.ram, shown.ram, true, &plan);
+    uint32_t bytes = display.flush(next, plan, false);
+    error |= check(!plan.full && (plan.dirty == ((1 << 2) | (1 << 5))) && (plan.pages == 2), "flush",
+                   "wrong pages planned");
+    error |= check((plan.span_start[2] == 10) && (plan.span_end[2] == 20) && (plan.span_start[5] == 100) &&
+                   (plan.span_end[5] == 100), "flush", "wrong columns planned");
+    error |= check(bytes == ((2 * 6) + 11 + 1), "flush", "wrong number of bytes for the spans");
+    error |= check(panelPlay(&panel, &recording) && panelShows(&panel, next.ram), "flush",
+                   "screen wrong after a partial flush");
+
+    // Everything changed, the whole frame goes out behind a reopened window
+    memcpy(&shown, &next, sizeof(shown));
+    for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
+        for(uint32_t x = 0; x < OLED_WIDTH; x++) {
+            next.ram[page][x] ^= 0xFF;
+        }
+    }
+    display.plan_flush(next.ram, shown.ram, true, &plan);
+    bytes = display.flush(next, plan, false);
+    error |= check(plan.full && (plan.pages == OLED_PAGE_HEIGHT), "flush", "full frame not planned");
+    error |= check(bytes == (6 + sizeof(SSD1306::DisplayRam)), "flush", "window not reopened for a full frame");
+    error |= check(panelPlay(&panel, &recording) && panelShows(&panel, next.ram), "flush",
+                   "screen wrong after a full flush");
+
+    // Spans of 120 columns on every page are cheaper than the whole frame,
+    // until each transaction carries two bytes of framing
+    memcpy(&shown, &next, sizeof(shown));
+    for(uint32_t page = 0; page < OLED_PAGE_HEIGHT; page++) {
+        next.ram[page][0] ^= 0xFF;
+        next.ram[page][119] ^= 0xFF;
+    }
+    display.plan_flush(next.ram, shown.ram, true, &plan);
+    error |= check(!plan.full, "flush", "spans not planned without framing");
+
+    FramedRecordingTransport framed;
+    SSD1306 framedDisplay(&framed);
+    framedDisplay.plan_flush(next.ram, shown.ram, true, &plan);
+    error |= check(plan.full, "flush", "spans planned despite the framing");
+    error |= check((lock.depth == 0) && !lock.underflow, "flush", "lock left held");
+    return error;
+}
+
+static void frameDraw(SSD1306::DisplayRamWrite *frame, uint32_t tag)
+{
+    memset(frame->ram, (uint8_t)tag, sizeof(SSD1306::DisplayRam));
+    memcpy(frame->ram, &tag, sizeof(tag));
+}
+
+/**
+ * @brief Steps a double buffered queue through by hand: the producer runs out
+ * of frames until the presenter frees one, and frames go out in order
+ */
+static int32_t testQueueBlock()
+{
+    static const uint32_t expected[] = {1, 2, 3};
+
+    FrameLog log;
+    SSD1306 display(&log);
+    SSD1306FrameQueue queue(&display, 2, SSD1306FrameQueue::BLOCK);
+
+    SSD1306::DisplayRamWrite *first = queue.acquire(false);
+    SSD1306::DisplayRamWrite *second = queue.acquire(false);
+    int32_t error = check(first && second && (first != second), "queueblock", "two frames not handed out");
+    error |= check(queue.acquire(false) == nullptr, "queueblock", "third frame out of two");
+
+    frameDraw(first, 1);
+    queue.submit(first);
+    frameDraw(second, 2);
+    queue.submit(second);
+    error |= check(queue.pending() == 2, "queueblock", "submitted frames not pending");
+    error |= check(queue.present(false), "queueblock", "nothing presented");
+
+    SSD1306::DisplayRamWrite *third = queue.acquire(false);
+    error |= check(third == first, "queueblock", "presented frame not handed out again");
+    frameDraw(third, 3);
+    queue.submit(third);
+    error |= check(queue.present(false) && queue.present(false) && !queue.present(false), "queueblock",
+                   "wrong number of frames presented");
+
+    SSD1306FrameQueue::Stats stats;
+    queue.get_stats(&stats);
+    error |= check((log.tags.size() == 3) && (memcmp(log.tags.data(), expected, sizeof(expected)) == 0),
+                   "queueblock", "frames presented out of order");
+    error |= check((stats.submitted == 3) && (stats.presented == 3) && (stats.dropped == 0), "queueblock",
+                   "stats wrong");
+    return error;
+}
+
+/**
+ * @brief Steps a triple buffered queue through by hand: with every frame
+ * queued, the producer takes back the oldest one
+ */
+static int32_t testQueueDrop()
+{
+    static const uint32_t expected[] = {2, 3, 4};
+
+    FrameLog log;
+    SSD1306 display(&log);
+    SSD1306FrameQueue queue(&display, 3, SSD1306FrameQueue::DROP);
+
+    SSD1306::DisplayRamWrite *oldest = nullptr;
+    for(uint32_t tag = 1; tag <= 3; tag++) {
+        SSD1306::DisplayRamWrite *frame = queue.acquire(false);
+        oldest = oldest ? oldest : frame;
+        frameDraw(frame, tag);
+        queue.submit(frame);
+    }
+    SSD1306::DisplayRamWrite *frame = queue.acquire(false);
+    int32_t error = check(frame == oldest, "queuedrop", "oldest queued frame not taken back");
+    frameDraw(frame, 4);
+    queue.submit(frame);
+    while(queue.present(false)) {
+    }
+
+    SSD1306FrameQueue::Stats stats;
+    queue.get_stats(&stats);
+    error |= check((log.tags.size() == 3) && (memcmp(log.tags.data(), expected, sizeof(expected)) == 0),
+                   "queuedrop", "wrong frames presented");
+    error |= check((stats.submitted == 4) && (stats.presented == 3) && (stats.dropped == 1), "queuedrop",
+                   "stats wrong");
+    return error;
+}
+
+/**
+ * @brief Runs a producer and a presenter on two threads, as they run on the
+ * two cores. Under BLOCK every frame goes out in order. Under DROP frames may
+ * be skipped, but never reordered, and the last one always goes out.
+ */
+static int32_t testQueueThreads(SSD1306FrameQueue::Policy policy, uint32_t depth, const char *name)
+{
+    FrameLog log;
+    HostLock lock;
+    SSD1306 display(&log, &lock);
+    SSD1306FrameQueue queue(&display, depth, policy);
+    std::atomic<bool> done(false);
+
+    std::thread presenter([&]() {
+        do {
+            // Read before presenting, so a frame submitted last is not missed
+            bool finished = done;
+            if(!queue.present(false) && finished) {
+                break;
+            }
+        } while(true);
+    });
+    for(uint32_t tag = 0; tag < HOST_QUEUE_FRAMES; tag++) {
+        SSD1306::DisplayRamWrite *frame = queue.acquire(true);
+        frameDraw(frame, tag);
+        queue.submit(frame);
+    }
+    done = true;
+    presenter.join();
+
+    bool ordered = !log.tags.empty() && (log.tags.back() == (HOST_QUEUE_FRAMES - 1));
+    for(uint32_t i = 1; i < log.tags.size(); i++) {
+        ordered &= (log.tags[i] > log.tags[i - 1]);
+    }
+
+    SSD1306FrameQueue::Stats stats;
+    queue.get_stats(&stats);
+    int32_t error = check(ordered, name, "frames presented out of order or the last one lost");
+    error |= check(log.torn == 0, name, "frame drawn into while it was presented");
+    error |= check((stats.submitted == HOST_QUEUE_FRAMES) &&
+                   ((stats.presented + stats.dropped) == HOST_QUEUE_FRAMES) &&
+                   (stats.presented == log.tags.size()), name, "frames unaccounted for");
+    if(policy == SSD1306FrameQueue::BLOCK) {
+        error |= check(stats.dropped == 0, name, "frames dropped while blocking");
+    }
+    error |= check((lock.depth == 0) && !lock.underflow, name, "lock left held");
+    return error;
+}
+
+static int32_t testQueueThreadsBlock()
+{
+    return testQueueThreads(SSD1306FrameQueue::BLOCK, 2, "queuethreadsblock");
+}
+
+static int32_t testQueueThreadsDrop()
+{
+    return testQueueThreads(SSD1306FrameQueue::DROP, 3, "queuethreadsdrop");
+}
+
+static int32_t testOverflow()
+{
+    SSD1306::CommandStream commands;
+    for(uint32_t i = 0; i <= OLED_COMMAND_STREAM_MAX; i++) {
+        commands.add(OLED_SET_NORM_INV);
+    }
+    commands.add(OLED_SET_COL_ADDR, 0x00, 0x7F);
+
+    int32_t error = check(commands.overflow(), "overflow", "overflow not flagged");
+    error |= check(commands.length() == OLED_COMMAND_STREAM_MAX, "overflow", "stream kept a partial command");
+    commands.clear();
+    error |= check(!commands.overflow() && (commands.length() == 0), "overflow", "clear left the stream dirty");
+    return error;
+}
+
+int main()
+{
+    static const struct {
+        const char *name;
+        int32_t (*test)();
+    } tests[] = {
+        {"init", testInit},
+        {"window", testWindow},
+        {"render", testRender},
+        {"scroll", testScroll},
+        {"rampages", testRamPages},
+        {"scrollwrite", testScrollWrite},
+        {"ignoreram", testIgnoreRam},
+        {"flush", testFlush},
+        {"overflow", testOverflow},
+        {"queueblock", testQueueBlock},
+        {"queuedrop", testQueueDrop},
+        {"queuethreadsblock", testQueueThreadsBlock},
+        {"queuethreadsdrop", testQueueThreadsDrop},
+    };
+
+    // Warnings the tests set off on purpose stay quiet
+    log_set_quiet(1);
+
+    int32_t failures = 0;
+    for(const auto &test : tests) {
+        int32_t error = test.test();
+        printf("%s %s\n", error ? "FAIL" : "pass", test.name);
+        failures += (error != 0);
+    }
+
+    printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}